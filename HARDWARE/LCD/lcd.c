@@ -3,6 +3,8 @@
 #include "font.h" 
 #include "usart.h"	 
 #include "delay.h"	 
+#include "FreeRTOS.h"
+#include "task.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEK STM32F407
@@ -37,9 +39,20 @@ u16 BACK_COLOR=0xFFFF;  //
 //LCDҪ
 //ĬΪ
 _lcd_dev lcddev;
+
+//DMA״̬
+//DMA2 Stream0 ͨ0 洢洢:Դ̶ַ(ɫ),Ŀĵ̶ַ(LCD->LCD_RAM)
+//65535,ڴжֶ
+static u16 LCD_DMA_Color;				//ɫ(DMAԴ)
+static u32 LCD_DMA_Left=0;				//ʣδĵ
+static volatile u8 LCD_DMA_Busy=0;		//1,DMAдGRAM
+static void (*LCD_DMA_Done)(void *arg)=0;
+static void *LCD_DMA_Arg;
+static void LCD_Window_Raw(u16 sx, u16 sy, u16 width, u16 height);
 	 
 //дĴ
 //regval:Ĵֵ
+//ﲻDMA:ͼ(LCD_SetCursor/LCD_Set_Window//ʾ)ȵȹ
 void LCD_WR_REG(vu16 regval)
 {   
 	regval=regval;		//ʹ-O2Żʱ,ʱ
@@ -140,6 +153,7 @@ u16 LCD_ReadPoint(u16 x,u16 y)
 //LCDʾ
 void LCD_DisplayOn(void)
 {					   
+    LCD_DMA_Wait();
     if (lcddev.id == 0X5510)    //5510ʾָ
     {
         LCD_WR_REG(0X2900);     //ʾ
@@ -152,6 +166,7 @@ void LCD_DisplayOn(void)
 //LCDرʾ
 void LCD_DisplayOff(void)
 {	   
+    LCD_DMA_Wait();
     if (lcddev.id == 0X5510)    //5510رʾָ
     {
         LCD_WR_REG(0X2800);     //رʾ
@@ -161,59 +176,178 @@ void LCD_DisplayOff(void)
         LCD_WR_REG(0X28);       //رʾ
     }
 }
-//ùλ
-//Xpos:
-//Ypos:
-void LCD_SetCursor(u16 Xpos, u16 Ypos)
+//////////////////////////////////////////////////////////////////////////////////
+//Ĺ//(ȴDMA)
+//MIPI:9341/5310/7789/7796/9806 Լ 1963Ĵ,8λָ,ֻдʼַʱַ
+//5510:16λָ,ÿַֽڵһָ
+//1963:ͬʱдַ;ʱX,ɨ跽
+__STATIC_INLINE void LCD_Cursor_MIPI(u16 x, u16 y)
 {
-    if (lcddev.id == 0X1963)
-    {
-        if (lcddev.dir == 0)   //xҪ任
-        {
-            Xpos = lcddev.width - 1 - Xpos;
-            LCD_WR_REG(lcddev.setxcmd);
-            LCD_WR_DATA(0);
-            LCD_WR_DATA(0);
-            LCD_WR_DATA(Xpos >> 8);
-            LCD_WR_DATA(Xpos & 0XFF);
-        }
-        else
-        {
-            LCD_WR_REG(lcddev.setxcmd);
-            LCD_WR_DATA(Xpos >> 8);
-            LCD_WR_DATA(Xpos & 0XFF);
-            LCD_WR_DATA((lcddev.width - 1) >> 8);
-            LCD_WR_DATA((lcddev.width - 1) & 0XFF);
-        }
+    LCD_WR_REG(lcddev.setxcmd);
+    LCD_WR_DATA(x >> 8);
+    LCD_WR_DATA(x & 0XFF);
+    LCD_WR_REG(lcddev.setycmd);
+    LCD_WR_DATA(y >> 8);
+    LCD_WR_DATA(y & 0XFF);
+}
+__STATIC_INLINE void LCD_Cursor_5510(u16 x, u16 y)
+{
+    LCD_WR_REG(lcddev.setxcmd);
+    LCD_WR_DATA(x >> 8);
+    LCD_WR_REG(lcddev.setxcmd + 1);
+    LCD_WR_DATA(x & 0XFF);
+    LCD_WR_REG(lcddev.setycmd);
+    LCD_WR_DATA(y >> 8);
+    LCD_WR_REG(lcddev.setycmd + 1);
+    LCD_WR_DATA(y & 0XFF);
+}
+__STATIC_INLINE void LCD_Cursor_1963(u16 x, u16 y, u16 xe)
+{
+    LCD_WR_REG(lcddev.setxcmd);
+    LCD_WR_DATA(x >> 8);
+    LCD_WR_DATA(x & 0XFF);
+    LCD_WR_DATA(xe >> 8);
+    LCD_WR_DATA(xe & 0XFF);
+    LCD_WR_REG(lcddev.setycmd);
+    LCD_WR_DATA(y >> 8);
+    LCD_WR_DATA(y & 0XFF);
+    LCD_WR_DATA((lcddev.height - 1) >> 8);
+    LCD_WR_DATA((lcddev.height - 1) & 0XFF);
+}
+__STATIC_INLINE void LCD_Cursor_1963H(u16 x, u16 y)
+{
+    LCD_Cursor_1963(x, y, lcddev.width - 1);
+}
+__STATIC_INLINE void LCD_Cursor_1963V(u16 x, u16 y)
+{
+    x = lcddev.width - 1 - x;
+    LCD_Cursor_1963(0, y, x);   //:Xַ,xд0
+}
 
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(Ypos >> 8);
-        LCD_WR_DATA(Ypos & 0XFF);
-        LCD_WR_DATA((lcddev.height - 1) >> 8);
-        LCD_WR_DATA((lcddev.height - 1) & 0XFF);
+__STATIC_INLINE void LCD_Window_MIPI(u16 sx, u16 sy, u16 width, u16 height)
+{
+    u16 ex = sx + width - 1, ey = sy + height - 1;
+    LCD_WR_REG(lcddev.setxcmd);
+    LCD_WR_DATA(sx >> 8);
+    LCD_WR_DATA(sx & 0XFF);
+    LCD_WR_DATA(ex >> 8);
+    LCD_WR_DATA(ex & 0XFF);
+    LCD_WR_REG(lcddev.setycmd);
+    LCD_WR_DATA(sy >> 8);
+    LCD_WR_DATA(sy & 0XFF);
+    LCD_WR_DATA(ey >> 8);
+    LCD_WR_DATA(ey & 0XFF);
+}
+__STATIC_INLINE void LCD_Window_5510(u16 sx, u16 sy, u16 width, u16 height)
+{
+    u16 ex = sx + width - 1, ey = sy + height - 1;
+    LCD_WR_REG(lcddev.setxcmd);
+    LCD_WR_DATA(sx >> 8);
+    LCD_WR_REG(lcddev.setxcmd + 1);
+    LCD_WR_DATA(sx & 0XFF);
+    LCD_WR_REG(lcddev.setxcmd + 2);
+    LCD_WR_DATA(ex >> 8);
+    LCD_WR_REG(lcddev.setxcmd + 3);
+    LCD_WR_DATA(ex & 0XFF);
+    LCD_WR_REG(lcddev.setycmd);
+    LCD_WR_DATA(sy >> 8);
+    LCD_WR_REG(lcddev.setycmd + 1);
+    LCD_WR_DATA(sy & 0XFF);
+    LCD_WR_REG(lcddev.setycmd + 2);
+    LCD_WR_DATA(ey >> 8);
+    LCD_WR_REG(lcddev.setycmd + 3);
+    LCD_WR_DATA(ey & 0XFF);
+}
+__STATIC_INLINE void LCD_Window_1963V(u16 sx, u16 sy, u16 width, u16 height)
+{
+    LCD_Window_MIPI(lcddev.width - width - sx, sy, width, height);  //:X
+}
+
+__STATIC_INLINE void LCD_Point_MIPI(u16 x, u16 y, u16 color)
+{
+    LCD_Cursor_MIPI(x, y);
+    LCD->LCD_REG = lcddev.wramcmd;
+    LCD->LCD_RAM = color;
+}
+__STATIC_INLINE void LCD_Point_5510(u16 x, u16 y, u16 color)
+{
+    LCD_Cursor_5510(x, y);
+    LCD->LCD_REG = lcddev.wramcmd;
+    LCD->LCD_RAM = color;
+}
+__STATIC_INLINE void LCD_Point_1963H(u16 x, u16 y, u16 color)
+{
+    LCD_Window_MIPI(x, y, 1, 1);
+    LCD->LCD_REG = lcddev.wramcmd;
+    LCD->LCD_RAM = color;
+}
+__STATIC_INLINE void LCD_Point_1963V(u16 x, u16 y, u16 color)
+{
+    LCD_Window_MIPI(lcddev.width - 1 - x, y, 1, 1);
+    LCD->LCD_REG = lcddev.wramcmd;
+    LCD->LCD_RAM = color;
+}
 
+#if LCD_FIXED_CTRL==0
+//ʱ,LCD_Display_DirﰴIDͷѡ
+_lcd_drv lcd_drv = {LCD_Cursor_MIPI, LCD_Window_MIPI, LCD_Point_MIPI};
+#define LCD_CURSOR(x,y)         lcd_drv.cursor(x,y)
+#define LCD_WINDOW(x,y,w,h)     lcd_drv.window(x,y,w,h)
+#define LCD_POINT(x,y,c)        lcd_drv.point(x,y,c)
+static void LCD_Drv_Bind(void)
+{
+    if (lcddev.id == 0X5510)
+    {
+        lcd_drv.cursor = LCD_Cursor_5510;
+        lcd_drv.window = LCD_Window_5510;
+        lcd_drv.point = LCD_Point_5510;
     }
-    else if (lcddev.id == 0X5510)
+    else if (lcddev.id == 0X1963 && lcddev.dir == 0)
     {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(Xpos >> 8);
-        LCD_WR_REG(lcddev.setxcmd + 1);
-        LCD_WR_DATA(Xpos & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(Ypos >> 8);
-        LCD_WR_REG(lcddev.setycmd + 1);
-        LCD_WR_DATA(Ypos & 0XFF);
+        lcd_drv.cursor = LCD_Cursor_1963V;
+        lcd_drv.window = LCD_Window_1963V;
+        lcd_drv.point = LCD_Point_1963V;
     }
-    else     //9341/5310/7789/7796/9806
+    else if (lcddev.id == 0X1963)
     {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(Xpos >> 8);
-        LCD_WR_DATA(Xpos & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(Ypos >> 8);
-        LCD_WR_DATA(Ypos & 0XFF);
+        lcd_drv.cursor = LCD_Cursor_1963H;
+        lcd_drv.window = LCD_Window_MIPI;
+        lcd_drv.point = LCD_Point_1963H;
+    }
+    else
+    {
+        lcd_drv.cursor = LCD_Cursor_MIPI;
+        lcd_drv.window = LCD_Window_MIPI;
+        lcd_drv.point = LCD_Point_MIPI;
     }
 }
+#elif LCD_FIXED_CTRL==0X5510
+#define LCD_CURSOR(x,y)         LCD_Cursor_5510(x,y)
+#define LCD_WINDOW(x,y,w,h)     LCD_Window_5510(x,y,w,h)
+#define LCD_POINT(x,y,c)        LCD_Point_5510(x,y,c)
+#elif LCD_FIXED_CTRL==0X1963 && LCD_FIXED_DIR==0
+#define LCD_CURSOR(x,y)         LCD_Cursor_1963V(x,y)
+#define LCD_WINDOW(x,y,w,h)     LCD_Window_1963V(x,y,w,h)
+#define LCD_POINT(x,y,c)        LCD_Point_1963V(x,y,c)
+#elif LCD_FIXED_CTRL==0X1963
+#define LCD_CURSOR(x,y)         LCD_Cursor_1963H(x,y)
+#define LCD_WINDOW(x,y,w,h)     LCD_Window_MIPI(x,y,w,h)
+#define LCD_POINT(x,y,c)        LCD_Point_1963H(x,y,c)
+#else
+#define LCD_CURSOR(x,y)         LCD_Cursor_MIPI(x,y)
+#define LCD_WINDOW(x,y,w,h)     LCD_Window_MIPI(x,y,w,h)
+#define LCD_POINT(x,y,c)        LCD_Point_MIPI(x,y,c)
+#endif
+//////////////////////////////////////////////////////////////////////////////////
+
+//ùλ
+//Xpos:
+//Ypos:
+void LCD_SetCursor(u16 Xpos, u16 Ypos)
+{
+    LCD_DMA_Wait();                 //ȴDMA,GRAMд
+    LCD_CURSOR(Xpos, Ypos);
+}
 
 //LCDԶɨ跽
 //dir:0~7,8(嶨lcd.h)
@@ -226,6 +360,7 @@ void LCD_Scan_Dir(u8 dir)
 	u16 regval=0;
 	u16 dirreg=0;
 	u16 temp;  
+	LCD_DMA_Wait();
     //ʱ1963ıɨ跽, ICıɨ跽ʱ1963ı䷽, ICıɨ跽
     if ((lcddev.dir == 1 && lcddev.id != 0X1963) || (lcddev.dir == 0 && lcddev.id == 0X1963))
     {
@@ -381,50 +516,15 @@ void LCD_DrawPoint(u16 x,u16 y)
 //color:ɫ
 void LCD_Fast_DrawPoint(u16 x,u16 y,u16 color)
 {	   
- if (lcddev.id == 0X5510)
-    {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(x >> 8);
-        LCD_WR_REG(lcddev.setxcmd + 1);
-        LCD_WR_DATA(x & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(y >> 8);
-        LCD_WR_REG(lcddev.setycmd + 1);
-        LCD_WR_DATA(y & 0XFF);
-    }
-    else if (lcddev.id == 0X1963)
-    {
-        if (lcddev.dir == 0)x = lcddev.width - 1 - x;
-
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(x >> 8);
-        LCD_WR_DATA(x & 0XFF);
-        LCD_WR_DATA(x >> 8);
-        LCD_WR_DATA(x & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(y >> 8);
-        LCD_WR_DATA(y & 0XFF);
-        LCD_WR_DATA(y >> 8);
-        LCD_WR_DATA(y & 0XFF);
-    }
-    else     //9341/5310/7789
-    {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(x >> 8);
-        LCD_WR_DATA(x & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(y >> 8);
-        LCD_WR_DATA(y & 0XFF);
-    }
-
-    LCD->LCD_REG=lcddev.wramcmd; 
-    LCD->LCD_RAM=color; 
+    LCD_DMA_Wait();
+    LCD_POINT(x, y, color);
 }
 
 //SSD1963 
 //pwm:ȼ,0~100.ԽԽ.
 void LCD_SSD_BackLightSet(u8 pwm)
 {	
+	LCD_DMA_Wait();
 	LCD_WR_REG(0xBE);	//PWM
 	LCD_WR_DATA(0x05);	//1PWMƵ
 	LCD_WR_DATA(pwm*2.55);//2PWMռձ
@@ -438,6 +538,7 @@ void LCD_SSD_BackLightSet(u8 pwm)
 //dir:0,1,
 void LCD_Display_Dir(u8 dir)
 {
+    LCD_DMA_Wait();         //жϰlcddevָȫ,ȵٸ
     lcddev.dir = dir;       ///
 
     if (dir == 0)           //
@@ -514,6 +615,9 @@ void LCD_Display_Dir(u8 dir)
         }
     }
 
+#if LCD_FIXED_CTRL==0
+    LCD_Drv_Bind();                 //IDͷȷѡ//
+#endif
     LCD_Scan_Dir(DFT_SCAN_DIR);     //Ĭɨ跽
 }
 
@@ -523,57 +627,13 @@ void LCD_Display_Dir(u8 dir)
 //С:width*height.
 void LCD_Set_Window(u16 sx, u16 sy, u16 width, u16 height)
 {
-    u16 twidth, theight;
-    twidth = sx + width - 1;
-    theight = sy + height - 1;
-
-    if (lcddev.id == 0X1963 && lcddev.dir != 1)     //1963⴦
-    {
-        sx = lcddev.width - width - sx;
-        height = sy + height - 1;
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(sx >> 8);
-        LCD_WR_DATA(sx & 0XFF);
-        LCD_WR_DATA((sx + width - 1) >> 8);
-        LCD_WR_DATA((sx + width - 1) & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(sy >> 8);
-        LCD_WR_DATA(sy & 0XFF);
-        LCD_WR_DATA(height >> 8);
-        LCD_WR_DATA(height & 0XFF);
-    }
-    else if (lcddev.id == 0X5510)
-    {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(sx >> 8);
-        LCD_WR_REG(lcddev.setxcmd + 1);
-        LCD_WR_DATA(sx & 0XFF);
-        LCD_WR_REG(lcddev.setxcmd + 2);
-        LCD_WR_DATA(twidth >> 8);
-        LCD_WR_REG(lcddev.setxcmd + 3);
-        LCD_WR_DATA(twidth & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(sy >> 8);
-        LCD_WR_REG(lcddev.setycmd + 1);
-        LCD_WR_DATA(sy & 0XFF);
-        LCD_WR_REG(lcddev.setycmd + 2);
-        LCD_WR_DATA(theight >> 8);
-        LCD_WR_REG(lcddev.setycmd + 3);
-        LCD_WR_DATA(theight & 0XFF);
-    }
-    else     //9341/5310/7789/1963/7796/9806  ô
-    {
-        LCD_WR_REG(lcddev.setxcmd);
-        LCD_WR_DATA(sx >> 8);
-        LCD_WR_DATA(sx & 0XFF);
-        LCD_WR_DATA(twidth >> 8);
-        LCD_WR_DATA(twidth & 0XFF);
-        LCD_WR_REG(lcddev.setycmd);
-        LCD_WR_DATA(sy >> 8);
-        LCD_WR_DATA(sy & 0XFF);
-        LCD_WR_DATA(theight >> 8);
-        LCD_WR_DATA(theight & 0XFF);
-    }
+    LCD_DMA_Wait();
+    LCD_Window_Raw(sx, sy, width, height);
+}
+//ô(ȴDMA,DMAжϻָȫʹ)
+static void LCD_Window_Raw(u16 sx, u16 sy, u16 width, u16 height)
+{
+    LCD_WINDOW(sx, sy, width, height);
 }
 
 //ʼlcd
@@ -581,8 +641,6 @@ void LCD_Set_Window(u16 sx, u16 sy, u16 width, u16 height)
 //ͺŵоƬûв! 
 void LCD_Init(void)
 { 	
-	vu32 i=0;
-	
 	GPIO_InitTypeDef  GPIO_InitStructure;
 	FSMC_NORSRAMInitTypeDef  FSMC_NORSRAMInitStructure;
 	FSMC_NORSRAMTimingInitTypeDef  readWriteTiming; 
@@ -787,6 +845,10 @@ void LCD_Init(void)
         }
 	}
  	printf(" LCD ID:%x\r\n",lcddev.id); //ӡLCD ID
+#if LCD_FIXED_CTRL!=0
+	if((lcddev.id==0X5510||lcddev.id==0X1963||LCD_FIXED_CTRL==0X5510||LCD_FIXED_CTRL==0X1963)&&lcddev.id!=LCD_FIXED_CTRL)
+		printf(" LCD_FIXED_CTRL=%x Ļ,ʾ\r\n",LCD_FIXED_CTRL);
+#endif
 	if(lcddev.id==0X9341)	//9341ʼ
 	{	 
 		LCD_WR_REG(0xCF);  
@@ -2400,46 +2462,141 @@ void LCD_Init(void)
 	}		 
 	LCD_Display_Dir(0);		//ĬΪ
 	LCD_LED=1;				//
+	LCD_DMA_Init();			//DMA
 	LCD_Clear(WHITE);
 }  
+//ʼDMA2 Stream0(洢洢)ڵɫ
+//洢洢ģʽ,˿ΪԴ,洢˿ΪĿ,ұʹFIFO
+void LCD_DMA_Init(void)
+{
+	DMA_InitTypeDef  DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2,ENABLE);	//DMA2ʱʹ
+	DMA_DeInit(DMA2_Stream0);
+	while(DMA_GetCmdStatus(DMA2_Stream0)!=DISABLE);		//ȴDMA
+
+	DMA_InitStructure.DMA_Channel=DMA_Channel_0;
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(u32)(uintptr_t)&LCD_DMA_Color;	//Դ:ɫ
+	DMA_InitStructure.DMA_Memory0BaseAddr=(u32)(uintptr_t)&LCD->LCD_RAM;		//Ŀ:GRAMݿ
+	DMA_InitStructure.DMA_DIR=DMA_DIR_MemoryToMemory;
+	DMA_InitStructure.DMA_BufferSize=1;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Disable;
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_HalfWord;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_HalfWord;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_Medium;
+	DMA_InitStructure.DMA_FIFOMode=DMA_FIFOMode_Enable;
+	DMA_InitStructure.DMA_FIFOThreshold=DMA_FIFOThreshold_HalfFull;
+	DMA_InitStructure.DMA_MemoryBurst=DMA_MemoryBurst_Single;
+	DMA_InitStructure.DMA_PeripheralBurst=DMA_PeripheralBurst_Single;
+	DMA_Init(DMA2_Stream0,&DMA_InitStructure);
+	DMA_ITConfig(DMA2_Stream0,DMA_IT_TC|DMA_IT_TE,ENABLE);
+
+	NVIC_InitStructure.NVIC_IRQChannel=DMA2_Stream0_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=LCD_DMA_IRQ_PRIO;	//صܵFromISRӿ
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+//һDMA(ֹͣʱдNDTR)
+static void LCD_DMA_Next(void)
+{
+	u16 n=LCD_DMA_Left>65535?65535:(u16)LCD_DMA_Left;
+	LCD_DMA_Left-=n;
+	DMA_ClearFlag(DMA2_Stream0,DMA_FLAG_TCIF0|DMA_FLAG_HTIF0|DMA_FLAG_TEIF0|DMA_FLAG_FEIF0|DMA_FLAG_DMEIF0);
+	DMA_SetCurrDataCounter(DMA2_Stream0,n);
+	DMA_Cmd(DMA2_Stream0,ENABLE);
+}
+//DMAж:ֶ,ȫɺָȫڲص
+void DMA2_Stream0_IRQHandler(void)
+{
+	u8 err=0;
+	if(DMA_GetITStatus(DMA2_Stream0,DMA_IT_TEIF0)!=RESET)
+	{
+		DMA_ClearITPendingBit(DMA2_Stream0,DMA_IT_TEIF0);
+		err=1;
+	}
+	if(DMA_GetITStatus(DMA2_Stream0,DMA_IT_TCIF0)!=RESET||err)
+	{
+		DMA_ClearITPendingBit(DMA2_Stream0,DMA_IT_TCIF0);
+		if(LCD_DMA_Left&&!err)LCD_DMA_Next();
+		else
+		{
+			LCD_DMA_Left=0;
+			LCD_DMA_Busy=0;
+			LCD_Window_Raw(0,0,lcddev.width,lcddev.height);	//ָȫ,ຯ
+			if(LCD_DMA_Done)LCD_DMA_Done(LCD_DMA_Arg);
+		}
+	}
+}
+//ȴDMA
+//ʱóCPU,ԭصȴ
+void LCD_DMA_Wait(void)
+{
+	while(LCD_DMA_Busy)
+	{
+		if(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)vTaskDelay(1);
+	}
+}
+//ѯDMAǷ
+u8 LCD_DMA_IsBusy(void)
+{
+	return LCD_DMA_Busy;
+}
 //
 //color:Ҫɫ
 void LCD_Clear(u16 color)
 {
-    u32 index = 0;
-    u32 totalpoint = lcddev.width;
-    totalpoint *= lcddev.height;    //õܵ
-
-    LCD_SetCursor(0x00, 0x0000);    //ùλ
-    LCD_WriteRAM_Prepare();         //ʼдGRAM
-
-    for (index = 0; index < totalpoint; index++)
-    {
-        LCD->LCD_RAM=color;
-    }
+    LCD_Fill(0, 0, lcddev.width - 1, lcddev.height - 1, color);
 }
 
 //ָָɫ
 //С:(xend-xsta+1)*(yend-ysta+1)
 //xsta
 //color:Ҫɫ
+//DMAʽ,,LCDԶȴ
 void LCD_Fill(u16 sx, u16 sy, u16 ex, u16 ey, u16 color)
 {
-    u16 i, j;
-    u16 xlen = 0;
+    LCD_Fill_Async(sx, sy, ex, ey, color, 0, 0);
+}
 
-    xlen = ex - sx + 1;
+//첽:һδ,DMAдȫ,ɺжеdone(arg)
+//doneΪ0;صжִ,ֻܵFromISRӿ
+//򳬳ĻĲֱõ;СֱCPUд,doneͬᱻ
+void LCD_Fill_Async(u16 sx, u16 sy, u16 ex, u16 ey, u16 color, void (*done)(void *arg), void *arg)
+{
+    u32 total, i;
+    u16 w, h;
 
-    for (i = sy; i <= ey; i++)
+    if (ex >= lcddev.width) ex = lcddev.width - 1;
+    if (ey >= lcddev.height) ey = lcddev.height - 1;
+    if (sx > ex || sy > ey)
     {
-        LCD_SetCursor(sx, i);       //ùλ
-        LCD_WriteRAM_Prepare();     //ʼдGRAM
+        if (done) done(arg);
+        return;
+    }
+    w = ex - sx + 1;
+    h = ey - sy + 1;
+    total = (u32)w * h;
 
-        for (j = 0; j < xlen; j++)
-        {
-            LCD->LCD_RAM=color;     //ùλ
-        }
+    LCD_Set_Window(sx, sy, w, h);   //ȴһDMAô
+    LCD_WriteRAM_Prepare();         //ʼдGRAM
+
+    if (total < LCD_DMA_MIN_POINTS) //СDMA
+    {
+        for (i = 0; i < total; i++) LCD->LCD_RAM = color;
+        LCD_Window_Raw(0, 0, lcddev.width, lcddev.height);
+        if (done) done(arg);
+        return;
     }
+    LCD_DMA_Color = color;
+    LCD_DMA_Left = total;
+    LCD_DMA_Done = done;
+    LCD_DMA_Arg = arg;
+    LCD_DMA_Busy = 1;
+    LCD_DMA_Next();
 }
 
 //ָָɫ
@@ -2566,32 +2723,56 @@ void LCD_Draw_Circle(u16 x0,u16 y0,u8 r)
 //mode:ӷʽ(1)Ƿǵӷʽ(0)
 void LCD_ShowChar(u16 x,u16 y,u8 num,u8 size,u8 mode)
 {  							  
-    u8 temp,t1,t;
-	u16 y0=y;
-	u8 csize=(size/8+((size%8)?1:0))*(size/2);		//õһַӦռֽ	
+	const u8 *mat;
  	num=num-' ';//õƫƺֵASCIIֿǴӿոʼȡģ-' 'ǶӦַֿ⣩
-	for(t=0;t<csize;t++)
-	{   
-		if(size==12)temp=asc2_1206[num][t]; 	 	//1206
-		else if(size==16)temp=asc2_1608[num][t];	//1608
-		else if(size==24)temp=asc2_2412[num][t];	//2412
-		else return;								//ûеֿ
-		for(t1=0;t1<8;t1++)
-		{			    
-			if(temp&0x80)LCD_Fast_DrawPoint(x,y,POINT_COLOR);
-			else if(mode==0)LCD_Fast_DrawPoint(x,y,BACK_COLOR);
-			temp<<=1;
-			y++;
-			if(y>=lcddev.height)return;		//
-			if((y-y0)==size)
+	if(size==12)mat=asc2_1206[num]; 	 	//1206
+	else if(size==16)mat=asc2_1608[num];	//1608
+	else if(size==24)mat=asc2_2412[num];	//2412
+	else return;							//ûеֿ
+	LCD_Blit_Mono(x,y,size/2,size,mat,mode);
+}
+//ɫ(ģ),д:ÿh,λ,ÿռ(h+7)/8ֽ
+//x,y:Ͻ;w,h:(Ļֲõ)
+//mode:0,ǵ(1POINT_COLOR,0BACK_COLOR);1,(ֻ1)
+//ǵ:һδںдw*h
+//:ÿа1ϲһ,ÿһιд
+void LCD_Blit_Mono(u16 x,u16 y,u16 w,u16 h,const u8 *bits,u8 mode)
+{
+	u16 r,c,c0,cw,ch;
+	u16 stride=(h+7)/8;
+	u16 fc=POINT_COLOR,bc=BACK_COLOR;
+	if(x>=lcddev.width||y>=lcddev.height)return;
+	cw=(x+w>lcddev.width)?lcddev.width-x:w;		//ü
+	ch=(y+h>lcddev.height)?lcddev.height-y:h;
+	if(mode==0)
+	{
+		LCD_Set_Window(x,y,cw,ch);
+		LCD_WriteRAM_Prepare();
+		for(r=0;r<ch;r++)
+		{
+			const u8 *p=bits+(r>>3);
+			u8 m=0x80>>(r&7);
+			for(c=0;c<cw;c++,p+=stride)LCD->LCD_RAM=(*p&m)?fc:bc;
+		}
+		LCD_Window_Raw(0,0,lcddev.width,lcddev.height);	//ָȫ
+	}else
+	{
+		LCD_DMA_Wait();
+		for(r=0;r<ch;r++)
+		{
+			const u8 *p=bits+(r>>3);
+			u8 m=0x80>>(r&7);
+			for(c=0;c<cw;)
 			{
-				y=y0;
-				x++;
-				if(x>=lcddev.width)return;	//
-				break;
+				if(!(p[c*stride]&m)){c++;continue;}
+				c0=c;
+				while(c<cw&&(p[c*stride]&m))c++;
+				LCD_CURSOR(x+c0,y+r);		//ѭǰѵȹDMA
+				LCD->LCD_REG=lcddev.wramcmd;
+				for(;c0<c;c0++)LCD->LCD_RAM=fc;
 			}
-		}  	 
-	}  	    	   	 	  
+		}
+	}
 }   
 //m^n
 //ֵ:m^nη.
@@ -2693,29 +2874,39 @@ void LCD_ShowString(u16 x, u16 y, u16 width, u16 height, u8 size, u8 *p)
     }  
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+//ٶȲ(ڴӡ /),Ƚ LCD_FIXED_CTRL ֱ뷽ʽʱһ
+//n:ÿĵ;ԻḲĻ
+void LCD_Bench(u32 n)
+{
+	const char *name[3]={"LCD_Fast_DrawPoint","+д","д"};
+	u32 mode,i,cyc,rate;
+	u16 x,y;
+	LCD_DMA_Wait();
+#if LCD_FIXED_CTRL==0
+	printf("[LCD]  ID=%x\r\n",lcddev.id);
+#else
+	printf("[LCD] ̶ %x\r\n",LCD_FIXED_CTRL);
+#endif
+	for(mode=0;mode<3;mode++)
+	{
+		x=0;y=0;
+		cyc=DWT->CYCCNT;
+		if(mode==2)
+		{
+			LCD_WINDOW(0,0,lcddev.width,lcddev.height);
+			LCD->LCD_REG=lcddev.wramcmd;
+		}
+		for(i=0;i<n;i++)
+		{
+			if(mode==0)LCD_Fast_DrawPoint(x,y,(u16)i);
+			else if(mode==1)LCD_POINT(x,y,(u16)i);
+			else LCD->LCD_RAM=(u16)i;
+			if(++x>=lcddev.width){x=0;if(++y>=lcddev.height)y=0;}
+		}
+		cyc=DWT->CYCCNT-cyc;
+		if(cyc==0)cyc=1;
+		rate=(u32)((unsigned long long)n*SystemCoreClock/cyc);
+		printf("[LCD] %s: %lu %lu/ %lu/s\r\n",name[mode],(unsigned long)n,(unsigned long)(cyc/n),(unsigned long)rate);
+	}
+	LCD_WINDOW(0,0,lcddev.width,lcddev.height);
+}
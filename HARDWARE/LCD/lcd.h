@@ -41,8 +41,28 @@ typedef struct
 	u16  setycmd;		//yָ 
 }_lcd_dev; 	  
 
+//صĹ//
+//LCD_FIXED_CTRLΪ0ʱIDLCD_Display_Dirѡ,Ⱥָһ,жID
+//ΪĳID(0X9341/0X5510/0X1963,MIPIICȡһ)ʱֱIC,Ҫ±
+typedef struct
+{
+	void (*cursor)(u16 x,u16 y);						//ù
+	void (*window)(u16 sx,u16 sy,u16 width,u16 height);	//ô
+	void (*point)(u16 x,u16 y,u16 color);				//(дGRAMָ)
+}_lcd_drv;
+
+#ifndef LCD_FIXED_CTRL
+#define LCD_FIXED_CTRL	0		//0,ʱIDѡ;,ʱ̶Ϊÿ
+#endif
+#ifndef LCD_FIXED_DIR
+#define LCD_FIXED_DIR	1		//LCD_FIXED_CTRLΪ0X1963ʱͬʱ̶(X):0,;1,
+#endif
+
 //LCD
 extern _lcd_dev lcddev;	//LCDҪ
+#if LCD_FIXED_CTRL==0
+extern _lcd_drv lcd_drv;	//ǰ
+#endif
 //LCDĻɫͱɫ	   
 extern u16  POINT_COLOR;//ĬϺɫ    
 extern u16  BACK_COLOR; //ɫ.ĬΪɫ
@@ -52,6 +72,9 @@ extern u16  BACK_COLOR; //
 //-----------------LCD˿ڶ---------------- 
 #define	LCD_LED PBout(15)  		//LCD    		 PB15 	    
 //LCDַṹ
+#ifdef LCD_SIM
+#include "lcdsim_bus.h"		//ģ(tools/lcdsim):߶дģͲ
+#else
 typedef struct
 {
 	vu16 LCD_REG;
@@ -61,8 +84,13 @@ typedef struct
 //עʱSTM32ڲһλ! 111 1110=0X7E			    
 #define LCD_BASE        ((u32)(0x6C000000 | 0x0000007E))
 #define LCD             ((LCD_TypeDef *) LCD_BASE)
+#endif
 //////////////////////////////////////////////////////////////////////////////////
 	 
+//DMA
+#define LCD_DMA_IRQ_PRIO		6		//DMA2_Stream0жռȼ(벻FreeRTOSɹȼ5)
+#define LCD_DMA_MIN_POINTS		64		//ڴ˵ֱCPUд
+	 
 //ɨ跽
 #define L2R_U2D  0 //,ϵ
 #define L2R_D2U  1 //,µ
@@ -119,6 +147,7 @@ void LCD_DrawRectangle(u16 x1, u16 y1, u16 x2, u16 y2);		   				//
 void LCD_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 color);		   				//䵥ɫ
 void LCD_Color_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 *color);				//ָɫ
 void LCD_ShowChar(u16 x,u16 y,u8 num,u8 size,u8 mode);						//ʾһַ
+void LCD_Blit_Mono(u16 x,u16 y,u16 w,u16 h,const u8 *bits,u8 mode);		//ɫ(д)
 void LCD_ShowNum(u16 x,u16 y,u32 num,u8 len,u8 size);  						//ʾһ
 void LCD_ShowxNum(u16 x,u16 y,u32 num,u8 len,u8 size,u8 mode);				//ʾ 
 void LCD_ShowString(u16 x,u16 y,u16 width,u16 height,u8 size,u8 *p);		//ʾһַ,12/16
@@ -130,7 +159,12 @@ void LCD_WriteRAM(u16 RGB_Code);
 void LCD_SSD_BackLightSet(u8 pwm);							//SSD1963 
 void LCD_Scan_Dir(u8 dir);									//ɨ跽
 void LCD_Display_Dir(u8 dir);								//Ļʾ
-void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height);	//ô					   						   																			 
+void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height);	//ô
+void LCD_DMA_Init(void);									//DMAʼ
+void LCD_DMA_Wait(void);									//ȴDMA
+u8   LCD_DMA_IsBusy(void);									//DMAǷ
+void LCD_Fill_Async(u16 sx,u16 sy,u16 ex,u16 ey,u16 color,void (*done)(void *arg),void *arg);	//DMA첽
+void LCD_Bench(u32 n);										//ٶȲ					   						   																			 
 //LCDֱ
 #define SSD_HOR_RESOLUTION		800		//LCDˮƽֱ
 #define SSD_VER_RESOLUTION		480		//LCDֱֱ
@@ -82,11 +82,84 @@ u8 SPI1_ReadWriteByte(u8 TxData)
 	return SPI_I2S_ReceiveData(SPI1); //ͨSPIxյ	
  		    
 }
+//SPI1 DMA:DMA2 Stream2 Channel3(RX),DMA2 Stream3 Channel3(TXԪ0xFF)
+//RXȫ꼴֡,ֻRXж
+static const u8 SPI1_DMA_Dummy=0xFF;
+static void (*SPI1_DMA_Done)(u8 err)=0;
 
+void SPI1_DMA_Init(void)
+{
+	DMA_InitTypeDef  DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
 
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2,ENABLE);	//DMA2ʱʹ
+	DMA_DeInit(DMA2_Stream2);
+	DMA_DeInit(DMA2_Stream3);
+	while(DMA_GetCmdStatus(DMA2_Stream2)!=DISABLE);		//ȴDMA
+	while(DMA_GetCmdStatus(DMA2_Stream3)!=DISABLE);
 
+	DMA_InitStructure.DMA_Channel=DMA_Channel_3;
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(u32)&SPI1->DR;
+	DMA_InitStructure.DMA_Memory0BaseAddr=0;			//ʱ
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralToMemory;
+	DMA_InitStructure.DMA_BufferSize=1;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_VeryHigh;	//,ֹ
+	DMA_InitStructure.DMA_FIFOMode=DMA_FIFOMode_Disable;
+	DMA_InitStructure.DMA_FIFOThreshold=DMA_FIFOThreshold_Full;
+	DMA_InitStructure.DMA_MemoryBurst=DMA_MemoryBurst_Single;
+	DMA_InitStructure.DMA_PeripheralBurst=DMA_PeripheralBurst_Single;
+	DMA_Init(DMA2_Stream2,&DMA_InitStructure);			//RX
 
+	DMA_InitStructure.DMA_Memory0BaseAddr=(u32)&SPI1_DMA_Dummy;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_MemoryToPeripheral;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Disable;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_High;
+	DMA_Init(DMA2_Stream3,&DMA_InitStructure);			//TX
 
-
-
-
+	DMA_ITConfig(DMA2_Stream2,DMA_IT_TC|DMA_IT_TE,ENABLE);
+	NVIC_InitStructure.NVIC_IRQChannel=DMA2_Stream2_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=SPI1_DMA_IRQ_PRIO;	//صܵFromISRӿ
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+//һDMA(0xFFʱ)
+//rx:ջ(CCM RAM,DMAʲ);len:ֽ(1~65535)
+//done:DMAже,err=1ʾ
+void SPI1_DMA_Read(u8 *rx,u16 len,void (*done)(u8 err))
+{
+	SPI1_DMA_Done=done;
+	while(SPI_I2S_GetFlagStatus(SPI1,SPI_I2S_FLAG_BSY)==SET);	//ȴǰֽڷ
+	(void)SPI1->DR;										//RXNE
+	DMA_ClearFlag(DMA2_Stream2,DMA_FLAG_TCIF2|DMA_FLAG_HTIF2|DMA_FLAG_TEIF2|DMA_FLAG_FEIF2|DMA_FLAG_DMEIF2);
+	DMA_ClearFlag(DMA2_Stream3,DMA_FLAG_TCIF3|DMA_FLAG_HTIF3|DMA_FLAG_TEIF3|DMA_FLAG_FEIF3|DMA_FLAG_DMEIF3);
+	DMA2_Stream2->M0AR=(u32)rx;
+	DMA_SetCurrDataCounter(DMA2_Stream2,len);
+	DMA_SetCurrDataCounter(DMA2_Stream3,len);
+	DMA_Cmd(DMA2_Stream2,ENABLE);						//ȿٿ
+	DMA_Cmd(DMA2_Stream3,ENABLE);
+	SPI_I2S_DMACmd(SPI1,SPI_I2S_DMAReq_Rx|SPI_I2S_DMAReq_Tx,ENABLE);
+}
+//SPI1DMAж
+void DMA2_Stream2_IRQHandler(void)
+{
+	u8 err=0;
+	if(DMA_GetITStatus(DMA2_Stream2,DMA_IT_TEIF2)!=RESET)
+	{
+		DMA_ClearITPendingBit(DMA2_Stream2,DMA_IT_TEIF2);
+		err=1;
+	}
+	if(DMA_GetITStatus(DMA2_Stream2,DMA_IT_TCIF2)!=RESET||err)
+	{
+		DMA_ClearITPendingBit(DMA2_Stream2,DMA_IT_TCIF2);
+		SPI_I2S_DMACmd(SPI1,SPI_I2S_DMAReq_Rx|SPI_I2S_DMAReq_Tx,DISABLE);
+		DMA_Cmd(DMA2_Stream2,DISABLE);
+		DMA_Cmd(DMA2_Stream3,DISABLE);
+		if(SPI1_DMA_Done)SPI1_DMA_Done(err);
+	}
+}
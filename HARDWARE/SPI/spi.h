@@ -19,6 +19,10 @@
 void SPI1_Init(void);			 //ʼSPI1
 void SPI1_SetSpeed(u8 SpeedSet); //SPI1ٶ   
 u8 SPI1_ReadWriteByte(u8 TxData);//SPI1߶дһֽ
+
+#define SPI1_DMA_IRQ_PRIO	6		//DMA2_Stream2жռȼ(벻FreeRTOSɹȼ5)
+void SPI1_DMA_Init(void);		 //ʼSPI1DMAշͨ
+void SPI1_DMA_Read(u8 *rx,u16 len,void (*done)(u8 err));//DMAlenֽ,ɺжлص
 		 
 #endif
 
@@ -2,6 +2,9 @@
 #include "spi.h"
 #include "delay.h"	   
 #include "usart.h"	
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEK STM32F407
@@ -17,6 +20,18 @@
  
 u16 W25QXX_TYPE=W25Q128;	//ĬW25Q128
 
+//SPI1 ֿȡ(UI)ʹ洢ת־(/ˢ),
+//õݹ黥,W25QXX_Write ڲٵ Read/Erase,Աǵݹ
+static SemaphoreHandle_t W25QXX_Mutex=NULL;
+//DMAȡ״̬:BusyڼƬѡЧ,Sync=1ʱжͷźѵ
+static SemaphoreHandle_t W25QXX_DMA_Sem=NULL;
+static volatile u8 W25QXX_DMA_Busy=0;
+static volatile u8 W25QXX_DMA_Sync=0;
+static void (*W25QXX_DMA_Cb)(void *arg)=0;
+static void *W25QXX_DMA_Arg=0;
+static u32 W25QXX_DMA_Errors=0;
+u8 W25QXX_BUFFER[4096];		 
+
 //4KbytesΪһSector
 //16Ϊ1Block
 //W25Q128
@@ -44,9 +59,32 @@ void W25QXX_Init(void)
 	GPIO_SetBits(GPIOG,GPIO_Pin_7);//PG71,ֹNRFSPI FLASHͨ 
 	W25QXX_CS=1;			//SPI FLASHѡ
 	SPI1_Init();		   			//ʼSPI
-	SPI1_SetSpeed(SPI_BaudRatePrescaler_4);		//Ϊ21Mʱ,ģʽ 
+	SPI1_DMA_Init();				//SPI1 DMAͨ
+	SPI1_SetSpeed(SPI_BaudRatePrescaler_4);		//21MʱӶID
 	W25QXX_TYPE=W25QXX_ReadID();	//ȡFLASH ID.
+	SPI1_SetSpeed(W25QXX_SPI_PRESC);			//еʱ,IDһ˵ܲô,˻21M
+	if(W25QXX_ReadID()!=W25QXX_TYPE)
+	{
+		SPI1_SetSpeed(SPI_BaudRatePrescaler_4);
+		printf("[W25Q] ʱУʧ,˻21M\r\n");
+	}
+	if(W25QXX_Mutex==NULL)W25QXX_Mutex=xSemaphoreCreateRecursiveMutex();
+	if(W25QXX_DMA_Sem==NULL)W25QXX_DMA_Sem=xSemaphoreCreateBinary();
 }  
+//ȡ Flash (ǰֱӷ)
+//Ƕ׵, W25QXX_Unlock ɶʹ
+void W25QXX_Lock(void)
+{
+	if(W25QXX_Mutex!=NULL&&xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)
+		xSemaphoreTakeRecursive(W25QXX_Mutex,portMAX_DELAY);
+	W25QXX_DMA_Wait();				//һ첽ȡռ
+}
+//ͷ Flash 
+void W25QXX_Unlock(void)
+{
+	if(W25QXX_Mutex!=NULL&&xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)
+		xSemaphoreGiveRecursive(W25QXX_Mutex);
+}
 
 //ȡW25QXX״̬Ĵ
 //BIT7  6   5   4   3   2   1   0
@@ -110,25 +148,134 @@ u16 W25QXX_ReadID(void)
 	W25QXX_CS=1;				    
 	return Temp;
 }   		    
+//жϻܷDMA(CCM RAM 0x10000000~0x1000FFFF DMA)
+static u8 W25QXX_DMA_Able(const u8 *p)
+{
+	return ((u32)p&0xFFFF0000)!=0x10000000;
+}
+//Ϳٶͷ:0x0B+24bitַ+1ֽ
+static void W25QXX_FastRead_Cmd(u32 ReadAddr)
+{
+    SPI1_ReadWriteByte(W25X_FastReadData);     //Ϳٶȡ   
+    SPI1_ReadWriteByte((u8)((ReadAddr)>>16));  //24bitַ    
+    SPI1_ReadWriteByte((u8)((ReadAddr)>>8));   
+    SPI1_ReadWriteByte((u8)ReadAddr);   
+    SPI1_ReadWriteByte(0XFF);                  //8ʱ
+}
+//SPI DMA(ж):ͷƬѡ,ͬȴ߻첽ص
+static void W25QXX_DMA_Finish(u8 err)
+{
+	BaseType_t woken=pdFALSE;
+	W25QXX_CS=1;
+	if(err)W25QXX_DMA_Errors++;
+	W25QXX_DMA_Busy=0;
+	if(W25QXX_DMA_Sync)
+	{
+		W25QXX_DMA_Sync=0;
+		xSemaphoreGiveFromISR(W25QXX_DMA_Sem,&woken);		//ֻеʱŻSync
+	}else if(W25QXX_DMA_Cb)W25QXX_DMA_Cb(W25QXX_DMA_Arg);
+	portYIELD_FROM_ISR(woken);
+}
+//ȴ첽DMAȡ
+//ʱóCPU,ԭصȴ
+void W25QXX_DMA_Wait(void)
+{
+	while(W25QXX_DMA_Busy)
+	{
+		if(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)vTaskDelay(1);
+	}
+}
 //ȡSPI FLASH  
 //ַָʼȡָȵ
+//ʹ0x0Bٶ;ȲСW25QXX_DMA_MINʱDMA,ʱȴڼóCPU
 //pBuffer:ݴ洢
 //ReadAddr:ʼȡĵַ(24bit)
 //NumByteToRead:Ҫȡֽ(65535)
 void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead)   
 { 
  	u16 i;   										    
+	if(NumByteToRead==0)return;
+	W25QXX_Lock();
 	W25QXX_CS=0;                            //ʹ   
-    SPI1_ReadWriteByte(W25X_ReadData);         //Ͷȡ   
-    SPI1_ReadWriteByte((u8)((ReadAddr)>>16));  //24bitַ    
-    SPI1_ReadWriteByte((u8)((ReadAddr)>>8));   
-    SPI1_ReadWriteByte((u8)ReadAddr);   
-    for(i=0;i<NumByteToRead;i++)
-	{ 
-        pBuffer[i]=SPI1_ReadWriteByte(0XFF);   //ѭ  
-    }
-	W25QXX_CS=1;  				    	      
+	W25QXX_FastRead_Cmd(ReadAddr);
+	if(NumByteToRead>=W25QXX_DMA_MIN&&W25QXX_DMA_Able(pBuffer))
+	{
+		u8 rtos=(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING);
+		W25QXX_DMA_Busy=1;
+		W25QXX_DMA_Sync=rtos;
+		SPI1_DMA_Read(pBuffer,NumByteToRead,W25QXX_DMA_Finish);	//Ƭѡжͷ
+		if(rtos)xSemaphoreTake(W25QXX_DMA_Sem,portMAX_DELAY);
+		else while(W25QXX_DMA_Busy);
+	}else
+	{
+		for(i=0;i<NumByteToRead;i++)
+		{ 
+			pBuffer[i]=SPI1_ReadWriteByte(0XFF);   //ѭ  
+		}
+		W25QXX_CS=1;  				    	      
+	}
+	W25QXX_Unlock();
 }  
+//첽ȡSPI FLASH(DMA),
+//ɺDMAжdone(arg),doneֻʹFromISRӿ;ڼFlashȴζȡ
+//pBufferǰ뱣Ч,ҲλCCM RAM
+//ֵ:0,;1,ʺDMA(δ,W25QXX_Read)
+u8 W25QXX_Read_Async(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead,void (*done)(void *arg),void *arg)
+{
+	if(NumByteToRead==0||!W25QXX_DMA_Able(pBuffer))return 1;
+	W25QXX_Lock();
+	W25QXX_DMA_Cb=done;
+	W25QXX_DMA_Arg=arg;
+	W25QXX_DMA_Busy=1;
+	W25QXX_DMA_Sync=0;
+	W25QXX_CS=0;
+	W25QXX_FastRead_Cmd(ReadAddr);
+	SPI1_DMA_Read(pBuffer,NumByteToRead,W25QXX_DMA_Finish);
+	W25QXX_Unlock();						//W25QXX_DMA_Busyռ,´μʱȴ
+	return 0;
+}
+//ȡٶȲ,ͨڴӡ MB/s,ȷϰܷڸʱ
+//Ƚ:ԭ0x03ֽڶ(21M)0x0Bֽڶ0x0B DMA(ʱ)
+//addr:ʼַ;len:ÿַʽȡֽ(40M)
+void W25QXX_Bench(u32 addr,u32 len)
+{
+	const char *name[3]={"0x03 ѯ 21M","0x0B ѯ","0x0B DMA"};
+	u8 *buf=W25QXX_BUFFER;
+	u32 mode,done,n,cyc,us,rate,i;
+	W25QXX_Lock();
+	for(mode=0;mode<3;mode++)
+	{
+		SPI1_SetSpeed(mode==0?SPI_BaudRatePrescaler_4:W25QXX_SPI_PRESC);
+		cyc=DWT->CYCCNT;
+		for(done=0;done<len;done+=n)
+		{
+			n=len-done>4096?4096:len-done;
+			if(mode==0)
+			{
+				W25QXX_CS=0;
+				SPI1_ReadWriteByte(W25X_ReadData);
+				SPI1_ReadWriteByte((u8)((addr+done)>>16));
+				SPI1_ReadWriteByte((u8)((addr+done)>>8));
+				SPI1_ReadWriteByte((u8)(addr+done));
+				for(i=0;i<n;i++)buf[i]=SPI1_ReadWriteByte(0XFF);
+				W25QXX_CS=1;
+			}else if(mode==1)
+			{
+				W25QXX_CS=0;
+				W25QXX_FastRead_Cmd(addr+done);
+				for(i=0;i<n;i++)buf[i]=SPI1_ReadWriteByte(0XFF);
+				W25QXX_CS=1;
+			}else W25QXX_Read(buf,addr+done,(u16)n);
+		}
+		us=(DWT->CYCCNT-cyc)/(SystemCoreClock/1000000);
+		if(us==0)us=1;
+		rate=len*100/us;				//ֽ/΢뼴MB/s,Ŵ100λС
+		printf("[W25Q] %s: %luֽ %luus %lu.%02luMB/s\r\n",name[mode],len,us,rate/100,rate%100);
+	}
+	SPI1_SetSpeed(W25QXX_SPI_PRESC);
+	printf("[W25Q] DMA=%lu\r\n",W25QXX_DMA_Errors);
+	W25QXX_Unlock();
+}
 //SPIһҳ(0~65535)д256ֽڵ
 //ַָʼд256ֽڵ
 //pBuffer:ݴ洢
@@ -137,6 +284,7 @@ void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead)
 void W25QXX_Write_Page(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 {
  	u16 i;  
+	W25QXX_Lock();
     W25QXX_Write_Enable();                  //SET WEL 
 	W25QXX_CS=0;                            //ʹ   
     SPI1_ReadWriteByte(W25X_PageProgram);      //дҳ   
@@ -146,6 +294,7 @@ void W25QXX_Write_Page(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
     for(i=0;i<NumByteToWrite;i++)SPI1_ReadWriteByte(pBuffer[i]);//ѭд  
 	W25QXX_CS=1;                            //ȡƬѡ 
 	W25QXX_Wait_Busy();					   //ȴд
+	W25QXX_Unlock();
 } 
 //޼дSPI FLASH 
 //ȷдĵַΧڵȫΪ0XFF,ڷ0XFFдݽʧ!
@@ -181,7 +330,6 @@ void W25QXX_Write_NoCheck(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 //pBuffer:ݴ洢
 //WriteAddr:ʼдĵַ(24bit)						
 //NumByteToWrite:Ҫдֽ(65535)   
-u8 W25QXX_BUFFER[4096];		 
 void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)   
 { 
 	u32 secpos;
@@ -195,6 +343,7 @@ void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 	secremain=4096-secoff;//ʣռС   
  	//printf("ad:%X,nb:%X\r\n",WriteAddr,NumByteToWrite);//
  	if(NumByteToWrite<=secremain)secremain=NumByteToWrite;//4096ֽ
+	W25QXX_Lock();
 	while(1) 
 	{	
 		W25QXX_Read(W25QXX_BUF,secpos*4096,4096);//
@@ -225,6 +374,7 @@ void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 			else secremain=NumByteToWrite;			//һд
 		}	 
 	};	 
+	W25QXX_Unlock();
 }
 //оƬ		  
 //ȴʱ䳬...
@@ -240,11 +390,13 @@ void W25QXX_Erase_Chip(void)
 //һ
 //Dst_Addr:ַ ʵ
 //һɽʱ:150ms
+//ʱڼóCPU(Գ,Flashȴ)
 void W25QXX_Erase_Sector(u32 Dst_Addr)   
 {  
 	//falsh,   
- 	printf("fe:%x\r\n",Dst_Addr);	  
+ 	//printf("fe:%x\r\n",Dst_Addr);	  
  	Dst_Addr*=4096;
+	W25QXX_Lock();
     W25QXX_Write_Enable();                  //SET WEL 	 
     W25QXX_Wait_Busy();   
   	W25QXX_CS=0;                            //ʹ   
@@ -253,7 +405,11 @@ void W25QXX_Erase_Sector(u32 Dst_Addr)
     SPI1_ReadWriteByte((u8)((Dst_Addr)>>8));   
     SPI1_ReadWriteByte((u8)Dst_Addr);  
 	W25QXX_CS=1;                            //ȡƬѡ     	      
-    W25QXX_Wait_Busy();   				   //ȴ
+	if(xTaskGetSchedulerState()==taskSCHEDULER_RUNNING)
+	{
+		while((W25QXX_ReadSR()&0x01)==0x01)vTaskDelay(2);	//45ms,ѯ2ms
+	}else W25QXX_Wait_Busy();   		   //ȴ
+	W25QXX_Unlock();
 }  
 //ȴ
 void W25QXX_Wait_Busy(void)   
@@ -37,6 +37,10 @@ extern u16 W25QXX_TYPE;					//
 
 #define	W25QXX_CS 		PBout(14)  		//W25QXXƬѡź
 
+//ȡ
+#define W25QXX_SPI_PRESC	SPI_BaudRatePrescaler_2	//ʱ:84M/2=42M(0x0Bٶֵ֧104M)
+#define W25QXX_DMA_MIN		128			//ȡֽСڴֵʱʹDMA,С(ģ)ֱѯ
+
 ////////////////////////////////////////////////////////////////////////////////// 
 //ָ
 #define W25X_WriteEnable		0x06 
@@ -62,14 +66,20 @@ u8	 W25QXX_ReadSR(void);        		//
 void W25QXX_Write_SR(u8 sr);  			//д״̬Ĵ
 void W25QXX_Write_Enable(void);  		//дʹ 
 void W25QXX_Write_Disable(void);		//д
+void W25QXX_Write_Page(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);//ҳ(,ҳ)
 void W25QXX_Write_NoCheck(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);
-void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead);   //ȡflash
+void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead);   //ȡflash(ٶ,DMA)
+u8   W25QXX_Read_Async(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead,void (*done)(void *arg),void *arg);//첽DMAȡ
+void W25QXX_DMA_Wait(void);				//ȴ첽ȡ
+void W25QXX_Bench(u32 addr,u32 len);	//ȡٶȲ(ڴӡMB/s)
 void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);//дflash
 void W25QXX_Erase_Chip(void);    	  	//Ƭ
 void W25QXX_Erase_Sector(u32 Dst_Addr);	//
 void W25QXX_Wait_Busy(void);           	//ȴ
 void W25QXX_PowerDown(void);        	//ģʽ
 void W25QXX_WAKEUP(void);				//
+void W25QXX_Lock(void);					//ȡFlash(Ƕ)
+void W25QXX_Unlock(void);				//ͷFlash
 #endif
 
 
@@ -2,7 +2,7 @@
  * hgq_aht20.c
  * AHT20数字温湿度传感器驱动程序
  * 功能：测量环境温度和相对湿度
- * 接口：I2C通信，使用第二路软件I2C
+ * 接口：I2C通信，挂在 HGQ_I2C_AHT 总线（PB6/PB7，I2C1 + DMA）
  * 作者：黄光全
  * 日期：2025-12-26
  * 
@@ -29,80 +29,45 @@
  */
 
 #include "hgq_aht20.h"
-#include "hgq_myiic2.h"  /* 第二路软件I2C */
+#include "hgq_i2c.h"
+#include "hgq_filter.h"
 #include "delay.h"
 
 /* AHT20 I2C地址定义 */
 #define HGQ_AHT20_ADDR   0x38      /* AHT20的7位I2C地址 */
-#define HGQ_AHT20_W      (HGQ_AHT20_ADDR<<1)      /* 写地址：bit0=0 */
-#define HGQ_AHT20_R      ((HGQ_AHT20_ADDR<<1) | 1) /* 读地址：bit0=1 */
+
+#if HGQ_AHT20_FILTER
+/* 温湿度各一套：Hampel 剔除偶发坏帧，EMA 平滑量化噪声（数值按 x100 定点） */
+static HGQ_Hampel s_hp_t, s_hp_h;
+static HGQ_Ema    s_ema_t, s_ema_h;
+#endif
 
 /**
  * @brief 向AHT20发送命令序列
  * @param cmd: 命令数组指针
  * @param len: 命令长度（字节数）
- * @note 支持发送多字节命令序列
- * @retval 0: 成功，1: 地址ACK失败，2: 数据ACK失败
+ * @retval 0: 成功，其他: HGQ_I2C_xxx 错误码
  */
 static uint8_t HGQ_AHT20_WriteCmd(const uint8_t *cmd, uint8_t len)
 {
-    /* I2C起始信号 */
-    HGQ_IIC2_Start();
-    
-    /* 发送设备地址（写模式）*/
-    HGQ_IIC2_SendByte(HGQ_AHT20_W);
-    if (HGQ_IIC2_WaitAck()) { 
-        HGQ_IIC2_Stop(); 
-        return 1;  /* 地址ACK失败 */
-    }
-    
-    /* 发送命令序列的每个字节 */
-    for (uint8_t i = 0; i < len; i++)
-    {
-        HGQ_IIC2_SendByte(cmd[i]);
-        if (HGQ_IIC2_WaitAck()) { 
-            HGQ_IIC2_Stop(); 
-            return 2;  /* 数据ACK失败 */
-        }
-    }
-    
-    /* I2C停止信号 */
-    HGQ_IIC2_Stop();
-    return 0;  /* 成功 */
+    return HGQ_I2C_Write(HGQ_I2C_AHT, HGQ_AHT20_ADDR, cmd, len);
 }
 
 /**
  * @brief 从AHT20读取多个字节数据
  * @param buf: 数据接收缓冲区
  * @param len: 要读取的字节数
- * @note 读取完成后发送NACK表示停止接收
- * @retval 0: 成功，1: 地址ACK失败
+ * @retval 0: 成功，其他: HGQ_I2C_xxx 错误码
  */
 static uint8_t HGQ_AHT20_ReadBytes(uint8_t *buf, uint8_t len)
 {
-    /* I2C起始信号 */
-    HGQ_IIC2_Start();
-    
-    /* 发送设备地址（读模式）*/
-    HGQ_IIC2_SendByte(HGQ_AHT20_R);
-    if (HGQ_IIC2_WaitAck()) { 
-        HGQ_IIC2_Stop(); 
-        return 1;  /* 地址ACK失败 */
-    }
-    
-    /* 读取指定数量的字节 */
-    for (uint8_t i = 0; i < len; i++)
-        buf[i] = HGQ_IIC2_ReadByte(i != (len - 1)); /* 最后一个字节发NACK */
-    
-    /* I2C停止信号 */
-    HGQ_IIC2_Stop();
-    return 0;  /* 成功 */
+    return HGQ_I2C_Read(HGQ_I2C_AHT, HGQ_AHT20_ADDR, buf, len);
 }
 
 /**
  * @brief AHT20传感器初始化
  * @note 初始化步骤：
- *       1. 初始化I2C总线
+ *       1. 初始化I2C总线（可重复调用）
  *       2. 发送初始化命令（0xBE 0x08 0x00）
  *       3. 等待传感器稳定
  * @retval 0: 成功，1: 初始化失败
@@ -113,7 +78,15 @@ uint8_t HGQ_AHT20_Init(void)
     uint8_t cmd[3] = {0xBE, 0x08, 0x00};
     
     /* 初始化I2C总线 */
-    HGQ_IIC2_Init();
+    HGQ_I2C_Init(HGQ_I2C_AHT);
+
+#if HGQ_AHT20_FILTER
+    /* 复位滤波器：k=3.0（Q8） */
+    HGQ_Hampel_Init(&s_hp_t, HGQ_AHT20_FILT_N, 3 * 256, HGQ_AHT20_HAMPEL_T);
+    HGQ_Hampel_Init(&s_hp_h, HGQ_AHT20_FILT_N, 3 * 256, HGQ_AHT20_HAMPEL_H);
+    HGQ_Ema_Init(&s_ema_t, HGQ_AHT20_FILT_EMA);
+    HGQ_Ema_Init(&s_ema_h, HGQ_AHT20_FILT_EMA);
+#endif
     
     /* AHT20上电后需要至少40ms稳定时间 */
     delay_ms(40);
@@ -127,54 +100,41 @@ uint8_t HGQ_AHT20_Init(void)
 }
 
 /**
- * @brief 读取AHT20的温湿度数据
+ * @brief 触发一次测量，不等待结果
+ * @note 发送测量触发命令（0xAC 0x33 0x00），约80ms后可用 HGQ_AHT20_Collect 取数
+ * @retval 0: 成功，1: 触发测量失败
+ */
+uint8_t HGQ_AHT20_Trigger(void)
+{
+    /* 测量触发命令：0xAC（触发测量），0x33（参数），0x00（保留）*/
+    static const uint8_t cmd[3] = {0xAC, 0x33, 0x00};
+
+    if (HGQ_AHT20_WriteCmd(cmd, 3))
+        return 1;  /* 触发测量失败 */
+    return 0;
+}
+
+/**
+ * @brief 取回 HGQ_AHT20_Trigger 启动的测量结果
  * @param temp_c: 温度输出指针（单位：℃）
  * @param humi_rh: 湿度输出指针（单位：%RH）
- * @note 测量流程：
- *       1. 发送测量触发命令（0xAC 0x33 0x00）
- *       2. 等待测量完成（检查状态寄存器busy位）
- *       3. 读取6字节原始数据（状态+湿度+温度）
- *       4. 转换为实际温湿度值
+ * @note 一次读6字节（状态+湿度+温度），状态字节busy位为1时结果无效
  * @retval 0: 成功
- *         1: 触发测量失败
- *         2: 状态读取失败
- *         3: 测量超时
- *         4: 数据读取失败
+ *         1: 仍在测量（busy）
+ *         2: 数据读取失败
  */
-uint8_t HGQ_AHT20_Read(float *temp_c, float *humi_rh)
+uint8_t HGQ_AHT20_Collect(float *temp_c, float *humi_rh)
 {
-    /* 测量触发命令：0xAC（触发测量），0x33（参数），0x00（保留）*/
-    uint8_t cmd[3] = {0xAC, 0x33, 0x00};
     uint8_t data[6];           /* 6字节数据缓冲区 */
-    uint16_t timeout = 200;    /* 超时计数器（约1秒）*/
-    
-    /* 1. 发送测量触发命令 */
-    if (HGQ_AHT20_WriteCmd(cmd, 3)) 
-        return 1;  /* 触发测量失败 */
-    
-    /* 2. 等待测量完成（busy位为0）*/
-    delay_ms(10);  /* 测量需要至少75ms */
-    
-    do {
-        /* 读取状态寄存器（1字节）*/
-        if (HGQ_AHT20_ReadBytes(data, 1)) 
-            return 2;  /* 状态读取失败 */
-        
-        /* 检查busy位（bit7）：0表示测量完成 */
-        if ((data[0] & 0x80) == 0) 
-            break;     /* 测量完成 */
-        
-        delay_ms(5);   /* 等待5ms再次检查 */
-    } while(--timeout);
-    
-    if (timeout == 0) 
-        return 3;  /* 测量超时 */
-    
-    /* 3. 读取完整的6字节数据 */
-    if (HGQ_AHT20_ReadBytes(data, 6)) 
-        return 4;  /* 数据读取失败 */
-    
-    /* 4. 数据解析和转换 */
+
+    if (HGQ_AHT20_ReadBytes(data, 6))
+        return 2;  /* 数据读取失败 */
+
+    /* 检查busy位（bit7）：0表示测量完成 */
+    if (data[0] & 0x80)
+        return 1;
+
+    /* 数据解析和转换 */
     {
         /* 湿度数据：data[1:3]的20位数据
          * data[1]: 湿度高8位
@@ -194,13 +154,58 @@ uint8_t HGQ_AHT20_Read(float *temp_c, float *humi_rh)
                           ((uint32_t)data[4] << 8) | 
                           data[5];
         
+#if HGQ_AHT20_FILTER
+        /* 定点 x100 后过滤波：湿度 = raw*10000/2^20，温度 = raw*20000/2^20 - 5000 */
+        int32_t h100 = (int32_t)(((uint64_t)rh_raw * 10000U) >> 20);
+        int32_t t100 = (int32_t)(((uint64_t)t_raw * 20000U) >> 20) - 5000;
+
+        h100 = HGQ_Ema_Put(&s_ema_h, HGQ_Hampel_Put(&s_hp_h, h100));
+        t100 = HGQ_Ema_Put(&s_ema_t, HGQ_Hampel_Put(&s_hp_t, t100));
+        *humi_rh = (float)h100 / 100.0f;
+        *temp_c  = (float)t100 / 100.0f;
+#else
         /* 转换为实际温湿度值
          * 湿度：RH(%) = raw * 100 / 2^20
          * 温度：T(℃) = raw * 200 / 2^20 - 50
          */
         *humi_rh = (float)rh_raw * 100.0f / 1048576.0f;  /* 2^20 = 1048576 */
         *temp_c  = (float)t_raw  * 200.0f / 1048576.0f - 50.0f;
+#endif
     }
     
     return 0;  /* 成功 */
 }
+
+/**
+ * @brief 读取AHT20的温湿度数据（阻塞）
+ * @param temp_c: 温度输出指针（单位：℃）
+ * @param humi_rh: 湿度输出指针（单位：%RH）
+ * @note 测量流程：
+ *       1. 发送测量触发命令（HGQ_AHT20_Trigger）
+ *       2. 等待测量完成（busy位为0）
+ *       3. 读取6字节原始数据并转换（HGQ_AHT20_Collect）
+ * @retval 0: 成功
+ *         1: 触发测量失败
+ *         3: 测量超时
+ *         4: 数据读取失败
+ */
+uint8_t HGQ_AHT20_Read(float *temp_c, float *humi_rh)
+{
+    uint16_t timeout = 200;    /* 超时计数器（约1秒）*/
+    uint8_t r;
+    
+    /* 1. 发送测量触发命令 */
+    if (HGQ_AHT20_Trigger()) 
+        return 1;  /* 触发测量失败 */
+    
+    /* 2. 等待测量完成（busy位为0）*/
+    delay_ms(10);  /* 测量需要至少75ms */
+    
+    while ((r = HGQ_AHT20_Collect(temp_c, humi_rh)) == 1) {
+        if (--timeout == 0) 
+            return 3;  /* 测量超时 */
+        delay_ms(5);   /* 等待5ms再次检查 */
+    }
+    
+    return r ? 4 : 0;
+}
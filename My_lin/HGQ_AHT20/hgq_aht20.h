@@ -24,10 +24,17 @@
  * 连接方式：
  * VCC -> 3.3V
  * GND -> GND
- * SCL -> PB6（第二路I2C时钟）
- * SDA -> PB7（第二路I2C数据）
+ * SCL -> PB6（I2C1 时钟，HGQ_I2C_AHT 总线）
+ * SDA -> PB7（I2C1 数据）
  */
 
+/* 输出滤波：1 = Hampel 剔除坏值 + EMA 平滑（HGQ_FILTER），0 = 原始值 */
+#define HGQ_AHT20_FILTER      1
+#define HGQ_AHT20_FILT_N      5       /* Hampel 窗口 */
+#define HGQ_AHT20_HAMPEL_T    50      /* Hampel 阈值下限：温度 0.5℃ (x100)，偏差不超过它的不算坏值 */
+#define HGQ_AHT20_HAMPEL_H    200     /* 湿度 2%RH (x100) */
+#define HGQ_AHT20_FILT_EMA    1       /* EMA 系数 1/2^n */
+
 /**
  * @brief AHT20传感器初始化
  * @note 初始化I2C总线并发送校准命令
@@ -37,14 +44,28 @@
 uint8_t HGQ_AHT20_Init(void);
 
 /**
- * @brief 读取AHT20的温湿度数据
+ * @brief 触发一次测量，不等待结果（非阻塞用法第一步）
+ * @note 测量约80ms，之后调用 HGQ_AHT20_Collect 取数
+ * @retval 0: 成功，1: 触发测量失败
+ */
+uint8_t HGQ_AHT20_Trigger(void);
+
+/**
+ * @brief 取回测量结果（非阻塞用法第二步）
+ * @param temp_c: 温度输出指针（单位：℃）
+ * @param humi_rh: 湿度输出指针（单位：%RH）
+ * @retval 0: 成功，1: 仍在测量，2: 数据读取失败
+ */
+uint8_t HGQ_AHT20_Collect(float *temp_c, float *humi_rh);
+
+/**
+ * @brief 读取AHT20的温湿度数据（阻塞，内部即 Trigger + 等待 + Collect）
  * @param temp_c: 温度输出指针（单位：℃）
  * @param humi_rh: 湿度输出指针（单位：%RH）
  * @note 测量过程需要约80ms（75ms测量+5ms处理）
  *       建议测量间隔至少2秒以保证精度
  * @retval 0: 读取成功
  *         1: 触发测量失败
- *         2: 状态读取失败
  *         3: 测量超时
  *         4: 数据读取失败
  */
@@ -2,7 +2,7 @@
  * hgq_bh1750.c
  * BH1750光照强度传感器驱动程序
  * 功能：测量环境光照强度（0-65535 lux）
- * 接口：I2C通信，使用第三路软件I2C
+ * 接口：I2C通信，挂在 HGQ_I2C_LUX 总线（PC0/PC1 无硬件I2C，软件模拟）
  * 作者：黄光全
  * 日期：2025-12-26
  * 
@@ -27,41 +27,24 @@
  */
 
 #include "hgq_bh1750.h"
-#include "hgq_myiic3.h"  /* 第三路软件I2C */
+#include "hgq_i2c.h"
+#include "hgq_filter.h"
 #include "delay.h"
 
-/* 全局变量：I2C设备地址 */
-static uint8_t s_addr_w = 0;  /* 写地址：7位地址左移1位，bit0=0 */
-static uint8_t s_addr_r = 0;  /* 读地址：7位地址左移1位，bit0=1 */
+/* 全局变量：I2C设备7位地址 */
+static uint8_t s_addr = 0;
+
+/* 输出滤波：滑动中位数 */
+static HGQ_Median s_med;
 
 /**
  * @brief 向BH1750发送命令
  * @param cmd: BH1750命令字
- * @note 使用I2C写操作发送单个命令字节
- * @retval 0: 成功，1: 地址ACK失败，2: 数据ACK失败
+ * @retval 0: 成功，其他: HGQ_I2C_xxx 错误码
  */
 static uint8_t BH1750_WriteCmd(uint8_t cmd)
 {
-    /* I2C起始信号 */
-    HGQ_IIC3_Start();
-    
-    /* 发送设备地址（写模式）*/
-    HGQ_IIC3_SendByte(s_addr_w);
-    if (HGQ_IIC3_WaitAck()) { 
-        HGQ_IIC3_Stop(); 
-        return 1;  /* 地址ACK失败 */
-    }
-    
-    /* 发送命令字节 */
-    HGQ_IIC3_SendByte(cmd);
-    if (HGQ_IIC3_WaitAck()) { 
-        HGQ_IIC3_Stop(); 
-        return 2;  /* 数据ACK失败 */
-    }
-    
-    /* I2C停止信号 */
-    HGQ_IIC3_Stop();
-    return 0;  /* 成功 */
+    return HGQ_I2C_Write(HGQ_I2C_LUX, s_addr, &cmd, 1);
 }
 
 /**
@@ -69,28 +52,15 @@ static uint8_t BH1750_WriteCmd(uint8_t cmd)
  * @param msb: 高字节输出指针
  * @param lsb: 低字节输出指针
  * @note 读取光照强度原始数据（16位）
- * @retval 0: 成功，1: 地址ACK失败
+ * @retval 0: 成功，其他: HGQ_I2C_xxx 错误码
  */
 static uint8_t BH1750_Read2(uint8_t *msb, uint8_t *lsb)
 {
-    /* I2C起始信号 */
-    HGQ_IIC3_Start();
-    
-    /* 发送设备地址（读模式）*/
-    HGQ_IIC3_SendByte(s_addr_r);
-    if (HGQ_IIC3_WaitAck()) { 
-        HGQ_IIC3_Stop(); 
-        return 1;  /* 地址ACK失败 */
-    }
-    
-    /* 读取高字节，发送ACK */
-    *msb = HGQ_IIC3_ReadByte(1);
-    /* 读取低字节，发送NACK（最后一个字节）*/
-    *lsb = HGQ_IIC3_ReadByte(0);
-    
-    /* I2C停止信号 */
-    HGQ_IIC3_Stop();
-    return 0;  /* 成功 */
+    uint8_t buf[2];
+    uint8_t st = HGQ_I2C_Read(HGQ_I2C_LUX, s_addr, buf, 2);
+    *msb = buf[0];
+    *lsb = buf[1];
+    return st;
 }
 
 /**
@@ -107,12 +77,14 @@ static uint8_t BH1750_Read2(uint8_t *msb, uint8_t *lsb)
  */
 uint8_t HGQ_BH1750_Init(uint8_t addr_7bit)
 {
-    /* 初始化I2C总线 */
-    HGQ_IIC3_Init();
+    /* 初始化I2C总线（可重复调用）*/
+    HGQ_I2C_Init(HGQ_I2C_LUX);
     
-    /* 计算读写地址 */
-    s_addr_w = (addr_7bit << 1);      /* 写地址：bit0=0 */
-    s_addr_r = (addr_7bit << 1) | 1;  /* 读地址：bit0=1 */
+    /* 设备地址 */
+    s_addr = addr_7bit;
+    
+    /* 重新初始化后旧样本作废 */
+    HGQ_Median_Init(&s_med, HGQ_BH1750_FILT_N);
     
     /* 1. 上电命令：唤醒传感器 */
     if (BH1750_WriteCmd(0x01)) 
@@ -140,6 +112,7 @@ uint8_t HGQ_BH1750_Init(uint8_t addr_7bit)
  * @param lux: 光照强度输出指针（单位：lux）
  * @note 计算公式：lux = raw_data / 1.2
  *       避免浮点运算：lux = raw_data * 10 / 12
+ *       输出经过 HGQ_BH1750_FILT_N 点滑动中位数
  * @retval 0: 成功，1: 读取失败
  */
 uint8_t HGQ_BH1750_ReadLux(uint16_t *lux)
@@ -160,5 +133,8 @@ uint8_t HGQ_BH1750_ReadLux(uint16_t *lux)
      */
     *lux = (uint16_t)((raw * 10U) / 12U);
     
+    /* 滑动中位数滤波（窗口为1时即原值）*/
+    *lux = (uint16_t)HGQ_Median_Put(&s_med, *lux);
+    
     return 0;  /* 成功 */
 }
@@ -22,11 +22,14 @@
  * 连接方式：
  * VCC -> 3.3V/5V
  * GND -> GND
- * SCL -> PC0（第三路I2C时钟）
- * SDA -> PC1（第三路I2C数据）
+ * SCL -> PC0（HGQ_I2C_LUX 总线时钟，软件模拟）
+ * SDA -> PC1（HGQ_I2C_LUX 总线数据）
  * ADDR -> GND（地址0x23）或VCC（地址0x5C）
  */
 
+/* 输出滤波：滑动中位数窗口（HGQ_FILTER），去掉灯光闪烁/遮挡造成的单点跳变，1 = 不滤波 */
+#define HGQ_BH1750_FILT_N     3
+
 /**
  * @brief BH1750传感器初始化
  * @param addr_7bit: BH1750的7位I2C地址
@@ -0,0 +1,367 @@
+#include "hgq_at.h"
+#include "hgq_usart.h"
+#include "queue.h"
+#include <string.h>
+
+typedef struct {
+    char cmd[HGQ_AT_CMD_MAX];
+    const char *done;
+    const char *capture;
+    uint32_t timeout_ms;
+    HGQ_AT_Future *fut;
+    uint16_t raw_len;               /* 0 = 无原始数据 */
+    uint8_t raw[HGQ_AT_RAW_MAX];
+} AT_Item;
+
+typedef struct {
+    const char *prefix;
+    uint16_t plen;
+    HGQ_AT_URCHandler cb;
+    void *ctx;
+} AT_URC;
+
+static const char *const s_err_lines[] = { "ERROR", "FAIL", "busy", "+MQTTPUB:FAIL" };
+
+static QueueHandle_t s_q = NULL;
+static TaskHandle_t  s_task = NULL;
+static AT_URC        s_urc[HGQ_AT_URC_MAX];
+static uint8_t       s_urc_n = 0;
+static HGQ_AT_Stats  s_stats = {0};
+
+/* 当前执行中的命令 (仅引擎任务访问) */
+static AT_Item    s_cur;
+static uint8_t    s_cur_active = 0;
+static TickType_t s_cur_deadline;
+
+static char     s_line[HGQ_AT_LINE_MAX];
+static uint16_t s_line_len = 0;
+
+/*
+ * +MQTTSUBRECV:<LinkID>,"<topic>",<len>,<data>\r\n 分帧
+ * 头部照常进行缓冲，解析出 len 后负载不再进入行缓冲，直接从读出的数据块按片段交给回调，
+ * 负载可以超过行缓冲长度，也可以包含 \r\n
+ */
+#define SUB_PREFIX      "+MQTTSUBRECV:"
+#define SUB_PREFIX_LEN  (sizeof(SUB_PREFIX) - 1)
+
+typedef enum {
+    FR_LINE = 0,    /* 普通行 */
+    FR_HDR,         /* 已匹配前缀，收集头部直到第 3 个引号外的逗号 */
+    FR_DATA,        /* 负载，按长度透传 */
+    FR_TAIL         /* 负载后应紧跟 \r\n */
+} AT_FrameState;
+
+static AT_FrameState s_fr = FR_LINE;
+static uint8_t    s_fr_commas, s_fr_quote;
+static uint32_t   s_fr_left;
+static TickType_t s_fr_tick;            /* 最近一次收到帧数据的时刻 */
+static const HGQ_AT_SubHandler *s_sub = NULL;
+static void      *s_sub_ctx = NULL;
+
+#define MS_TO_TICKS(ms)  ((ms) == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(ms))
+
+static uint8_t StartsWith(const char *line, const char *prefix)
+{
+    return strncmp(line, prefix, strlen(prefix)) == 0;
+}
+
+static void AT_Finish(HGQ_AT_Result r)
+{
+    HGQ_AT_Future *fut = s_cur.fut;
+    s_cur_active = 0;
+    if(r == HGQ_AT_OK) s_stats.cmd_ok++;
+    else if(r == HGQ_AT_TIMEOUT) s_stats.cmd_timeout++;
+    else s_stats.cmd_error++;
+    if(fut) {
+        TaskHandle_t waiter = fut->waiter;  /* 写 result 后 future 可能立即失效 */
+        fut->result = r;
+        if(waiter) xTaskNotifyGiveIndexed(waiter, HGQ_AT_NOTIFY_INDEX);
+    }
+}
+
+static void AT_Start(void)
+{
+    s_cur_active = 1;
+    s_cur_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(s_cur.timeout_ms);
+    HGQ_USART2_Write((const uint8_t *)s_cur.cmd, (uint16_t)strlen(s_cur.cmd), 100);
+}
+
+/* 一行完整数据：先查 URC 表，再与当前命令匹配 */
+static void AT_Line(char *line, uint16_t len)
+{
+    uint8_t i;
+    if(len == 0) return;
+
+    for(i = 0; i < s_urc_n; i++) {
+        if(len >= s_urc[i].plen && memcmp(line, s_urc[i].prefix, s_urc[i].plen) == 0) {
+            s_stats.urc++;
+            s_urc[i].cb(line, len, s_urc[i].ctx);
+            return;
+        }
+    }
+    if(!s_cur_active) return;
+
+    if(s_cur.capture && s_cur.fut && s_cur.fut->resp[0] == 0 && StartsWith(line, s_cur.capture)) {
+        strncpy(s_cur.fut->resp, line, HGQ_AT_RESP_MAX - 1);
+        s_cur.fut->resp[HGQ_AT_RESP_MAX - 1] = 0;
+    }
+    if(StartsWith(line, s_cur.done)) { AT_Finish(HGQ_AT_OK); return; }
+    for(i = 0; i < sizeof(s_err_lines) / sizeof(s_err_lines[0]); i++) {
+        if(StartsWith(line, s_err_lines[i])) {
+            /* 没捕获到内容时记下是哪一行结束的，调用者据此区分 ERROR / busy / FAIL */
+            if(s_cur.fut && s_cur.fut->resp[0] == 0) {
+                strncpy(s_cur.fut->resp, line, HGQ_AT_RESP_MAX - 1);
+                s_cur.fut->resp[HGQ_AT_RESP_MAX - 1] = 0;
+            }
+            AT_Finish(HGQ_AT_ERROR);
+            return;
+        }
+    }
+}
+
+static void Frame_Abort(void)
+{
+    if(s_fr == FR_DATA || s_fr == FR_TAIL) {
+        if(s_sub) s_sub->end(0, s_sub_ctx);
+    }
+    s_fr = FR_LINE;
+    s_line_len = 0;
+}
+
+/* 头部收齐：s_line = +MQTTSUBRECV:0,"topic",len, */
+static void Frame_Header(void)
+{
+    char *t0, *t1, *p;
+    uint32_t len = 0;
+
+    s_line[s_line_len] = 0;
+    t0 = strchr(s_line, '"');
+    t1 = t0 ? strchr(t0 + 1, '"') : NULL;
+    p = t1 ? t1 + 1 : NULL;
+    if(!p || *p != ',' || p[1] < '0' || p[1] > '9') {
+        s_stats.frame_hdr_error++;
+        s_fr = FR_LINE; s_line_len = 0;
+        return;
+    }
+    for(p++; *p >= '0' && *p <= '9'; p++) len = len * 10 + (uint32_t)(*p - '0');
+    if(*p != ',' || len == 0 || len > HGQ_AT_FRAME_MAX) {
+        s_stats.frame_hdr_error++;
+        s_fr = FR_LINE; s_line_len = 0;
+        return;
+    }
+    *t1 = 0;
+    s_stats.frames++;
+    s_stats.urc++;
+    if(s_sub) s_sub->begin(t0 + 1, (uint16_t)len, s_sub_ctx);
+    s_fr_left = len;
+    s_fr = FR_DATA;
+    s_line_len = 0;
+}
+
+static void AT_Feed(const uint8_t *buf, uint16_t n)
+{
+    uint16_t i = 0;
+    if(s_fr != FR_LINE) s_fr_tick = xTaskGetTickCount();
+
+    while(i < n) {
+        char ch = (char)buf[i];
+
+        if(s_fr == FR_DATA) {
+            /* 负载片段直接指向读出的数据块，不经行缓冲 */
+            uint16_t span = (uint16_t)((n - i) < s_fr_left ? (n - i) : s_fr_left);
+            if(s_sub) s_sub->data((const char *)&buf[i], span, s_sub_ctx);
+            s_stats.frame_bytes += span;
+            s_fr_left -= span;
+            i += span;
+            if(s_fr_left == 0) s_fr = FR_TAIL;
+            continue;
+        }
+        if(s_fr == FR_TAIL) {
+            if(ch == '\r') { i++; continue; }
+            if(ch == '\n') {
+                if(s_sub) s_sub->end(1, s_sub_ctx);
+                s_fr = FR_LINE; s_line_len = 0;
+                i++;
+                continue;
+            }
+            /* 长度与实际负载不符：本帧作废，当前字符按新行处理 */
+            s_stats.frame_len_error++;
+            Frame_Abort();
+        }
+
+        i++;
+        /* '>' 提示符不带换行，行首出现且当前命令有待发原始数据时立即发送 */
+        if(ch == '>' && s_line_len == 0 && s_cur_active && s_cur.raw_len) {
+            HGQ_USART2_Write(s_cur.raw, s_cur.raw_len, 100);
+            s_cur.raw_len = 0;
+            continue;
+        }
+        if(ch == '\n') {
+            if(s_fr == FR_HDR) s_stats.frame_hdr_error++;   /* 头部没收齐就换行 */
+            s_fr = FR_LINE;
+            if(s_line_len && s_line[s_line_len - 1] == '\r') s_line_len--;
+            s_line[s_line_len] = 0;
+            AT_Line(s_line, s_line_len);
+            s_line_len = 0;
+            continue;
+        }
+        if(s_line_len < HGQ_AT_LINE_MAX - 1) {
+            s_line[s_line_len++] = ch;
+        } else {
+            if(s_fr == FR_HDR) { s_stats.frame_hdr_error++; s_fr = FR_LINE; }
+            s_stats.line_overflow++;
+            continue;
+        }
+
+        if(s_fr == FR_LINE) {
+            if(s_line_len == SUB_PREFIX_LEN && memcmp(s_line, SUB_PREFIX, SUB_PREFIX_LEN) == 0) {
+                s_fr = FR_HDR; s_fr_commas = 0; s_fr_quote = 0;
+                s_fr_tick = xTaskGetTickCount();
+            }
+        } else if(s_fr == FR_HDR) {
+            if(ch == '"') s_fr_quote ^= 1;
+            else if(ch == ',' && !s_fr_quote && ++s_fr_commas == 3) Frame_Header();
+        }
+    }
+}
+
+static void AT_Task(void *pvParameters)
+{
+    static uint8_t rx[64];
+    uint16_t n;
+
+    for(;;) {
+        TickType_t wait = portMAX_DELAY;
+
+        while((n = HGQ_USART2_Read(rx, sizeof(rx), 0)) > 0) AT_Feed(rx, n);
+
+        if(s_cur_active && (int32_t)(xTaskGetTickCount() - s_cur_deadline) >= 0) AT_Finish(HGQ_AT_TIMEOUT);
+        if(s_fr != FR_LINE && xTaskGetTickCount() - s_fr_tick >= pdMS_TO_TICKS(HGQ_AT_FRAME_TIMEOUT_MS)) {
+            s_stats.frame_timeout++;    /* 帧中途断流 (模块复位等) */
+            Frame_Abort();
+        }
+        if(!s_cur_active && xQueueReceive(s_q, &s_cur, 0) == pdTRUE) AT_Start();
+
+        if(s_cur_active) {
+            int32_t left = (int32_t)(s_cur_deadline - xTaskGetTickCount());
+            wait = left > 0 ? (TickType_t)left : 0;
+        }
+        if(s_fr != FR_LINE && wait > pdMS_TO_TICKS(HGQ_AT_FRAME_TIMEOUT_MS)) wait = pdMS_TO_TICKS(HGQ_AT_FRAME_TIMEOUT_MS);
+        /* 串口收到数据或有新命令入队都会通知本任务 */
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+void HGQ_AT_Init(void)
+{
+    if(s_task) return;
+    s_q = xQueueCreate(HGQ_AT_QUEUE_LEN, sizeof(AT_Item));
+    xTaskCreate(AT_Task, "AT", HGQ_AT_STK_SIZE, NULL, HGQ_AT_TASK_PRIO, &s_task);
+    HGQ_USART2_SetRxNotify(s_task);
+}
+
+static uint8_t AT_Enqueue(AT_Item *p, const char *cmd, const char *done, const char *capture,
+                          uint32_t timeout_ms, HGQ_AT_Future *fut)
+{
+    strncpy(p->cmd, cmd, HGQ_AT_CMD_MAX - 1);
+    p->cmd[HGQ_AT_CMD_MAX - 1] = 0;
+    p->done = done ? done : "OK";
+    p->capture = capture;
+    p->timeout_ms = timeout_ms;
+    p->fut = fut;
+    if(fut) {
+        fut->result = HGQ_AT_PENDING;
+        fut->resp[0] = 0;
+        fut->waiter = xTaskGetCurrentTaskHandle();
+    }
+
+    if(xQueueSend(s_q, p, pdMS_TO_TICKS(HGQ_AT_SUBMIT_WAIT_MS)) != pdTRUE) {
+        s_stats.cmd_dropped++;
+        if(fut) fut->result = HGQ_AT_DROPPED;
+        return 0;
+    }
+    xTaskNotifyGive(s_task);
+    return 1;
+}
+
+uint8_t HGQ_AT_Submit(const char *cmd, const char *done, const char *capture,
+                      uint32_t timeout_ms, HGQ_AT_Future *fut)
+{
+    AT_Item item;
+    item.raw_len = 0;
+    return AT_Enqueue(&item, cmd, done, capture, timeout_ms, fut);
+}
+
+uint8_t HGQ_AT_SubmitRaw(const char *cmd, const uint8_t *raw, uint16_t raw_len, const char *done,
+                         uint32_t timeout_ms, HGQ_AT_Future *fut)
+{
+    AT_Item item;
+    if(raw_len == 0 || raw_len > HGQ_AT_RAW_MAX) {
+        if(fut) fut->result = HGQ_AT_ERROR;
+        return 0;
+    }
+    memcpy(item.raw, raw, raw_len);
+    item.raw_len = raw_len;
+    return AT_Enqueue(&item, cmd, done, NULL, timeout_ms, fut);
+}
+
+HGQ_AT_Result HGQ_AT_Wait(HGQ_AT_Future *fut, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount(), wait = MS_TO_TICKS(timeout_ms);
+    while(fut->result == HGQ_AT_PENDING) {
+        TickType_t used = xTaskGetTickCount() - start;
+        if(wait != portMAX_DELAY && used >= wait) break;
+        /* 通知可能来自更早的 future，循环检查结果 */
+        ulTaskNotifyTakeIndexed(HGQ_AT_NOTIFY_INDEX, pdTRUE, wait == portMAX_DELAY ? portMAX_DELAY : wait - used);
+    }
+    return fut->result;
+}
+
+/* 同步执行：引擎保证每条命令都会以 OK/ERROR/TIMEOUT 结束，所以无限等待是安全的 */
+HGQ_AT_Result HGQ_AT_Exec(const char *cmd, const char *done, const char *capture,
+                          uint32_t timeout_ms, char *resp, uint16_t resp_sz)
+{
+    HGQ_AT_Future fut;
+    HGQ_AT_Result r;
+
+    if(!HGQ_AT_Submit(cmd, done, capture, timeout_ms, &fut)) return HGQ_AT_DROPPED;
+    r = HGQ_AT_Wait(&fut, portMAX_DELAY);
+    if(resp && resp_sz) {
+        strncpy(resp, fut.resp, resp_sz - 1);
+        resp[resp_sz - 1] = 0;
+    }
+    return r;
+}
+
+/* 启动前注册；同一前缀只登记一次 */
+uint8_t HGQ_AT_RegisterURC(const char *prefix, HGQ_AT_URCHandler cb, void *ctx)
+{
+    uint8_t ok = 0;
+    taskENTER_CRITICAL();
+    if(s_urc_n < HGQ_AT_URC_MAX) {
+        s_urc[s_urc_n].prefix = prefix;
+        s_urc[s_urc_n].plen = (uint16_t)strlen(prefix);
+        s_urc[s_urc_n].cb = cb;
+        s_urc[s_urc_n].ctx = ctx;
+        s_urc_n++;
+        ok = 1;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+/* 启动前设置；h 需长期有效，回调在引擎任务中执行 */
+void HGQ_AT_SetSubHandler(const HGQ_AT_SubHandler *h, void *ctx)
+{
+    taskENTER_CRITICAL();
+    s_sub = h;
+    s_sub_ctx = ctx;
+    taskEXIT_CRITICAL();
+}
+
+void HGQ_AT_GetStats(HGQ_AT_Stats *st)
+{
+    taskENTER_CRITICAL();
+    *st = s_stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,86 @@
+#ifndef __HGQ_AT_H
+#define __HGQ_AT_H
+
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * AT 命令引擎：单一属主任务独占 USART2 收发
+ *   - 命令队列：调用者只入队，不再直接读写串口，多条命令可连续排队
+ *   - 每条命令带结束匹配串 / 捕获前缀 / 超时
+ *   - URC (主动上报) 按前缀分发到回调表，任何时刻到达都不会被吞掉
+ *   - 结果通过 future + 任务通知 (索引 HGQ_AT_NOTIFY_INDEX) 返回
+ */
+#define HGQ_AT_TASK_PRIO        4
+#define HGQ_AT_STK_SIZE         512
+#define HGQ_AT_QUEUE_LEN        8       /* 命令队列深度 */
+#define HGQ_AT_CMD_MAX          256     /* 单条命令最大长度 (含 \r\n) */
+#define HGQ_AT_RAW_MAX          64      /* '>' 提示符后发送的原始数据最大长度 */
+#define HGQ_AT_LINE_MAX         512     /* 接收行缓冲 */
+#define HGQ_AT_RESP_MAX         64      /* 捕获响应行长度 */
+#define HGQ_AT_URC_MAX          8       /* URC 回调表容量 */
+#define HGQ_AT_SUBMIT_WAIT_MS   50      /* 队列满时入队最多等待 */
+#define HGQ_AT_NOTIFY_INDEX     1       /* future 使用的任务通知索引 */
+#define HGQ_AT_FRAME_MAX        4096    /* +MQTTSUBRECV 负载长度上限，超出视为头部错误 */
+#define HGQ_AT_FRAME_TIMEOUT_MS 500     /* 帧内数据中断超过此时间则丢弃该帧 */
+
+typedef enum {
+    HGQ_AT_PENDING = 0,
+    HGQ_AT_OK,
+    HGQ_AT_ERROR,
+    HGQ_AT_TIMEOUT,
+    HGQ_AT_DROPPED      /* 队列满，命令未入队 */
+} HGQ_AT_Result;
+
+/* 命令结果：必须在命令完成前保持有效 (同步接口放栈上即可) */
+typedef struct {
+    volatile HGQ_AT_Result result;
+    char resp[HGQ_AT_RESP_MAX];     /* 以 capture 前缀开头的第一行；未捕获且出错时为结束它的错误行 */
+    TaskHandle_t waiter;            /* 完成时通知的任务 */
+} HGQ_AT_Future;
+
+/* URC 回调：在引擎任务中执行，line 不含 \r\n，回调内不要再同步等待 AT 命令 */
+typedef void (*HGQ_AT_URCHandler)(const char *line, uint16_t len, void *ctx);
+
+/*
+ * +MQTTSUBRECV 负载按声明长度分片交付：begin -> data (可多次，片段指向接收块，仅回调内有效) -> end
+ * end(ok=0) 表示帧不完整或长度不符，已交付的片段应丢弃
+ */
+typedef struct {
+    void (*begin)(const char *topic, uint16_t len, void *ctx);
+    void (*data)(const char *p, uint16_t n, void *ctx);
+    void (*end)(uint8_t ok, void *ctx);
+} HGQ_AT_SubHandler;
+
+typedef struct {
+    uint32_t cmd_ok;
+    uint32_t cmd_error;
+    uint32_t cmd_timeout;
+    uint32_t cmd_dropped;
+    uint32_t urc;
+    uint32_t line_overflow;     /* 超长行被截断次数 */
+    uint32_t frames;            /* +MQTTSUBRECV 帧数 */
+    uint32_t frame_bytes;       /* 负载字节数 */
+    uint32_t frame_hdr_error;   /* 头部格式错误 / 长度非法 */
+    uint32_t frame_len_error;   /* 负载后没有紧跟 \r\n (长度不符) */
+    uint32_t frame_timeout;     /* 帧内断流 */
+} HGQ_AT_Stats;
+
+void HGQ_AT_Init(void);
+
+/* done / capture 必须是常量字符串 (只保存指针)；done 为 NULL 时默认 "OK" */
+uint8_t HGQ_AT_Submit(const char *cmd, const char *done, const char *capture,
+                      uint32_t timeout_ms, HGQ_AT_Future *fut);
+/* 带原始数据的命令 (如 AT+MQTTPUBRAW)：收到 '>' 提示符后发送 raw */
+uint8_t HGQ_AT_SubmitRaw(const char *cmd, const uint8_t *raw, uint16_t raw_len, const char *done,
+                         uint32_t timeout_ms, HGQ_AT_Future *fut);
+HGQ_AT_Result HGQ_AT_Wait(HGQ_AT_Future *fut, uint32_t timeout_ms);
+HGQ_AT_Result HGQ_AT_Exec(const char *cmd, const char *done, const char *capture,
+                          uint32_t timeout_ms, char *resp, uint16_t resp_sz);
+
+uint8_t HGQ_AT_RegisterURC(const char *prefix, HGQ_AT_URCHandler cb, void *ctx);
+void HGQ_AT_SetSubHandler(const HGQ_AT_SubHandler *h, void *ctx);
+void HGQ_AT_GetStats(HGQ_AT_Stats *st);
+
+#endif
@@ -1,71 +1,99 @@
 #include "hgq_esp8266.h"
+#include "hgq_at.h"
 #include "hgq_usart.h"
-#include "delay.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h> 
 
-static char s_init_buf[512]; 
-
-static int Wait_Reply(const char *reply, uint32_t timeout_ms)
-{
-    uint32_t time = 0;
-    uint8_t ch;
-    uint16_t idx = 0;
-    
-    memset(s_init_buf, 0, sizeof(s_init_buf));
-    while(time < timeout_ms)
-    {
-        while(HGQ_USART2_IT_GetChar(&ch))
-        {
-            if(idx < sizeof(s_init_buf)-1) s_init_buf[idx++] = ch;
-        }
-        if(strstr(s_init_buf, reply)) return 1; 
-        delay_ms(1);
-        time++;
-    }
-    return 0; 
-}
+/* 所有命令经 AT 引擎排队执行，本文件不再直接读写串口 */
 
 ESP8266_Status HGQ_ESP8266_SendCmd(char *cmd, char *reply, uint32_t timeout)
 {
-    HGQ_USART2_IT_ClearRxBuffer(); 
-    HGQ_USART2_SendString(cmd);    
-    if(Wait_Reply(reply, timeout)) return ESP8266_OK;
+    HGQ_AT_Result r = HGQ_AT_Exec(cmd, reply, NULL, timeout, NULL, 0);
+    if(r == HGQ_AT_OK) return ESP8266_OK;
+    if(r == HGQ_AT_TIMEOUT) return ESP8266_TIMEOUT;
     return ESP8266_ERROR;
 }
 
-static void EscapeString(const char *in, char *out, int out_sz)
+/* 拼接 AT+MQTTPUB 命令，消息内的 \ " , 直接转义写入命令缓冲 (ESP-AT 字符串参数里逗号也要转义) */
+static void MQTTPUB_Build(char *cmd, int cmd_sz, const char *topic, const char *message, uint8_t qos)
 {
-    int j = 0;
-    for (int i = 0; in[i] && j < out_sz - 2; i++) {
-        if (in[i] == '\\' || in[i] == '"') out[j++] = '\\';
-        out[j++] = in[i];
+    int j = snprintf(cmd, cmd_sz, "AT+MQTTPUB=0,\"%s\",\"", topic);
+    for (int i = 0; message[i] && j < cmd_sz - 12; i++) {
+        if (message[i] == '\\' || message[i] == '"' || message[i] == ',') cmd[j++] = '\\';
+        cmd[j++] = message[i];
     }
-    out[j] = '\0';
+    snprintf(cmd + j, cmd_sz - j, "\",%d,0\r\n", qos);
 }
 
-/* 阻塞式发送 (用于初始化阶段) */
+/* 阻塞式发送 (等待模块应答) */
 ESP8266_Status HGQ_ESP8266_MQTTPUB(char *topic, char *message, uint8_t qos)
 {
-    char esc[256];
-    char cmd[512];
-    EscapeString(message, esc, sizeof(esc));
-    snprintf(cmd, sizeof(cmd), "AT+MQTTPUB=0,\"%s\",\"%s\",%d,0\r\n", topic, esc, qos);
+    char cmd[HGQ_AT_CMD_MAX];
+    MQTTPUB_Build(cmd, sizeof(cmd), topic, message, qos);
     return HGQ_ESP8266_SendCmd(cmd, "OK", 500); 
 }
 
-/* 非阻塞快速发送 (用于运行阶段，防止吃掉接收数据) */
+/* 非阻塞快速发送：只入队，不等待应答，应答由引擎消费，不会吃掉接收数据 */
 void HGQ_ESP8266_MQTTPUB_Fast(char *topic, char *message, uint8_t qos)
 {
-    char esc[256];
-    char cmd[512];
-    EscapeString(message, esc, sizeof(esc));
-    snprintf(cmd, sizeof(cmd), "AT+MQTTPUB=0,\"%s\",\"%s\",%d,0\r\n", topic, esc, qos);
-    HGQ_USART2_SendString(cmd); // 只发送，不等待回复
+    char cmd[HGQ_AT_CMD_MAX];
+    MQTTPUB_Build(cmd, sizeof(cmd), topic, message, qos);
+    HGQ_AT_Submit(cmd, "OK", NULL, 500, NULL);
+}
+
+/* 入队并通过 future 返回结果 (补发等需要确认发出的场合)，返回 0 表示未能入队 */
+uint8_t HGQ_ESP8266_MQTTPUB_Async(char *topic, char *message, uint8_t qos, HGQ_AT_Future *fut)
+{
+    char cmd[HGQ_AT_CMD_MAX];
+    MQTTPUB_Build(cmd, sizeof(cmd), topic, message, qos);
+    return HGQ_AT_Submit(cmd, "OK", NULL, 1000, fut);
+}
+
+/*
+ * 原始二进制发布：AT+MQTTPUBRAW=0,"topic",len,qos,0 -> OK -> '>' -> 数据 -> +MQTTPUB:OK
+ * 不等待应答；上一条的结果在下一次调用时检查，命令本身直接回 ERROR (固件没有这条指令) 才认为
+ * 不支持并返回 0，调用者改用文本；busy / +MQTTPUB:FAIL 只是这一条没发出去，不影响后续
+ * s_raw_fut 只有一份，只允许 net_task 调用
+ */
+static HGQ_AT_Future s_raw_fut;
+static uint8_t s_raw_inflight = 0;
+static uint8_t s_raw_unsupported = 0;
+
+uint8_t HGQ_ESP8266_MQTTPUBRAW_Fast(char *topic, const uint8_t *data, uint16_t len, uint8_t qos)
+{
+    char cmd[96];
+
+    if(s_raw_inflight && s_raw_fut.result != HGQ_AT_PENDING) {
+        s_raw_inflight = 0;
+        if(s_raw_fut.result == HGQ_AT_ERROR && strcmp(s_raw_fut.resp, "ERROR") == 0) {
+            s_raw_unsupported = 1;
+            printf("[MQTT] 模块不支持 MQTTPUBRAW，改用文本格式\r\n");
+        }
+    }
+    if(s_raw_unsupported) return 0;
+
+    snprintf(cmd, sizeof(cmd), "AT+MQTTPUBRAW=0,\"%s\",%u,%d,0\r\n", topic, len, qos);
+    if(!s_raw_inflight) {
+        if(HGQ_AT_SubmitRaw(cmd, data, len, "+MQTTPUB:OK", 1000, &s_raw_fut)) s_raw_inflight = 1;
+    } else {
+        HGQ_AT_SubmitRaw(cmd, data, len, "+MQTTPUB:OK", 1000, NULL);
+    }
+    return 1;
+}
+
+/* 重连或重新协商格式时调用：未连上时 MQTTPUBRAW 同样回 ERROR，不能一直记着 */
+void HGQ_ESP8266_MQTTPUBRAW_Reset(void)
+{
+    s_raw_unsupported = 0;
 }
 
-ESP8266_Status HGQ_ESP8266_Init(void) { return ESP8266_OK; } 
+/* 启动 AT 引擎任务 (需在创建使用网络的任务之前调用) */
+ESP8266_Status HGQ_ESP8266_Init(void)
+{
+    HGQ_AT_Init();
+    return ESP8266_OK;
+} 
 
 ESP8266_Status HGQ_ESP8266_JoinAP(char *ssid, char *pwd)
 {
@@ -95,55 +123,220 @@ void HGQ_ESP8266_EnableNTP(void)
     HGQ_ESP8266_SendCmd("AT+CIPSNTPCFG=1,8,\"ntp1.aliyun.com\"\r\n", "OK", 500);
 }
 
+/* +CIPSNTPTIME:Mon Dec 29 12:34:56 2025 */
 uint8_t HGQ_ESP8266_GetNTPTime(uint8_t *h, uint8_t *m, uint8_t *s)
 {
-    uint32_t time = 0;
-    uint8_t ch;
-    uint16_t idx = 0;
-    char *p_start, *p_time;
-    
-    HGQ_USART2_IT_ClearRxBuffer();
-    HGQ_USART2_SendString("AT+CIPSNTPTIME?\r\n");
-    
-    memset(s_init_buf, 0, sizeof(s_init_buf));
-    while(time < 1000) 
-    {
-        while(HGQ_USART2_IT_GetChar(&ch))
-        {
-            if(idx < sizeof(s_init_buf)-1) s_init_buf[idx++] = ch;
-        }
-        if(strstr(s_init_buf, "+CIPSNTPTIME:")) break;
-        delay_ms(1);
-        time++;
-    }
-    
-    p_start = strstr(s_init_buf, "+CIPSNTPTIME:");
-    if(p_start)
+    char resp[HGQ_AT_RESP_MAX];
+    char *p_time;
+
+    if(HGQ_AT_Exec("AT+CIPSNTPTIME?\r\n", "OK", "+CIPSNTPTIME:", 1000, resp, sizeof(resp)) != HGQ_AT_OK) return 0;
+    if(resp[0] == 0) return 0;
+
+    p_time = strchr(resp + 13, ':');
+    while(p_time)
     {
-        p_start += 13; 
-        p_time = strchr(p_start, ':'); 
-        while(p_time)
+        if(p_time - resp >= 2 && *(p_time-1) >= '0' && *(p_time-1) <= '9')
         {
-            if(p_time > s_init_buf && *(p_time-1) >= '0' && *(p_time-1) <= '9')
-            {
-                *h = (uint8_t)atoi(p_time - 2); 
-                *m = (uint8_t)atoi(p_time + 1);
-                char *p_sec = strchr(p_time + 1, ':');
-                if(p_sec) {
-                    *s = (uint8_t)atoi(p_sec + 1);
-                    return 1; 
-                }
+            *h = (uint8_t)atoi(p_time - 2); 
+            *m = (uint8_t)atoi(p_time + 1);
+            char *p_sec = strchr(p_time + 1, ':');
+            if(p_sec) {
+                *s = (uint8_t)atoi(p_sec + 1);
+                return 1; 
             }
-            p_time = strchr(p_time + 1, ':');
         }
+        p_time = strchr(p_time + 1, ':');
     }
     return 0; 
 }
 
+/* 已连接时返回 +CWJAP:"ssid",...，未连接返回 No AP */
 uint8_t HGQ_ESP8266_CheckStatus(void)
 {
-    if(HGQ_ESP8266_SendCmd("AT+CWJAP?\r\n", "+CWJAP:", 3000) == ESP8266_OK) {
+    char resp[HGQ_AT_RESP_MAX];
+    if(HGQ_AT_Exec("AT+CWJAP?\r\n", "OK", "+CWJAP:", 3000, resp, sizeof(resp)) == HGQ_AT_OK && resp[0]) {
         return 1;
     }
     return 0;
 }
+
+/* ================== 非阻塞联网状态机 ================== */
+/*
+ * 每个状态只提交一条异步命令并立即返回，由 HGQ_ESP8266_Conn_Step 轮询推进：
+ *   RESET(等 ready) -> CONFIG -> JOIN_AP -> MQTT -> SUBSCRIBE -> ONLINE
+ * 任一步失败进入 BACKOFF，退避时间按 1s,2s,4s...60s 翻倍并加随机抖动，
+ * 抖动种子取芯片 96bit UID，断电恢复后同一批设备不会同时冲击 AP 和 Broker。
+ */
+#define CONN_BACKOFF_MIN_MS   1000
+#define CONN_BACKOFF_MAX_MS   60000
+#define CONN_READY_WAIT_MS    5000      /* 等 ready 超时后照常继续 (部分固件不输出) */
+#define CONN_CHECK_MS         10000     /* 在线巡检周期 */
+#define CHIP_UID_BASE         0x1FFF7A10
+
+static const ESP8266_ConnCfg *s_cfg = NULL;
+static ESP8266_ConnState s_state = ESP_CONN_IDLE;
+static HGQ_AT_Future s_fut;             /* 状态机同一时刻只有一条命令在途，静态保存 */
+static uint8_t  s_busy = 0;             /* s_fut 在途 */
+static uint8_t  s_step = 0;             /* 状态内子步骤 */
+static uint8_t  s_attempt = 0;          /* 连续失败次数 */
+static uint8_t  s_chk_fail = 0;
+static volatile uint8_t s_ready = 0;
+static volatile uint8_t s_lost = 0;
+static TickType_t s_deadline = 0;
+static uint32_t s_rand = 0;
+
+static uint32_t Conn_Rand(void)
+{
+    /* xorshift32 */
+    s_rand ^= s_rand << 13; s_rand ^= s_rand >> 17; s_rand ^= s_rand << 5;
+    return s_rand;
+}
+
+static uint8_t Conn_Due(void) { return (int32_t)(xTaskGetTickCount() - s_deadline) >= 0; }
+
+static void Conn_Enter(ESP8266_ConnState st, uint32_t delay_ms)
+{
+    s_state = st; s_step = 0;
+    s_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+}
+
+/* 失败：指数退避 + 抖动，实际等待落在 [d/2, d] */
+static void Conn_Fail(const char *why)
+{
+    uint32_t d = CONN_BACKOFF_MIN_MS << (s_attempt < 6 ? s_attempt : 6);
+    if(d > CONN_BACKOFF_MAX_MS) d = CONN_BACKOFF_MAX_MS;
+    d = d / 2 + Conn_Rand() % (d / 2 + 1);
+    if(s_attempt < 255) s_attempt++;
+    printf("[网络] %s 失败，%lu ms 后重试 (第%d次)\r\n", why, (unsigned long)d, s_attempt);
+    Conn_Enter(ESP_CONN_BACKOFF, d);
+}
+
+/* 提交当前步骤的命令；返回 0 表示命令仍在途，1 表示结果已出 */
+static uint8_t Conn_Cmd(const char *cmd, const char *capture, uint32_t timeout_ms)
+{
+    if(!s_busy) {
+        if(!HGQ_AT_Submit(cmd, "OK", capture, timeout_ms, &s_fut)) return 0; /* 队列满，下次再试 */
+        s_busy = 1;
+        return 0;
+    }
+    if(s_fut.result == HGQ_AT_PENDING) return 0;
+    s_busy = 0;
+    return 1;
+}
+
+static void URC_Ready(const char *line, uint16_t len, void *ctx) { (void)line; (void)len; (void)ctx; s_ready = 1; }
+static void URC_Lost(const char *line, uint16_t len, void *ctx)  { (void)line; (void)len; (void)ctx; s_lost = 1; }
+
+void HGQ_ESP8266_Conn_Init(const ESP8266_ConnCfg *cfg)
+{
+    const uint32_t *uid = (const uint32_t *)CHIP_UID_BASE;
+    s_cfg = cfg;
+    s_rand = uid[0] ^ uid[1] ^ uid[2] ^ xTaskGetTickCount();
+    if(s_rand == 0) s_rand = 0x1234567;
+    HGQ_AT_RegisterURC("ready", URC_Ready, NULL);
+    HGQ_AT_RegisterURC("WIFI DISCONNECT", URC_Lost, NULL);
+    HGQ_AT_RegisterURC("+MQTTDISCONNECTED", URC_Lost, NULL);
+    /* 首次联网也加一段随机延时，整批上电时错开 */
+    Conn_Enter(ESP_CONN_BACKOFF, Conn_Rand() % 2000);
+}
+
+ESP8266_ConnState HGQ_ESP8266_Conn_GetState(void) { return s_state; }
+
+/* 映射为界面使用的 0:离线(退避中) 1:连接中 2:在线 */
+int HGQ_ESP8266_Conn_UIState(void)
+{
+    if(s_state == ESP_CONN_ONLINE) return 2;
+    if(s_state == ESP_CONN_BACKOFF || s_state == ESP_CONN_IDLE) return 0;
+    return 1;
+}
+
+ESP8266_ConnState HGQ_ESP8266_Conn_Step(void)
+{
+    char cmd[128];
+    if(s_cfg == NULL) return s_state;
+
+    if(s_lost && s_state == ESP_CONN_ONLINE) {
+        s_lost = 0;
+        s_attempt = 0;
+        Conn_Fail("链路");
+    }
+
+    switch(s_state) {
+    case ESP_CONN_IDLE:
+        break;
+
+    case ESP_CONN_BACKOFF:
+        if(s_busy && !Conn_Cmd(NULL, NULL, 0)) break; /* 等残留命令结束，保证 future 可复用 */
+        if(Conn_Due()) {
+            printf("[网络] 复位 ESP8266...\r\n");
+            s_ready = 0;
+            HGQ_AT_Submit("AT+RST\r\n", "OK", NULL, 1000, NULL);
+            Conn_Enter(ESP_CONN_RESET, CONN_READY_WAIT_MS);
+        }
+        break;
+
+    case ESP_CONN_RESET:
+        if(s_ready || Conn_Due()) {
+            if(!s_ready) printf("[网络] 未收到 ready，继续初始化\r\n");
+            Conn_Enter(ESP_CONN_CONFIG, 0);
+        }
+        break;
+
+    case ESP_CONN_CONFIG: {
+        static const char *const cfg_cmds[] = {
+            "ATE0\r\n", "AT+CWMODE=1\r\n", "AT+CWQAP\r\n", "AT+CIPMUX=0\r\n"
+        };
+        if(!Conn_Cmd(cfg_cmds[s_step], NULL, 500)) break;
+        if(++s_step >= sizeof(cfg_cmds) / sizeof(cfg_cmds[0])) {
+            printf("[网络] 正在连接 WiFi...\r\n");
+            Conn_Enter(ESP_CONN_JOIN_AP, 0);
+        }
+        break;
+    }
+
+    case ESP_CONN_JOIN_AP:
+        snprintf(cmd, sizeof(cmd), "AT+CWJAP=\"%s\",\"%s\"\r\n", s_cfg->ssid, s_cfg->pwd);
+        if(!Conn_Cmd(cmd, NULL, 20000)) break;
+        if(s_fut.result != HGQ_AT_OK) { Conn_Fail("WiFi 连接"); break; }
+        printf("[网络] WiFi 连接成功，正在连接 MQTT...\r\n");
+        Conn_Enter(ESP_CONN_MQTT, 0);
+        break;
+
+    case ESP_CONN_MQTT:
+        if(s_step == 0) {
+            snprintf(cmd, sizeof(cmd), "AT+MQTTUSERCFG=0,1,\"%s\",\"%s\",\"\",0,0,\"\"\r\n", s_cfg->user, s_cfg->pass);
+            if(!Conn_Cmd(cmd, NULL, 1000)) break;
+            s_step = 1;
+        } else {
+            snprintf(cmd, sizeof(cmd), "AT+MQTTCONN=0,\"%s\",%d,1\r\n", s_cfg->broker, s_cfg->port);
+            if(!Conn_Cmd(cmd, NULL, 5000)) break;
+            if(s_fut.result != HGQ_AT_OK) { Conn_Fail("MQTT 连接"); break; }
+            Conn_Enter(ESP_CONN_SUBSCRIBE, 0);
+        }
+        break;
+
+    case ESP_CONN_SUBSCRIBE:
+        if(s_step < s_cfg->topic_n) {
+            snprintf(cmd, sizeof(cmd), "AT+MQTTSUB=0,\"%s\",0\r\n", s_cfg->topics[s_step]);
+            if(!Conn_Cmd(cmd, NULL, 2000)) break;
+            if(s_fut.result != HGQ_AT_OK) { Conn_Fail("订阅"); break; }
+            s_step++;
+        } else {
+            if(!Conn_Cmd("AT+CIPSNTPCFG=1,8,\"ntp1.aliyun.com\"\r\n", NULL, 500)) break;
+            printf("[网络] 联网完成.\r\n");
+            s_attempt = 0; s_chk_fail = 0; s_lost = 0;
+            Conn_Enter(ESP_CONN_ONLINE, CONN_CHECK_MS);
+        }
+        break;
+
+    case ESP_CONN_ONLINE:
+        /* 周期巡检 AP 连接，连续两次失败判定断线 */
+        if(!s_busy && !Conn_Due()) break;
+        if(!Conn_Cmd("AT+CWJAP?\r\n", "+CWJAP:", 3000)) break;
+        if(s_fut.result == HGQ_AT_OK && s_fut.resp[0]) s_chk_fail = 0;
+        else if(++s_chk_fail >= 2) { s_attempt = 0; Conn_Fail("巡检"); break; }
+        s_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(s_chk_fail ? 200 : CONN_CHECK_MS);
+        break;
+    }
+    return s_state;
+}
@@ -2,6 +2,9 @@
 #define __HGQ_ESP8266_H
 
 #include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hgq_at.h"
 
 typedef enum {
     ESP8266_OK = 0,
@@ -9,7 +12,7 @@ typedef enum {
     ESP8266_TIMEOUT
 } ESP8266_Status;
 
-ESP8266_Status HGQ_ESP8266_Init(void);
+ESP8266_Status HGQ_ESP8266_Init(void);   /* 启动 AT 引擎 */
 ESP8266_Status HGQ_ESP8266_JoinAP(char *ssid, char *pwd);
 ESP8266_Status HGQ_ESP8266_ConnectMQTT(char *broker, int port, char *username, char *password);
 ESP8266_Status HGQ_ESP8266_MQTTSUB(char *topic, uint8_t qos);
@@ -18,7 +21,12 @@ ESP8266_Status HGQ_ESP8266_MQTTSUB(char *topic, uint8_t qos);
 ESP8266_Status HGQ_ESP8266_MQTTPUB(char *topic, char *message, uint8_t qos);
 /* 极速发布 (不等待) */
 void HGQ_ESP8266_MQTTPUB_Fast(char *topic, char *message, uint8_t qos);
-/* 底层指令发送 */
+/* 异步发布，结果写入 fut (需保持有效直到完成)，返回 0 = 未能入队 */
+uint8_t HGQ_ESP8266_MQTTPUB_Async(char *topic, char *message, uint8_t qos, HGQ_AT_Future *fut);
+/* 二进制发布 (AT+MQTTPUBRAW，不等待，仅 net_task 调用)，返回 0 表示模块不支持，应退回文本 */
+uint8_t HGQ_ESP8266_MQTTPUBRAW_Fast(char *topic, const uint8_t *data, uint16_t len, uint8_t qos);
+void HGQ_ESP8266_MQTTPUBRAW_Reset(void);        /* 清除“不支持”标记，重连/协商后重新尝试 */
+/* 底层指令发送 (经 AT 引擎排队，同步等待结果) */
 ESP8266_Status HGQ_ESP8266_SendCmd(char *cmd, char *reply, uint32_t timeout);
 
 /* ====== 新增：NTP 时间与状态检查 ====== */
@@ -26,4 +34,32 @@ void HGQ_ESP8266_EnableNTP(void);
 uint8_t HGQ_ESP8266_GetNTPTime(uint8_t *h, uint8_t *m, uint8_t *s);
 uint8_t HGQ_ESP8266_CheckStatus(void);
 
+/* ====== 非阻塞联网状态机 ====== */
+typedef enum {
+    ESP_CONN_IDLE = 0,
+    ESP_CONN_BACKOFF,       /* 退避等待 (含首次上电随机延时) */
+    ESP_CONN_RESET,         /* 已发 AT+RST，等待 ready */
+    ESP_CONN_CONFIG,        /* ATE0 / CWMODE / CWQAP / CIPMUX */
+    ESP_CONN_JOIN_AP,
+    ESP_CONN_MQTT,          /* MQTTUSERCFG + MQTTCONN */
+    ESP_CONN_SUBSCRIBE,     /* 订阅 + NTP 配置 */
+    ESP_CONN_ONLINE
+} ESP8266_ConnState;
+
+typedef struct {
+    const char *ssid;
+    const char *pwd;
+    const char *broker;
+    int port;
+    const char *user;
+    const char *pass;
+    const char *const *topics;  /* 需要订阅的主题 */
+    uint8_t topic_n;
+} ESP8266_ConnCfg;
+
+void HGQ_ESP8266_Conn_Init(const ESP8266_ConnCfg *cfg);    /* cfg 需长期有效 */
+ESP8266_ConnState HGQ_ESP8266_Conn_Step(void);               /* 周期调用，从不阻塞 */
+ESP8266_ConnState HGQ_ESP8266_Conn_GetState(void);
+int HGQ_ESP8266_Conn_UIState(void);                          /* 0:离线 1:连接中 2:在线 */
+
 #endif
@@ -0,0 +1,234 @@
+#include "hgq_filter.h"
+#include <string.h>
+
+/* ---------------- 滑动中位数 ---------------- */
+#define AT_HI   0x80
+
+/* a 是否应排在 b 上面：lo 是大顶堆，hi 是小顶堆 */
+static int Heap_Above(const HGQ_Median *m, uint8_t hi, uint8_t a, uint8_t b)
+{
+    return hi ? m->v[a] < m->v[b] : m->v[a] > m->v[b];
+}
+
+static void Heap_Set(HGQ_Median *m, uint8_t hi, uint8_t i, uint8_t s)
+{
+    if(hi) { m->hi[i] = s; m->at[s] = i | AT_HI; }
+    else   { m->lo[i] = s; m->at[s] = i; }
+}
+
+static void Heap_Up(HGQ_Median *m, uint8_t hi, uint8_t i)
+{
+    uint8_t *h = hi ? m->hi : m->lo;
+    uint8_t s = h[i], p;
+    while(i) {
+        p = (uint8_t)((i - 1) / 2);
+        if(!Heap_Above(m, hi, s, h[p])) break;
+        Heap_Set(m, hi, i, h[p]);
+        i = p;
+    }
+    Heap_Set(m, hi, i, s);
+}
+
+static void Heap_Down(HGQ_Median *m, uint8_t hi, uint8_t i)
+{
+    uint8_t *h = hi ? m->hi : m->lo;
+    uint8_t n = hi ? m->nhi : m->nlo;
+    uint8_t s = h[i], c;
+    for(;;) {
+        c = (uint8_t)(2 * i + 1);
+        if(c >= n) break;
+        if(c + 1 < n && Heap_Above(m, hi, h[c + 1], h[c])) c++;
+        if(!Heap_Above(m, hi, h[c], s)) break;
+        Heap_Set(m, hi, i, h[c]);
+        i = c;
+    }
+    Heap_Set(m, hi, i, s);
+}
+
+static void Heap_Push(HGQ_Median *m, uint8_t hi, uint8_t s)
+{
+    uint8_t i = hi ? m->nhi++ : m->nlo++;
+    Heap_Set(m, hi, i, s);
+    Heap_Up(m, hi, i);
+}
+
+static uint8_t Heap_Pop(HGQ_Median *m, uint8_t hi)
+{
+    uint8_t *h = hi ? m->hi : m->lo;
+    uint8_t top = h[0];
+    uint8_t n = hi ? --m->nhi : --m->nlo;
+    if(n) {
+        Heap_Set(m, hi, 0, h[n]);
+        Heap_Down(m, hi, 0);
+    }
+    return top;
+}
+
+void HGQ_Median_Init(HGQ_Median *m, uint8_t n)
+{
+    if(n < 1) n = 1;
+    if(n > HGQ_FILT_WIN_MAX) n = HGQ_FILT_WIN_MAX;
+    m->n = n;
+    m->pos = 0;
+    m->nlo = m->nhi = 0;
+}
+
+int32_t HGQ_Median_Put(HGQ_Median *m, int32_t x)
+{
+    uint8_t s = m->pos;
+
+    m->pos = (uint8_t)((s + 1) % m->n);
+    if(m->nlo + m->nhi < m->n) {
+        /* 窗口未满：进较近的那一堆，再保持 nlo == nhi 或 nlo == nhi + 1 */
+        m->v[s] = x;
+        if(m->nlo == 0 || x <= m->v[m->lo[0]]) Heap_Push(m, 0, s);
+        else Heap_Push(m, 1, s);
+        if(m->nlo > m->nhi + 1) Heap_Push(m, 1, Heap_Pop(m, 0));
+        else if(m->nhi > m->nlo) Heap_Push(m, 0, Heap_Pop(m, 1));
+    } else {
+        /* 窗口已满：最旧样本所在的堆位置原地换成新值，再上浮/下沉 */
+        uint8_t hi = (m->at[s] & AT_HI) ? 1 : 0;
+        m->v[s] = x;
+        Heap_Up(m, hi, m->at[s] & 0x7F);
+        Heap_Down(m, hi, m->at[s] & 0x7F);
+        /* 新值越过了分界：两个堆顶互换 */
+        if(m->nhi && m->v[m->lo[0]] > m->v[m->hi[0]]) {
+            uint8_t a = m->lo[0], b = m->hi[0];
+            Heap_Set(m, 0, 0, b);
+            Heap_Set(m, 1, 0, a);
+            Heap_Down(m, 0, 0);
+            Heap_Down(m, 1, 0);
+        }
+    }
+    return HGQ_Median_Get(m);
+}
+
+int32_t HGQ_Median_Get(const HGQ_Median *m)
+{
+    if(m->nlo == 0) return 0;
+    if(m->nlo > m->nhi) return m->v[m->lo[0]];
+    return (int32_t)(((int64_t)m->v[m->lo[0]] + m->v[m->hi[0]]) / 2);
+}
+
+uint8_t HGQ_Median_Count(const HGQ_Median *m)
+{
+    return (uint8_t)(m->nlo + m->nhi);
+}
+
+/* ---------------- 去两端平均 ---------------- */
+/* 第一个 > x (upper=1) 或 >= x (upper=0) 的位置 */
+static uint8_t Bsearch(const int32_t *a, uint8_t n, int32_t x, uint8_t upper)
+{
+    uint8_t lo = 0, hi = n, mid;
+    while(lo < hi) {
+        mid = (uint8_t)((lo + hi) / 2);
+        if(a[mid] < x || (upper && a[mid] == x)) lo = (uint8_t)(mid + 1);
+        else hi = mid;
+    }
+    return lo;
+}
+
+void HGQ_TrimMean_Init(HGQ_TrimMean *t, uint8_t n, uint8_t trim)
+{
+    if(n < 1) n = 1;
+    if(n > HGQ_FILT_WIN_MAX) n = HGQ_FILT_WIN_MAX;
+    t->n = n;
+    t->trim = trim;
+    t->cnt = 0;
+    t->pos = 0;
+}
+
+int32_t HGQ_TrimMean_Put(HGQ_TrimMean *t, int32_t x)
+{
+    uint8_t i, trim;
+    int64_t sum = 0;
+
+    if(t->cnt == t->n) {
+        i = Bsearch(t->sorted, t->cnt, t->ring[t->pos], 0);
+        t->cnt--;
+        memmove(&t->sorted[i], &t->sorted[i + 1], (t->cnt - i) * sizeof(int32_t));
+    }
+    t->ring[t->pos] = x;
+    t->pos = (uint8_t)((t->pos + 1) % t->n);
+
+    i = Bsearch(t->sorted, t->cnt, x, 1);
+    memmove(&t->sorted[i + 1], &t->sorted[i], (t->cnt - i) * sizeof(int32_t));
+    t->sorted[i] = x;
+    t->cnt++;
+
+    trim = t->trim;
+    if(t->cnt < 3 || trim * 2 >= t->cnt) trim = 0;
+    for(i = trim; i < t->cnt - trim; i++) sum += t->sorted[i];
+    return (int32_t)(sum / (t->cnt - 2 * trim));
+}
+
+/* ---------------- 指数平均 ---------------- */
+void HGQ_Ema_Init(HGQ_Ema *e, uint8_t shift)
+{
+    e->shift = shift;
+    e->ready = 0;
+    e->y = 0;
+}
+
+int32_t HGQ_Ema_Put(HGQ_Ema *e, int32_t x)
+{
+    int32_t xq = x * 256;                   /* |x| < 2^23 */
+    if(!e->ready) { e->y = xq; e->ready = 1; }
+    else e->y += (xq - e->y) >> e->shift;
+    return (e->y + 128) >> 8;
+}
+
+/* ---------------- Hampel ---------------- */
+/* 第 k 小 (0 起)，会打乱 a */
+static int32_t Select(int32_t *a, uint8_t n, uint8_t k)
+{
+    uint8_t lo = 0, hi = (uint8_t)(n - 1);
+    while(lo < hi) {
+        int32_t p = a[(lo + hi) / 2], tmp;
+        int i = lo, j = hi;
+        while(i <= j) {
+            while(a[i] < p) i++;
+            while(a[j] > p) j--;
+            if(i <= j) { tmp = a[i]; a[i] = a[j]; a[j] = tmp; i++; j--; }
+        }
+        if(k <= j) hi = (uint8_t)j;
+        else if(k >= i) lo = (uint8_t)i;
+        else break;
+    }
+    return a[k];
+}
+
+void HGQ_Hampel_Init(HGQ_Hampel *h, uint8_t n, uint16_t k_q8, int32_t min_abs)
+{
+    HGQ_Median_Init(&h->med, n);
+    h->k_q8 = k_q8;
+    h->min_abs = min_abs < 0 ? 0 : min_abs;
+    h->outliers = 0;
+}
+
+int32_t HGQ_Hampel_Put(HGQ_Hampel *h, int32_t x)
+{
+    int32_t dev[HGQ_FILT_WIN_MAX], med, mad;
+    uint8_t i, n;
+    int64_t d;
+
+    med = HGQ_Median_Put(&h->med, x);
+    n = HGQ_Median_Count(&h->med);
+    if(n < 3) return x;
+
+    /* MAD：各样本与中位数偏差的中位数 (偶数个取较大的那个) */
+    for(i = 0; i < n; i++) {
+        d = (int64_t)h->med.v[i] - med;
+        dev[i] = (int32_t)(d < 0 ? -d : d);
+    }
+    mad = Select(dev, n, (uint8_t)(n / 2));
+
+    /* |x - med| > max(k * 1.4826 * MAD, min_abs)，1.4826 取 Q8 的 380 */
+    d = (int64_t)x - med;
+    if(d < 0) d = -d;
+    if(d > h->min_abs && d * 65536 > (int64_t)h->k_q8 * 380 * mad) {
+        h->outliers++;
+        return med;
+    }
+    return x;
+}
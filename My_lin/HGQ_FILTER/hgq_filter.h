@@ -0,0 +1,61 @@
+#ifndef __HGQ_FILTER_H
+#define __HGQ_FILTER_H
+
+#include <stdint.h>
+
+/*
+ * 传感器数据流滤波 (定点，int32 样本，缩放由调用者定，如温度 x100)
+ *   - 每个实例自带固定大小的存储，声明成 static 或放进设备句柄，不用堆
+ *   - 每来一个样本 Put 一次，返回当前输出，不再每次从头排序
+ *   - Median   滑动中位数：大顶堆 (下半) + 小顶堆 (上半)，挤出最旧样本时原位替换再调整，O(log n)
+ *   - TrimMean 去两端平均：有序窗口 + 二分查找增删，n <= HGQ_FILT_WIN_MAX 时只挪几个字
+ *   - Ema      指数平均：alpha = 1/2^shift，内部多留 8 位小数，O(1)
+ *   - Hampel   离群剔除：与窗口中位数的偏差超过 max(k*1.4826*MAD, min_abs) 时输出中位数，否则原样输出；
+ *              min_abs 防止读数平稳 (MAD=0) 时任何一点变化都被当成离群
+ * 不依赖芯片头文件，tools/filtbench 在主机上直接编译同一份代码
+ */
+#define HGQ_FILT_WIN_MAX    15      /* 窗口上限 */
+
+typedef struct {
+    int32_t v[HGQ_FILT_WIN_MAX];    /* 按到达顺序的环 */
+    uint8_t lo[HGQ_FILT_WIN_MAX];   /* 大顶堆：较小的一半 (存环下标) */
+    uint8_t hi[HGQ_FILT_WIN_MAX];   /* 小顶堆：较大的一半 */
+    uint8_t at[HGQ_FILT_WIN_MAX];   /* 环下标 -> 堆位置，最高位为 1 表示在 hi */
+    uint8_t nlo, nhi;
+    uint8_t n, pos;                 /* 窗口长度 / 下一个写入位置 */
+} HGQ_Median;
+
+typedef struct {
+    int32_t ring[HGQ_FILT_WIN_MAX]; /* 按到达顺序 */
+    int32_t sorted[HGQ_FILT_WIN_MAX];
+    uint8_t n, trim, cnt, pos;
+} HGQ_TrimMean;
+
+typedef struct {
+    int32_t y;                      /* 输出，左移 8 位 */
+    uint8_t shift;
+    uint8_t ready;
+} HGQ_Ema;
+
+typedef struct {
+    HGQ_Median med;
+    uint16_t k_q8;                  /* 阈值倍数 k，Q8 (3.0 -> 768) */
+    int32_t  min_abs;               /* 阈值下限，与样本同单位 */
+    uint32_t outliers;
+} HGQ_Hampel;
+
+void    HGQ_Median_Init(HGQ_Median *m, uint8_t n);
+int32_t HGQ_Median_Put(HGQ_Median *m, int32_t x);      /* 返回窗口中位数，偶数个取中间两个的平均 */
+int32_t HGQ_Median_Get(const HGQ_Median *m);
+uint8_t HGQ_Median_Count(const HGQ_Median *m);
+
+void    HGQ_TrimMean_Init(HGQ_TrimMean *t, uint8_t n, uint8_t trim);
+int32_t HGQ_TrimMean_Put(HGQ_TrimMean *t, int32_t x);  /* 样本不足 3 个或 trim 太大时不去端点 */
+
+void    HGQ_Ema_Init(HGQ_Ema *e, uint8_t shift);       /* shift=0 直通 */
+int32_t HGQ_Ema_Put(HGQ_Ema *e, int32_t x);            /* 第一个样本直接作为初值 */
+
+void    HGQ_Hampel_Init(HGQ_Hampel *h, uint8_t n, uint16_t k_q8, int32_t min_abs);
+int32_t HGQ_Hampel_Put(HGQ_Hampel *h, int32_t x);
+
+#endif
@@ -0,0 +1,592 @@
+#include "hgq_i2c.h"
+#include "delay.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <string.h>
+
+typedef struct {
+    I2C_TypeDef        *i2c;        /* NULL：软件模拟 */
+    GPIO_TypeDef       *scl_port;
+    GPIO_TypeDef       *sda_port;
+    u32                 gpio_rcc;
+    u8                  scl_n;
+    u8                  sda_n;
+    u8                  od;         /* 1 开漏 (外部上拉)；0 推挽，读 SDA 时切输入 (电容触摸沿用原接法) */
+    u8                  dly;        /* 软件：半个时钟周期 us */
+    u8                  dly_ss;     /* 软件：起始/停止建立保持 us */
+    /* 硬件后端 */
+    u32                 i2c_rcc;
+    u8                  af;
+    DMA_Stream_TypeDef *dma;        /* 接收 DMA */
+    u32                 dma_ch;
+    u32                 dma_flags;  /* 该数据流全部标志 */
+    u32                 dma_tc;
+    u8                  ev_irq, er_irq, dma_irq;
+} Bus_Cfg;
+
+typedef struct {
+    SemaphoreHandle_t mutex;
+    HGQ_I2C_Xfer *q[HGQ_I2C_QUEUE_LEN];     /* q[head] 为正在进行的传输 */
+    u8  head, cnt;
+    HGQ_I2C_Xfer *volatile cur;
+    u8  phase;
+    u16 idx;                    /* 写阶段已发字节 (含寄存器地址) */
+    volatile u8 reset;          /* Cancel 正在复位总线，期间只排队不发起 */
+    u8  inited;
+    HGQ_I2C_Stats st;
+} Bus_Run;
+
+enum { PH_WR = 0, PH_RD };
+
+static const Bus_Cfg s_cfg[HGQ_I2C_BUS_NUM] = {
+    [HGQ_I2C_AHT] = {
+        .i2c = HGQ_I2C_AHT_HW ? I2C1 : 0,
+        .scl_port = GPIOB, .sda_port = GPIOB, .gpio_rcc = RCC_AHB1Periph_GPIOB,
+        .scl_n = 6, .sda_n = 7, .od = 1, .dly = 2, .dly_ss = 4,
+        .i2c_rcc = RCC_APB1Periph_I2C1, .af = GPIO_AF_I2C1,
+        .dma = DMA1_Stream0, .dma_ch = DMA_Channel_1,
+        .dma_flags = DMA_FLAG_FEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TCIF0,
+        .dma_tc = DMA_FLAG_TCIF0,
+        .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn, .dma_irq = DMA1_Stream0_IRQn,
+    },
+    [HGQ_I2C_TOF] = {
+        .i2c = HGQ_I2C_TOF_HW ? I2C2 : 0,
+        .scl_port = GPIOB, .sda_port = GPIOB, .gpio_rcc = RCC_AHB1Periph_GPIOB,
+        .scl_n = 10, .sda_n = 11, .od = 1, .dly = 2, .dly_ss = 2,
+        .i2c_rcc = RCC_APB1Periph_I2C2, .af = GPIO_AF_I2C2,
+        .dma = DMA1_Stream2, .dma_ch = DMA_Channel_7,
+        .dma_flags = DMA_FLAG_FEIF2 | DMA_FLAG_DMEIF2 | DMA_FLAG_TEIF2 | DMA_FLAG_HTIF2 | DMA_FLAG_TCIF2,
+        .dma_tc = DMA_FLAG_TCIF2,
+        .ev_irq = I2C2_EV_IRQn, .er_irq = I2C2_ER_IRQn, .dma_irq = DMA1_Stream2_IRQn,
+    },
+    [HGQ_I2C_LUX] = {
+        .scl_port = GPIOC, .sda_port = GPIOC, .gpio_rcc = RCC_AHB1Periph_GPIOC,
+        .scl_n = 0, .sda_n = 1, .od = 1, .dly = 2, .dly_ss = 4,
+    },
+    [HGQ_I2C_CT] = {
+        .scl_port = GPIOB, .sda_port = GPIOF, .gpio_rcc = RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_GPIOF,
+        .scl_n = 0, .sda_n = 11, .od = 0, .dly = 2, .dly_ss = 30,
+    },
+};
+
+static Bus_Run s_run[HGQ_I2C_BUS_NUM];
+
+/* 写阶段第 i 个字节：先寄存器地址 (高字节先)，再数据 */
+static u8 Wr_Byte(const HGQ_I2C_Xfer *x, u16 i)
+{
+    if(i < x->reglen) return (u8)(x->reglen - i == 2 ? x->reg >> 8 : x->reg);
+    return x->wbuf[i - x->reglen];
+}
+
+static void Bus_Count(Bus_Run *r, const HGQ_I2C_Xfer *x, u8 st)
+{
+    if(st == HGQ_I2C_OK) { r->st.xfers++; r->st.bytes += x->wlen + x->rlen; }
+    else if(st == HGQ_I2C_NACK) r->st.nacks++;
+    else r->st.errors++;
+}
+
+/* ================= 软件后端 ================= */
+#define SW_SCL_H(c)     ((c)->scl_port->BSRRL = (u16)(1u << (c)->scl_n))
+#define SW_SCL_L(c)     ((c)->scl_port->BSRRH = (u16)(1u << (c)->scl_n))
+#define SW_SDA_H(c)     ((c)->sda_port->BSRRL = (u16)(1u << (c)->sda_n))
+#define SW_SDA_L(c)     ((c)->sda_port->BSRRH = (u16)(1u << (c)->sda_n))
+#define SW_SDA(c)       (((c)->sda_port->IDR >> (c)->sda_n) & 1)
+
+/* 推挽接法读 SDA 前切输入；开漏输出本身就能读引脚电平，不用切 */
+static void Sw_SdaDir(const Bus_Cfg *c, u8 out)
+{
+    u32 m;
+    if(c->od) return;
+    m = c->sda_port->MODER & ~(3u << (2 * c->sda_n));
+    c->sda_port->MODER = out ? m | (1u << (2 * c->sda_n)) : m;
+}
+
+static void Sw_Start(const Bus_Cfg *c)
+{
+    Sw_SdaDir(c, 1);
+    SW_SDA_H(c); SW_SCL_H(c); delay_us(c->dly_ss);
+    SW_SDA_L(c);              delay_us(c->dly_ss);
+    SW_SCL_L(c);              delay_us(c->dly);
+}
+
+static void Sw_Stop(const Bus_Cfg *c)
+{
+    Sw_SdaDir(c, 1);
+    SW_SCL_L(c); SW_SDA_L(c); delay_us(c->dly);
+    SW_SCL_H(c);              delay_us(c->dly_ss);
+    SW_SDA_H(c);              delay_us(c->dly_ss);
+}
+
+/* 返回 0 有应答 */
+static u8 Sw_Send(const Bus_Cfg *c, u8 b)
+{
+    u8 i, nack;
+    Sw_SdaDir(c, 1);
+    for(i = 0; i < 8; i++) {
+        if(b & 0x80) SW_SDA_H(c); else SW_SDA_L(c);
+        b <<= 1;
+        delay_us(c->dly);
+        SW_SCL_H(c); delay_us(c->dly);
+        SW_SCL_L(c);
+    }
+    SW_SDA_H(c); Sw_SdaDir(c, 0);       /* 释放 SDA，第 9 个时钟读应答 */
+    delay_us(c->dly);
+    SW_SCL_H(c); delay_us(c->dly);
+    nack = SW_SDA(c);
+    SW_SCL_L(c);
+    return nack;
+}
+
+static u8 Sw_Recv(const Bus_Cfg *c, u8 ack)
+{
+    u8 i, b = 0;
+    SW_SDA_H(c); Sw_SdaDir(c, 0);
+    for(i = 0; i < 8; i++) {
+        delay_us(c->dly);
+        SW_SCL_H(c); delay_us(c->dly);
+        b = (u8)((b << 1) | SW_SDA(c));
+        SW_SCL_L(c);
+    }
+    Sw_SdaDir(c, 1);
+    if(ack) SW_SDA_L(c); else SW_SDA_H(c);
+    delay_us(c->dly);
+    SW_SCL_H(c); delay_us(c->dly);
+    SW_SCL_L(c);
+    return b;
+}
+
+static u8 Sw_Xfer(const Bus_Cfg *c, HGQ_I2C_Xfer *x)
+{
+    u16 i, n = x->reglen + x->wlen;
+    u8 st = HGQ_I2C_OK;
+
+    if(n || !x->rlen) {
+        Sw_Start(c);
+        if(Sw_Send(c, (u8)(x->addr << 1))) st = HGQ_I2C_NACK;
+        for(i = 0; i < n && st == HGQ_I2C_OK; i++)
+            if(Sw_Send(c, Wr_Byte(x, i))) st = HGQ_I2C_NACK;
+    }
+    if(x->rlen && st == HGQ_I2C_OK) {
+        Sw_Start(c);                    /* 有写阶段时为重复起始 */
+        if(Sw_Send(c, (u8)((x->addr << 1) | 1))) st = HGQ_I2C_NACK;
+        else for(i = 0; i < x->rlen; i++) x->rbuf[i] = Sw_Recv(c, i + 1 < x->rlen);
+    }
+    Sw_Stop(c);
+    return st;
+}
+
+/* 引脚设为 GPIO 输出并释放总线；从机把 SDA 拉住时 (上次传输被打断) 补最多 9 个时钟再发停止 */
+static void Sw_Init(const Bus_Cfg *c)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    u8 i;
+
+    RCC_AHB1PeriphClockCmd(c->gpio_rcc, ENABLE);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+    GPIO_InitStructure.GPIO_OType = c->od ? GPIO_OType_OD : GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    SW_SCL_H(c); SW_SDA_H(c);
+    GPIO_InitStructure.GPIO_Pin = 1u << c->scl_n;
+    GPIO_Init(c->scl_port, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = 1u << c->sda_n;
+    GPIO_Init(c->sda_port, &GPIO_InitStructure);
+    delay_us(10);
+
+    if(c->od && !SW_SDA(c)) {
+        for(i = 0; i < 9 && !SW_SDA(c); i++) {
+            SW_SCL_L(c); delay_us(5);
+            SW_SCL_H(c); delay_us(5);
+        }
+        Sw_Stop(c);
+    }
+}
+
+/* ================= 硬件后端 ================= */
+#define I2C_SR1_ERRS    (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | I2C_SR1_TIMEOUT)
+
+static void Hw_Start(u8 b);
+
+/* 结束当前传输并发起队列里的下一个 (中断或临界区内调用) */
+static void Bus_Done(u8 b, u8 st)
+{
+    const Bus_Cfg *c = &s_cfg[b];
+    Bus_Run *r = &s_run[b];
+    HGQ_I2C_Xfer *x = r->cur;
+    void *waiter = x->waiter;
+    void (*done)(HGQ_I2C_Xfer *) = x->done;
+    BaseType_t woken = pdFALSE;
+
+    c->i2c->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+    c->dma->CR &= ~DMA_SxCR_EN;
+    r->cur = 0;
+    r->head = (r->head + 1) % HGQ_I2C_QUEUE_LEN;
+    r->cnt--;
+    Bus_Count(r, x, st);
+    x->status = st;
+
+    if(waiter) vTaskNotifyGiveIndexedFromISR((TaskHandle_t)waiter, HGQ_I2C_NOTIFY_INDEX, &woken);
+    if(done) done(x);
+    if(r->cnt && r->cur == 0 && !r->reset) Hw_Start(b);     /* 回调里提交的传输可能已经发起了 */
+    portYIELD_FROM_ISR(woken);
+}
+
+static void Hw_Start(u8 b)
+{
+    I2C_TypeDef *i2c = s_cfg[b].i2c;
+    Bus_Run *r = &s_run[b];
+    HGQ_I2C_Xfer *x = r->q[r->head];
+    u16 n = 1000;
+
+    r->cur = x;
+    r->idx = 0;
+    r->phase = (x->reglen + x->wlen || !x->rlen) ? PH_WR : PH_RD;
+    while((i2c->CR1 & I2C_CR1_STOP) && --n);   /* 上一个 STOP 还没发出去时不能置 START，最多一个位时间 */
+    i2c->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+    i2c->CR1 |= I2C_CR1_ACK | I2C_CR1_START;
+}
+
+static void Dma_Arm(const Bus_Cfg *c, u8 *buf, u16 n)
+{
+    c->dma->CR &= ~DMA_SxCR_EN;
+    while(c->dma->CR & DMA_SxCR_EN);
+    DMA_ClearFlag(c->dma, c->dma_flags);
+    c->dma->M0AR = (u32)buf;
+    c->dma->NDTR = n;
+    c->dma->CR |= DMA_SxCR_EN;
+}
+
+/* 事件中断：SB 发地址，ADDR 后写第一个字节或交给 DMA 接收，TXE 续写，BTF 时重复起始或停止 */
+static void Hw_Event(u8 b)
+{
+    const Bus_Cfg *c = &s_cfg[b];
+    Bus_Run *r = &s_run[b];
+    I2C_TypeDef *i2c = c->i2c;
+    HGQ_I2C_Xfer *x = r->cur;
+    u16 sr1 = i2c->SR1, n;
+
+    if(x == 0) { i2c->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN); return; }
+    n = x->reglen + x->wlen;
+
+    if(sr1 & I2C_SR1_SB) {
+        if(r->phase == PH_WR) { i2c->DR = (u8)(x->addr << 1); return; }
+        if(x->rlen >= 2) {
+            Dma_Arm(c, x->rbuf, x->rlen);
+            i2c->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;  /* 最后一个字节自动回 NACK */
+        } else {
+            i2c->CR1 &= ~I2C_CR1_ACK;                   /* 只读 1 字节：清 ADDR 前关应答 */
+        }
+        i2c->DR = (u8)((x->addr << 1) | 1);
+        return;
+    }
+    if(sr1 & I2C_SR1_ADDR) {
+        if(r->phase == PH_RD) {
+            if(x->rlen == 1) {
+                __disable_irq();                        /* 清 ADDR 与置 STOP 之间不能被打断 */
+                (void)i2c->SR2;
+                i2c->CR1 |= I2C_CR1_STOP;
+                __enable_irq();
+                i2c->CR2 |= I2C_CR2_ITBUFEN;
+            } else {
+                (void)i2c->SR2;                         /* DMA 开始接收 */
+            }
+            return;
+        }
+        (void)i2c->SR2;
+        if(n == 0) { i2c->CR1 |= I2C_CR1_STOP; Bus_Done(b, HGQ_I2C_OK); return; }  /* 只探测地址 */
+        i2c->DR = Wr_Byte(x, r->idx++);
+        if(r->idx < n) i2c->CR2 |= I2C_CR2_ITBUFEN;
+        return;
+    }
+    if(r->phase == PH_RD) {
+        if((sr1 & I2C_SR1_RXNE) && x->rlen == 1) {
+            i2c->CR2 &= ~I2C_CR2_ITBUFEN;
+            x->rbuf[0] = (u8)i2c->DR;
+            Bus_Done(b, HGQ_I2C_OK);
+        }
+        return;
+    }
+    if((sr1 & I2C_SR1_TXE) && r->idx < n) {
+        i2c->DR = Wr_Byte(x, r->idx++);
+        if(r->idx >= n) i2c->CR2 &= ~I2C_CR2_ITBUFEN;
+        return;
+    }
+    if(sr1 & I2C_SR1_BTF) {
+        if(x->rlen) { r->phase = PH_RD; i2c->CR1 |= I2C_CR1_START; }
+        else        { i2c->CR1 |= I2C_CR1_STOP; Bus_Done(b, HGQ_I2C_OK); }
+    }
+}
+
+static void Hw_Error(u8 b)
+{
+    I2C_TypeDef *i2c = s_cfg[b].i2c;
+    u16 sr1 = i2c->SR1;
+
+    i2c->SR1 = (u16)~(sr1 & I2C_SR1_ERRS);             /* 写 0 清除 */
+    if(s_run[b].cur == 0) return;
+    if(sr1 & (I2C_SR1_AF | I2C_SR1_BERR)) i2c->CR1 |= I2C_CR1_STOP;
+    Bus_Done(b, (sr1 & I2C_SR1_AF) ? HGQ_I2C_NACK : HGQ_I2C_ERR);
+}
+
+static void Hw_Dma(u8 b)
+{
+    const Bus_Cfg *c = &s_cfg[b];
+    if(DMA_GetFlagStatus(c->dma, c->dma_tc) == RESET) return;
+    DMA_ClearFlag(c->dma, c->dma_flags);
+    if(s_run[b].cur == 0) return;
+    c->i2c->CR1 |= I2C_CR1_STOP;
+    Bus_Done(b, HGQ_I2C_OK);
+}
+
+/* 调度器启动前中断被屏蔽，直接查标志推进状态机 */
+static void Hw_Poll(u8 b)
+{
+    if(s_cfg[b].i2c->SR1 & I2C_SR1_ERRS) Hw_Error(b);
+    if(s_run[b].cur) Hw_Event(b);
+    if(s_run[b].cur) Hw_Dma(b);
+}
+
+static void Hw_Init(u8 b)
+{
+    const Bus_Cfg *c = &s_cfg[b];
+    GPIO_InitTypeDef GPIO_InitStructure;
+    I2C_InitTypeDef  I2C_InitStructure;
+    DMA_InitTypeDef  DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    Sw_Init(c);                             /* 先当 GPIO 释放总线 */
+
+    RCC_APB1PeriphClockCmd(c->i2c_rcc, ENABLE);
+    RCC_APB1PeriphResetCmd(c->i2c_rcc, ENABLE);
+    RCC_APB1PeriphResetCmd(c->i2c_rcc, DISABLE);
+
+    GPIO_PinAFConfig(c->scl_port, c->scl_n, c->af);
+    GPIO_PinAFConfig(c->sda_port, c->sda_n, c->af);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_InitStructure.GPIO_Pin = 1u << c->scl_n;
+    GPIO_Init(c->scl_port, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = 1u << c->sda_n;
+    GPIO_Init(c->sda_port, &GPIO_InitStructure);
+
+    I2C_InitStructure.I2C_ClockSpeed = HGQ_I2C_HW_SPEED;
+    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+    I2C_InitStructure.I2C_OwnAddress1 = 0;
+    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+    I2C_Init(c->i2c, &I2C_InitStructure);
+    I2C_Cmd(c->i2c, ENABLE);
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    DMA_DeInit(c->dma);
+    while(DMA_GetCmdStatus(c->dma) != DISABLE);
+    DMA_InitStructure.DMA_Channel = c->dma_ch;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&c->i2c->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = 0;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(c->dma, &DMA_InitStructure);
+    DMA_ITConfig(c->dma, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = HGQ_I2C_IRQ_PRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = c->ev_irq;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = c->er_irq;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = c->dma_irq;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/* 入队，总线空闲时立即发起；任务、中断、完成回调里都可以调用 */
+static u8 Hw_Queue(u8 b, HGQ_I2C_Xfer *x)
+{
+    Bus_Run *r = &s_run[b];
+    UBaseType_t m = taskENTER_CRITICAL_FROM_ISR();
+
+    if(r->cnt >= HGQ_I2C_QUEUE_LEN) { taskEXIT_CRITICAL_FROM_ISR(m); return HGQ_I2C_BUSY; }
+    x->status = HGQ_I2C_PENDING;
+    r->q[(r->head + r->cnt) % HGQ_I2C_QUEUE_LEN] = x;
+    r->cnt++;
+    if(r->cnt > r->st.qmax) r->st.qmax = r->cnt;
+    if(r->cur == 0 && !r->reset) Hw_Start(b);
+    taskEXIT_CRITICAL_FROM_ISR(m);
+    return HGQ_I2C_PENDING;
+}
+
+static u8 Hw_Wait(u8 b, HGQ_I2C_Xfer *x, u32 timeout_ms, u8 rtos)
+{
+    if(rtos) {
+        TickType_t t0 = xTaskGetTickCount(), wait = pdMS_TO_TICKS(timeout_ms) + 1, el;
+        for(;;) {
+            el = xTaskGetTickCount() - t0;
+            if(x->status != HGQ_I2C_PENDING || el >= wait) break;
+            ulTaskNotifyTakeIndexed(HGQ_I2C_NOTIFY_INDEX, pdTRUE, wait - el);
+        }
+    } else {
+        u32 us = timeout_ms * 1000;
+        while(x->status == HGQ_I2C_PENDING && us) { Hw_Poll(b); delay_us(1); us--; }
+    }
+    if(x->status == HGQ_I2C_PENDING) HGQ_I2C_Cancel(b, x);
+    return x->status;
+}
+
+/* ================= 对外接口 ================= */
+u8 HGQ_I2C_Init(u8 bus)
+{
+    Bus_Run *r;
+    if(bus >= HGQ_I2C_BUS_NUM) return 1;
+    r = &s_run[bus];
+    if(r->inited) return 0;
+    if(r->mutex == NULL) r->mutex = xSemaphoreCreateMutex();
+    if(r->mutex == NULL) return 1;
+    if(s_cfg[bus].i2c) Hw_Init(bus);
+    else Sw_Init(&s_cfg[bus]);
+    r->inited = 1;
+    return 0;
+}
+
+u8 HGQ_I2C_IsHw(u8 bus)
+{
+    return bus < HGQ_I2C_BUS_NUM && s_cfg[bus].i2c != 0;
+}
+
+u8 HGQ_I2C_Transfer(u8 bus, HGQ_I2C_Xfer *x, u32 timeout_ms)
+{
+    Bus_Run *r;
+    u8 rtos = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING), st;
+
+    if(bus >= HGQ_I2C_BUS_NUM || x == 0 || !s_run[bus].inited) return HGQ_I2C_ERR;
+    r = &s_run[bus];
+    if(rtos) xSemaphoreTake(r->mutex, portMAX_DELAY);
+    if(s_cfg[bus].i2c == 0) {
+        x->status = HGQ_I2C_PENDING;
+        st = Sw_Xfer(&s_cfg[bus], x);
+        taskENTER_CRITICAL();
+        Bus_Count(r, x, st);
+        taskEXIT_CRITICAL();
+        x->status = st;
+    } else {
+        x->waiter = rtos ? xTaskGetCurrentTaskHandle() : 0;
+        if(rtos) ulTaskNotifyTakeIndexed(HGQ_I2C_NOTIFY_INDEX, pdTRUE, 0);     /* 清掉上次超时后迟到的通知 */
+        st = Hw_Queue(bus, x);
+        if(st == HGQ_I2C_PENDING) st = Hw_Wait(bus, x, timeout_ms, rtos);
+        x->waiter = 0;
+    }
+    if(rtos) xSemaphoreGive(r->mutex);
+    return st;
+}
+
+u8 HGQ_I2C_Submit(u8 bus, HGQ_I2C_Xfer *x)
+{
+    if(bus >= HGQ_I2C_BUS_NUM || x == 0 || !s_run[bus].inited) return HGQ_I2C_ERR;
+    x->waiter = 0;
+    if(s_cfg[bus].i2c == 0) {
+        u8 st = HGQ_I2C_Transfer(bus, x, 0);
+        if(x->done) x->done(x);
+        return st;
+    }
+    return Hw_Queue(bus, x);
+}
+
+void HGQ_I2C_Cancel(u8 bus, HGQ_I2C_Xfer *x)
+{
+    Bus_Run *r;
+    u8 i, found = 0, reset = 0;
+
+    if(!HGQ_I2C_IsHw(bus) || x == 0) return;
+    r = &s_run[bus];
+    taskENTER_CRITICAL();
+    if(x->status == HGQ_I2C_PENDING) {
+        if(r->cur == x) {
+            s_cfg[bus].i2c->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+            s_cfg[bus].dma->CR &= ~DMA_SxCR_EN;
+            r->cur = 0;
+            r->head = (r->head + 1) % HGQ_I2C_QUEUE_LEN;
+            r->cnt--;
+            r->reset = reset = 1;
+        } else {
+            for(i = 0; i < r->cnt; i++) {
+                if(r->q[(r->head + i) % HGQ_I2C_QUEUE_LEN] == x) found = 1;
+                if(found && i + 1 < r->cnt)
+                    r->q[(r->head + i) % HGQ_I2C_QUEUE_LEN] = r->q[(r->head + i + 1) % HGQ_I2C_QUEUE_LEN];
+            }
+            if(found) r->cnt--;
+        }
+        x->status = HGQ_I2C_TIMEOUT;
+        r->st.timeouts++;
+    }
+    taskEXIT_CRITICAL();
+
+    if(reset) {
+        Hw_Init(bus);                       /* 外设复位 + 总线恢复，耗时约 100us，不在临界区里做 */
+        taskENTER_CRITICAL();
+        r->reset = 0;
+        if(r->cnt && r->cur == 0) Hw_Start(bus);
+        taskEXIT_CRITICAL();
+    }
+}
+
+u8 HGQ_I2C_MemWrite(u8 bus, u8 addr, u16 reg, u8 reglen, const u8 *buf, u16 len)
+{
+    HGQ_I2C_Xfer x;
+    memset(&x, 0, sizeof(x));
+    x.addr = addr; x.reg = reg; x.reglen = reglen;
+    x.wbuf = buf; x.wlen = len;
+    return HGQ_I2C_Transfer(bus, &x, HGQ_I2C_TIMEOUT_MS);
+}
+
+u8 HGQ_I2C_MemRead(u8 bus, u8 addr, u16 reg, u8 reglen, u8 *buf, u16 len)
+{
+    HGQ_I2C_Xfer x;
+    memset(&x, 0, sizeof(x));
+    x.addr = addr; x.reg = reg; x.reglen = reglen;
+    x.rbuf = buf; x.rlen = len;
+    return HGQ_I2C_Transfer(bus, &x, HGQ_I2C_TIMEOUT_MS);
+}
+
+u8 HGQ_I2C_Write(u8 bus, u8 addr, const u8 *buf, u16 len)
+{
+    return HGQ_I2C_MemWrite(bus, addr, 0, 0, buf, len);
+}
+
+u8 HGQ_I2C_Read(u8 bus, u8 addr, u8 *buf, u16 len)
+{
+    return HGQ_I2C_MemRead(bus, addr, 0, 0, buf, len);
+}
+
+void HGQ_I2C_GetStats(u8 bus, HGQ_I2C_Stats *st)
+{
+    if(bus >= HGQ_I2C_BUS_NUM) return;
+    taskENTER_CRITICAL();
+    *st = s_run[bus].st;
+    taskEXIT_CRITICAL();
+}
+
+/* ================= 中断服务函数 ================= */
+#if HGQ_I2C_AHT_HW
+void I2C1_EV_IRQHandler(void)      { Hw_Event(HGQ_I2C_AHT); }
+void I2C1_ER_IRQHandler(void)      { Hw_Error(HGQ_I2C_AHT); }
+void DMA1_Stream0_IRQHandler(void) { Hw_Dma(HGQ_I2C_AHT); }
+#endif
+
+#if HGQ_I2C_TOF_HW
+void I2C2_EV_IRQHandler(void)      { Hw_Event(HGQ_I2C_TOF); }
+void I2C2_ER_IRQHandler(void)      { Hw_Error(HGQ_I2C_TOF); }
+void DMA1_Stream2_IRQHandler(void) { Hw_Dma(HGQ_I2C_TOF); }
+#endif
@@ -0,0 +1,80 @@
+#ifndef __HGQ_I2C_H
+#define __HGQ_I2C_H
+
+#include "stm32f4xx.h"
+
+/*
+ * 统一 I2C 总线驱动
+ *   - 每条总线一个互斥量 + 传输队列：阻塞调用者在互斥量上按优先级排队 (带优先级继承)，
+ *     异步提交的传输进队列，由中断依次发起，前一个完成立即开始下一个
+ *   - 硬件后端：I2C 外设，事件/错误中断推进状态机，读 2 字节以上用 DMA，传输期间不占 CPU
+ *   - 软件后端：同一套位操作代码，引脚没有 I2C 外设的总线 (BH1750、电容触摸) 用它，
+ *     硬件总线也可以通过 HGQ_I2C_xxx_HW 改成软件模拟 (排查上拉/时序问题时用)
+ *   - 调度器启动前 (各传感器初始化阶段) 中断被 FreeRTOS 屏蔽，阻塞接口改为查询标志推进状态机
+ */
+#define HGQ_I2C_AHT_HW          1       /* PB6/PB7：1 用 I2C1 + DMA，0 软件模拟 */
+#define HGQ_I2C_TOF_HW          1       /* PB10/PB11：1 用 I2C2 + DMA，0 软件模拟 */
+#define HGQ_I2C_HW_SPEED        400000  /* 硬件总线时钟 (Hz)，上拉偏弱时改 100000 */
+#define HGQ_I2C_QUEUE_LEN       4       /* 每条总线排队的传输数 */
+#define HGQ_I2C_IRQ_PRIO        6       /* 中断里调用 FromISR，抢占优先级必须 >= 5 */
+#define HGQ_I2C_NOTIFY_INDEX    2       /* 阻塞等待使用的任务通知索引 */
+#define HGQ_I2C_TIMEOUT_MS      20      /* Read/Write 等便捷接口的超时 */
+
+typedef enum {
+    HGQ_I2C_AHT = 0,        /* PB6=SCL PB7=SDA，AHT20 */
+    HGQ_I2C_TOF,            /* PB10=SCL PB11=SDA，VL53L0X */
+    HGQ_I2C_LUX,            /* PC0=SCL PC1=SDA，BH1750 (软件) */
+    HGQ_I2C_CT,             /* PB0=SCL PF11=SDA，电容触摸 (软件) */
+    HGQ_I2C_BUS_NUM
+} HGQ_I2C_Bus;
+
+enum {
+    HGQ_I2C_OK = 0,
+    HGQ_I2C_NACK,           /* 地址或数据无应答 */
+    HGQ_I2C_ERR,            /* 总线错误 / 仲裁丢失 / 参数错误 */
+    HGQ_I2C_TIMEOUT,
+    HGQ_I2C_BUSY,           /* 队列已满 */
+    HGQ_I2C_PENDING = 0xFF  /* 已提交未完成 */
+};
+
+/* 一次传输：[起始 地址W 寄存器地址 写数据] [重复起始 地址R 读数据] 停止
+ * 不写不读 (wlen=rlen=reglen=0) 时只发地址，用来探测设备 */
+typedef struct HGQ_I2C_Xfer HGQ_I2C_Xfer;
+struct HGQ_I2C_Xfer {
+    u8  addr;                           /* 7 位地址 */
+    u8  reglen;                         /* 寄存器地址字节数 0~2，高字节先发 */
+    u16 reg;
+    const u8 *wbuf;                     /* 寄存器地址之后写的数据 */
+    u16 wlen;
+    u8  *rbuf;                          /* 读到的数据 */
+    u16 rlen;                           /* 0 不读 */
+    void (*done)(HGQ_I2C_Xfer *x);      /* 完成回调，硬件总线在中断里调用，可为 NULL */
+    void *arg;
+    volatile u8 status;                 /* HGQ_I2C_PENDING 或结果 */
+    void *waiter;                       /* 内部：阻塞等待的任务 */
+};
+
+typedef struct {
+    u32 xfers;              /* 完成的传输数 */
+    u32 bytes;              /* 读写数据字节数 (不含地址) */
+    u32 nacks;
+    u32 errors;
+    u32 timeouts;
+    u8  qmax;               /* 队列最大深度 */
+} HGQ_I2C_Stats;
+
+u8   HGQ_I2C_Init(u8 bus);                              /* 可重复调用，0 成功 */
+u8   HGQ_I2C_IsHw(u8 bus);                              /* 1 硬件后端 */
+u8   HGQ_I2C_Transfer(u8 bus, HGQ_I2C_Xfer *x, u32 timeout_ms);     /* 阻塞，返回状态 */
+u8   HGQ_I2C_Submit(u8 bus, HGQ_I2C_Xfer *x);           /* 异步，软件总线当场做完；返回 PENDING/结果/BUSY
+                                                           * 硬件总线可在中断和完成回调里调用，软件总线只能在任务里 */
+void HGQ_I2C_Cancel(u8 bus, HGQ_I2C_Xfer *x);           /* 未完成的传输以 TIMEOUT 结束，正在进行的会复位总线 */
+
+u8   HGQ_I2C_Write(u8 bus, u8 addr, const u8 *buf, u16 len);
+u8   HGQ_I2C_Read(u8 bus, u8 addr, u8 *buf, u16 len);
+u8   HGQ_I2C_MemWrite(u8 bus, u8 addr, u16 reg, u8 reglen, const u8 *buf, u16 len);
+u8   HGQ_I2C_MemRead(u8 bus, u8 addr, u16 reg, u8 reglen, u8 *buf, u16 len);
+
+void HGQ_I2C_GetStats(u8 bus, HGQ_I2C_Stats *st);
+
+#endif
@@ -0,0 +1,271 @@
+#include "hgq_journal.h"
+#include "w25qxx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#define JRN_MAGIC       0xA5
+#define JRN_REC         ((uint32_t)sizeof(HGQ_JournalRec))     /* 32，整除页大小，记录不跨页 */
+#define JRN_SECTOR      4096
+#define JRN_SLOTS       (HGQ_JOURNAL_SIZE / JRN_REC)
+#define JRN_WRAP(o)     ((o) & (HGQ_JOURNAL_SIZE - 1))
+#define JRN_BAD_RUN     4       /* 回溯时连续坏记录超过此数视为区域边界 */
+#define JRN_CHIP_UID    0x1FFF7A10
+
+static uint32_t s_wr = 0;           /* 写指针 (区内偏移) */
+static uint32_t s_rd = 0;           /* 补发指针 */
+static uint32_t s_seq = 0;          /* 最后分配的序号 */
+static uint32_t s_boot = 0;
+static uint32_t s_epoch = 0;        /* 日志区纪元号，区域重建时重新随机 */
+static uint32_t s_acked = 0, s_acked_saved = 0;
+static HGQ_JournalStats s_stats = {0};
+
+static uint8_t Rec_Crc(const HGQ_JournalRec *r)
+{
+    const uint8_t *p = (const uint8_t *)r;
+    uint8_t crc = 0;
+    uint32_t i;
+    for(i = 1; i < JRN_REC; i++) {
+        if(i == 3) continue;                /* 跳过 crc 字段本身 */
+        crc ^= p[i];
+        for(uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void Rec_Read(uint32_t off, HGQ_JournalRec *r)
+{
+    W25QXX_Read((u8 *)r, HGQ_JOURNAL_BASE + off, JRN_REC);
+}
+
+static uint8_t Rec_Valid(const HGQ_JournalRec *r)
+{
+    return r->magic == JRN_MAGIC && r->len <= HGQ_JOURNAL_DATA_MAX && r->crc == Rec_Crc(r);
+}
+
+static uint8_t Slot_Empty(uint32_t off)
+{
+    uint32_t w[JRN_REC / 4];
+    uint32_t i;
+    W25QXX_Read((u8 *)w, HGQ_JOURNAL_BASE + off, JRN_REC);
+    for(i = 0; i < JRN_REC / 4; i++) if(w[i] != 0xFFFFFFFF) return 0;
+    return 1;
+}
+
+/* 硬件 RNG 取随机数，再混入芯片 UID 和节拍：RNG 没起来时不同设备也不会撞号；0 留给旧版日志区 */
+static uint32_t Jrn_NewEpoch(void)
+{
+    const uint32_t *uid = (const uint32_t *)JRN_CHIP_UID;
+    uint32_t ep = 0, n;
+
+    RCC->AHB2ENR |= RCC_AHB2ENR_RNGEN;
+    RNG->CR |= RNG_CR_RNGEN;
+    for(n = 0; n < 10000 && !(RNG->SR & RNG_SR_DRDY); n++);
+    if(RNG->SR & RNG_SR_DRDY) ep = RNG->DR;
+    RNG->CR &= ~RNG_CR_RNGEN;
+    RCC->AHB2ENR &= ~RCC_AHB2ENR_RNGEN;
+
+    ep ^= uid[0] ^ uid[1] ^ uid[2] ^ xTaskGetTickCount();
+    if(ep == 0 || ep == 0xFFFFFFFF) ep = 1;
+    return ep;
+}
+
+static void Sector_Erase(uint32_t off)
+{
+    W25QXX_Erase_Sector((HGQ_JOURNAL_BASE + off) / JRN_SECTOR);
+    s_stats.erases++;
+}
+
+/* 写指针刚进入新扇区：提前擦除再下一个扇区，保证追加时永远不需要擦除 */
+static void Jrn_EraseAhead(void)
+{
+    uint32_t ahead = JRN_WRAP(s_wr + JRN_SECTOR);
+    if(s_rd != s_wr && s_rd >= ahead && s_rd < ahead + JRN_SECTOR) {
+        s_stats.lost += (ahead + JRN_SECTOR - s_rd) / JRN_REC;
+        s_rd = JRN_WRAP(ahead + JRN_SECTOR);   /* 最旧的未补发数据被覆盖 */
+    }
+    Sector_Erase(ahead);
+}
+
+/* 只对当前页的下一个空槽做一次页编程，页内按槽顺序填满后进入下一页 */
+static uint32_t Jrn_Put(uint8_t type, const void *data, uint8_t len)
+{
+    HGQ_JournalRec r;
+    if(s_wr % JRN_SECTOR == 0 && type != JRN_T_EPOCH)
+        Jrn_Put(JRN_T_EPOCH, &s_epoch, sizeof(s_epoch));   /* 扇区首条记纪元号，上电只看头扇区即可恢复 */
+    if(len > HGQ_JOURNAL_DATA_MAX) len = HGQ_JOURNAL_DATA_MAX;
+    memset(&r, 0, sizeof(r));
+    r.magic = JRN_MAGIC; r.type = type; r.len = len;
+    r.seq = ++s_seq; r.boot = s_boot;
+    r.up_s = xTaskGetTickCount() / configTICK_RATE_HZ;
+    if(len) memcpy(r.data, data, len);
+    r.crc = Rec_Crc(&r);
+
+    W25QXX_Write_Page((u8 *)&r, HGQ_JOURNAL_BASE + s_wr, JRN_REC);
+    s_stats.appended++;
+    s_wr = JRN_WRAP(s_wr + JRN_REC);
+    if(s_wr % JRN_SECTOR == 0) Jrn_EraseAhead();
+    return r.seq;
+}
+
+/*
+ * 从写指针往回找最后一个 ACK，补发起点为其后 seq 大于已确认序号的第一条记录
+ * (补发期间新事件仍追加在日志里，ACK 可能写在它们之后)；没有 ACK 则从最旧的记录开始
+ */
+static void Jrn_FindTail(void)
+{
+    HGQ_JournalRec r;
+    uint32_t off = s_wr, n, prev_seq = s_seq + 1;
+    uint8_t bad = 0, have_ack = 0;
+
+    s_rd = s_wr;
+    s_acked = 0;
+    for(n = 0; n < JRN_SLOTS; n++) {
+        off = JRN_WRAP(off + HGQ_JOURNAL_SIZE - JRN_REC);
+        Rec_Read(off, &r);
+        if(r.magic == 0xFF) break;                          /* 擦除区：更早的数据不存在 */
+        if(!Rec_Valid(&r)) {                                /* 掉电写坏的记录，容忍少量 */
+            if(++bad > JRN_BAD_RUN) break;
+            continue;
+        }
+        if((int32_t)(prev_seq - r.seq) <= 0) break;         /* 序号不再递减：绕回到了旧数据 */
+        bad = 0; prev_seq = r.seq;
+        if(have_ack && (int32_t)(r.seq - s_acked) <= 0) break;
+        if(r.type == JRN_T_ACK) {
+            if(!have_ack) { memcpy(&s_acked, r.data, sizeof(s_acked)); have_ack = 1; }
+            continue;
+        }
+        s_rd = off;
+    }
+    s_acked_saved = s_acked;
+}
+
+void HGQ_Journal_Init(void)
+{
+    HGQ_JournalRec r;
+    uint32_t i, head = 0, head_seq = 0, head_ep = 0;
+    uint8_t found = 0, idle;
+
+    W25QXX_Lock();
+    /* 1. 每个扇区第一条记录的 seq 最大者为头扇区 */
+    for(i = 0; i < HGQ_JOURNAL_SIZE / JRN_SECTOR; i++) {
+        Rec_Read(i * JRN_SECTOR, &r);
+        if(Rec_Valid(&r) && (!found || (int32_t)(r.seq - head_seq) > 0)) {
+            head = i * JRN_SECTOR; head_seq = r.seq; found = 1;
+            head_ep = 0;                    /* 旧版日志区扇区首条不是 EPOCH，沿用纪元 0 */
+            if(r.type == JRN_T_EPOCH && r.len >= sizeof(head_ep)) memcpy(&head_ep, r.data, sizeof(head_ep));
+        }
+    }
+
+    if(!found) {
+        /* 空区域 (首次使用)：准备前两个扇区，seq 从头计，换新纪元号 */
+        Sector_Erase(0);
+        Sector_Erase(JRN_SECTOR);
+        s_wr = 0; s_rd = 0; s_seq = 0; s_boot = 0;
+        s_epoch = Jrn_NewEpoch();
+        s_acked = s_acked_saved = 0;
+    } else {
+        /* 2. 头扇区内顺序找第一个空槽 */
+        s_wr = head; s_seq = head_seq; s_epoch = head_ep;
+        do {
+            Rec_Read(s_wr, &r);
+            if(r.magic == 0xFF) break;
+            if(Rec_Valid(&r)) { s_seq = r.seq; s_boot = r.boot; }
+            s_wr += JRN_REC;
+        } while(s_wr % JRN_SECTOR != 0);
+        s_wr = JRN_WRAP(s_wr);
+
+        /* 3. 上次掉电可能停在擦除前后，补齐 "写指针所在扇区可写 + 下一扇区已擦除" */
+        if(s_wr % JRN_SECTOR == 0 && !Slot_Empty(s_wr)) Sector_Erase(s_wr);
+        i = JRN_WRAP((s_wr & ~(uint32_t)(JRN_SECTOR - 1)) + JRN_SECTOR);
+        if(!Slot_Empty(i)) Sector_Erase(i);
+
+        Jrn_FindTail();
+    }
+
+    s_boot++;
+    idle = (s_rd == s_wr);
+    Jrn_Put(JRN_T_BOOT, &s_boot, sizeof(s_boot));
+    if(idle) s_rd = s_wr;                   /* 只有 BOOT (和扇区首条 EPOCH) 记录，无需补发 */
+    W25QXX_Unlock();
+
+    printf("[日志] 启动#%lu 纪元=%08lX seq=%lu 写=%lX 待补发=%lu 槽\r\n",
+           (unsigned long)s_boot, (unsigned long)s_epoch, (unsigned long)s_seq, (unsigned long)s_wr,
+           (unsigned long)HGQ_Journal_Pending());
+}
+
+uint32_t HGQ_Journal_Append(uint8_t type, const void *data, uint8_t len)
+{
+    uint32_t seq;
+    W25QXX_Lock();
+    seq = Jrn_Put(type, data, len);
+    W25QXX_Unlock();
+    return seq;
+}
+
+uint8_t HGQ_Journal_Peek(HGQ_JournalRec *out)
+{
+    uint8_t ok = 0;
+    W25QXX_Lock();
+    while(s_rd != s_wr) {
+        Rec_Read(s_rd, out);
+        if(Rec_Valid(out)) {
+            if(out->type == JRN_T_EVENT || out->type == JRN_T_TELEM) { ok = 1; break; }
+        } else {
+            s_stats.bad++;
+        }
+        s_rd = JRN_WRAP(s_rd + JRN_REC);    /* BOOT / ACK / 坏记录直接跳过 */
+    }
+    W25QXX_Unlock();
+    return ok;
+}
+
+void HGQ_Journal_Ack(uint32_t seq)
+{
+    HGQ_JournalRec r;
+    W25QXX_Lock();
+    if(s_rd != s_wr) {
+        Rec_Read(s_rd, &r);
+        if(r.seq == seq) {                  /* 期间可能被覆盖推进过，核对后再前移 */
+            s_rd = JRN_WRAP(s_rd + JRN_REC);
+            s_acked = seq;
+            s_stats.replayed++;
+        }
+    }
+    W25QXX_Unlock();
+}
+
+void HGQ_Journal_Commit(void)
+{
+    W25QXX_Lock();
+    if(s_acked != s_acked_saved) {
+        uint8_t caught_up = (s_rd == s_wr);
+        Jrn_Put(JRN_T_ACK, &s_acked, sizeof(s_acked));
+        if(caught_up) s_rd = s_wr;          /* ACK 记录本身不需要补发 */
+        s_acked_saved = s_acked;
+    }
+    W25QXX_Unlock();
+}
+
+uint32_t HGQ_Journal_Pending(void)
+{
+    return JRN_WRAP(s_wr + HGQ_JOURNAL_SIZE - s_rd) / JRN_REC;
+}
+
+uint32_t HGQ_Journal_Boot(void)
+{
+    return s_boot;
+}
+
+uint32_t HGQ_Journal_Epoch(void)
+{
+    return s_epoch;
+}
+
+void HGQ_Journal_GetStats(HGQ_JournalStats *st)
+{
+    W25QXX_Lock();
+    *st = s_stats;
+    W25QXX_Unlock();
+}
@@ -0,0 +1,58 @@
+#ifndef __HGQ_JOURNAL_H
+#define __HGQ_JOURNAL_H
+
+#include "stm32f4xx.h"
+
+/*
+ * W25Q128 存储转发日志 (追加写、环形)
+ *   - 保留区 11MB~12MB (字库从 12MB 开始)，按 32 字节定长记录顺序写
+ *   - 只做页编程，不走 W25QXX_Write 的读-擦-写；写指针进入新扇区时提前擦除下一个扇区
+ *     擦除 (典型 45ms，最长 400ms) 在调用 Append/Commit 的任务里完成，期间持有 W25QXX 锁：
+ *     ui_task 汉字缓存未命中要读字库时会跟着等；每 128 条记录才擦一次，离线时约两小时一次
+ *   - 每条记录带全局递增序号 seq 和启动序号 boot，上电扫描恢复写指针 / 补发指针
+ *   - 补发进度用 ACK 记录写回日志，掉电后从最后一个 ACK 之后继续补发
+ *   - 日志区读出为空 (首次使用 / 换片 / 整片擦除) 时 seq 从 1 重来，另取随机纪元号 epoch
+ *     写在每个扇区的第一条记录里；服务器按 (seat_id, epoch, seq) 去重，新纪元的序号不会被旧记录挡掉
+ */
+#define HGQ_JOURNAL_BASE        0x00B00000
+#define HGQ_JOURNAL_SIZE        0x00100000      /* 1MB = 256 扇区 = 32768 条 */
+#define HGQ_JOURNAL_DATA_MAX    16
+
+typedef enum {
+    JRN_T_BOOT = 1,     /* 每次上电写一条，保证 seq / boot 单调 */
+    JRN_T_EVENT,        /* 刷卡事件 */
+    JRN_T_TELEM,        /* 离线降采样遥测 */
+    JRN_T_ACK,          /* 补发进度，data = 已确认的 seq */
+    JRN_T_EPOCH         /* 扇区首条，data = 纪元号 */
+} HGQ_JournalType;
+
+typedef struct {
+    uint8_t  magic;     /* 0xA5，0xFF 表示空槽 */
+    uint8_t  type;
+    uint8_t  len;       /* data 有效长度 */
+    uint8_t  crc;       /* CRC8 (type/len/seq/boot/up_s/data) */
+    uint32_t seq;
+    uint32_t boot;      /* 写入时的启动序号 */
+    uint32_t up_s;      /* 写入时的上电秒数 */
+    uint8_t  data[HGQ_JOURNAL_DATA_MAX];
+} HGQ_JournalRec;
+
+typedef struct {
+    uint32_t appended;  /* 写入记录数 */
+    uint32_t replayed;  /* 已补发确认数 */
+    uint32_t erases;    /* 扇区擦除次数 */
+    uint32_t lost;      /* 未补发就被覆盖的记录槽数 */
+    uint32_t bad;       /* CRC 错误被跳过的记录数 */
+} HGQ_JournalStats;
+
+void     HGQ_Journal_Init(void);                                        /* 扫描恢复并写 BOOT 记录 */
+uint32_t HGQ_Journal_Append(uint8_t type, const void *data, uint8_t len); /* 返回 seq */
+uint8_t  HGQ_Journal_Peek(HGQ_JournalRec *out);                         /* 下一条待补发记录 */
+void     HGQ_Journal_Ack(uint32_t seq);                                 /* Peek 到的记录已发出 */
+void     HGQ_Journal_Commit(void);                                      /* 补发进度写回 Flash */
+uint32_t HGQ_Journal_Pending(void);                                     /* 待补发槽数 (含 ACK/BOOT/EPOCH) */
+uint32_t HGQ_Journal_Boot(void);
+uint32_t HGQ_Journal_Epoch(void);                                       /* 0 = 旧版日志区，未记纪元 */
+void     HGQ_Journal_GetStats(HGQ_JournalStats *st);
+
+#endif
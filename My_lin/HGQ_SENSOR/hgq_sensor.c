@@ -0,0 +1,176 @@
+#include "hgq_sensor.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * 每个传感器两种状态：
+ *   IDLE  等 next 到期后触发 (trigger 为 NULL 直接进入 CONV)
+ *   CONV  等 due 到期后取数，未就绪则 due 往后推 retry_ms
+ * 时间用 FreeRTOS 节拍 (1ms)，比较一律用有符号差值，节拍回绕不影响
+ */
+enum { SENS_IDLE = 0, SENS_CONV };
+
+typedef struct {
+    const HGQ_SensorDef *def;
+    u16 period;
+    u8  state;
+    u32 next;                   /* 下一次触发的节拍 */
+    u32 due;                    /* CONV：下一次取数的节拍 */
+    u32 t_trig;                 /* 本轮触发的节拍 */
+    u32 t_last;                 /* 上次取到数据的节拍 */
+    u32 io_cyc;                 /* 本轮 trigger + collect 的 DWT 周期 */
+    HGQ_SensorStats st;
+} Sens_Run;
+
+static Sens_Run s_sens[HGQ_SENSOR_MAX];
+static u8 s_count = 0;
+
+#define TICK_DUE(t, now)    ((int32_t)((now) - (t)) >= 0)
+
+static u32 Cyc_To_Us(u32 cyc)
+{
+    return cyc / (SystemCoreClock / 1000000);
+}
+
+u8 HGQ_Sensor_Add(const HGQ_SensorDef *def)
+{
+    Sens_Run *r;
+    if(!def || !def->collect || s_count >= HGQ_SENSOR_MAX) return HGQ_SENSOR_NONE;
+    r = &s_sens[s_count];
+    r->def = def;
+    r->period = def->period_ms ? def->period_ms : 1;
+    r->state = SENS_IDLE;
+    r->next = xTaskGetTickCount();      /* 第一轮所有传感器同时触发 */
+    return s_count++;
+}
+
+void HGQ_Sensor_SetPeriod(u8 id, u16 period_ms)
+{
+    if(id < s_count && period_ms) s_sens[id].period = period_ms;
+}
+
+/* 触发一个到期的传感器 */
+static void Sens_Trigger(Sens_Run *r, u32 now)
+{
+    u32 t0;
+    u8 ret = 0;
+
+    /* 下一次触发按固定节奏排，落后超过一个周期就从现在重新算，不补发 */
+    r->next += r->period;
+    if(TICK_DUE(r->next, now)) r->next = now + r->period;
+
+    t0 = DWT->CYCCNT;
+    if(r->def->trigger) ret = r->def->trigger();
+    r->io_cyc = DWT->CYCCNT - t0;
+
+    if(ret) { r->st.errors++; return; }
+    r->state = SENS_CONV;
+    r->t_trig = now;
+    r->due = now + r->def->conv_ms;
+}
+
+/* 取数：成功/失败回到 IDLE，未就绪留在 CONV */
+static void Sens_Collect(Sens_Run *r, u32 now)
+{
+    u32 t0 = DWT->CYCCNT, us;
+    u8 ret = r->def->collect();
+    r->io_cyc += DWT->CYCCNT - t0;
+
+    if(ret == HGQ_SENSOR_NOT_READY) {
+        r->st.retries++;
+        r->due = now + (r->def->retry_ms ? r->def->retry_ms : 1);
+        return;
+    }
+    r->state = SENS_IDLE;
+    us = Cyc_To_Us(r->io_cyc);
+    r->st.io_us = us;
+    if(us > r->st.io_max) r->st.io_max = us;
+    if(ret == HGQ_SENSOR_SKIPPED) { r->st.skipped++; return; }
+    if(ret) { r->st.errors++; return; }
+
+    r->st.runs++;
+    r->st.lat_ms = now - r->t_trig;
+    if(r->st.lat_ms > r->st.lat_max) r->st.lat_max = r->st.lat_ms;
+    if(r->st.runs > 1) r->st.period_ms = now - r->t_last;
+    r->t_last = now;
+}
+
+u32 HGQ_Sensor_Run(void)
+{
+    u32 now, wait = 0xFFFFFFFF, left;
+    u8 i;
+
+    for(i = 0; i < s_count; i++) {
+        Sens_Run *r = &s_sens[i];
+        now = xTaskGetTickCount();
+        if(r->state == SENS_CONV && TICK_DUE(r->next, now)) {
+            r->st.overruns++;           /* 上一轮还没取到，放弃它重新触发 */
+            r->state = SENS_IDLE;
+        }
+        if(r->state == SENS_IDLE && TICK_DUE(r->next, now)) Sens_Trigger(r, now);
+        if(r->state == SENS_CONV && TICK_DUE(r->due, now)) Sens_Collect(r, xTaskGetTickCount());
+    }
+
+    /* 距最近一个到期点的时间 */
+    now = xTaskGetTickCount();
+    for(i = 0; i < s_count; i++) {
+        Sens_Run *r = &s_sens[i];
+        u32 t = r->state == SENS_CONV ? r->due : r->next;
+        left = TICK_DUE(t, now) ? 0 : t - now;
+        if(left < wait) wait = left;
+    }
+    return wait == 0xFFFFFFFF ? 1000 : wait;
+}
+
+u8 HGQ_Sensor_Count(void)
+{
+    return s_count;
+}
+
+const char *HGQ_Sensor_Name(u8 id)
+{
+    return id < s_count ? s_sens[id].def->name : "";
+}
+
+u16 HGQ_Sensor_GetPeriod(u8 id)
+{
+    return id < s_count ? s_sens[id].period : 0;
+}
+
+void HGQ_Sensor_GetStats(u8 id, HGQ_SensorStats *st)
+{
+    if(id < s_count) *st = s_sens[id].st;
+}
+
+/* ---------------- 快照 ---------------- */
+static HGQ_SensorSnap s_snap[2];
+static volatile u32 s_ver = 0;
+static u32 s_retries = 0;
+
+void HGQ_Sensor_Publish(HGQ_SensorSnap *s)
+{
+    u32 v = s_ver + 1;
+    s->tick = xTaskGetTickCount();
+    s_snap[v & 1] = *s;
+    __DMB();                    /* 数据写完再切版本号 */
+    s_ver = v;
+}
+
+u32 HGQ_Sensor_Read(HGQ_SensorSnap *s)
+{
+    u32 v;
+    for(;;) {
+        v = s_ver;
+        __DMB();
+        *s = s_snap[v & 1];
+        __DMB();
+        if(s_ver == v) return v;
+        s_retries++;            /* 拷贝期间写者切过版本，这份可能被改了一半 */
+    }
+}
+
+void HGQ_Sensor_SnapStats(u32 *version, u32 *retries)
+{
+    *version = s_ver;
+    *retries = s_retries;
+}
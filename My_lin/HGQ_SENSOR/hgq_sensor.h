@@ -0,0 +1,72 @@
+#ifndef __HGQ_SENSOR_H
+#define __HGQ_SENSOR_H
+
+#include "stm32f4xx.h"
+
+/*
+ * 传感器协作调度
+ *   - 每个传感器拆成 触发 (启动转换) / 取数 两步，各自有周期和转换时间
+ *   - HGQ_Sensor_Run 只做到期的那一步就返回，所有传感器的转换同时进行，
+ *     调用者按返回值睡眠到下一个到期点，不再为某一个器件干等
+ *   - 取数返回“未就绪”时按 retry_ms 再查，不占用其他传感器的时间
+ *   - 统计每个传感器的触发到取到数据的延迟、实际周期和每轮总线调用耗时
+ */
+#define HGQ_SENSOR_MAX          4
+#define HGQ_SENSOR_NOT_READY    1       /* collect 返回：转换未完成 */
+#define HGQ_SENSOR_SKIPPED      0xFE    /* collect 返回：本轮没碰总线 (如器件掉线等重连)，不算错误 */
+#define HGQ_SENSOR_NONE         0xFF
+
+typedef struct {
+    const char *name;
+    u16 period_ms;              /* 两次触发的间隔 (可用 SetPeriod 修改) */
+    u16 conv_ms;                /* 触发后多久第一次取数 */
+    u16 retry_ms;               /* 未就绪时的重查间隔 */
+    u8  (*trigger)(void);       /* 启动转换，返回 0 成功；NULL 表示器件自己连续转换 */
+    u8  (*collect)(void);       /* 取数：0 成功，HGQ_SENSOR_NOT_READY 未就绪，HGQ_SENSOR_SKIPPED 跳过，其他 失败 */
+} HGQ_SensorDef;
+
+typedef struct {
+    u32 runs;                   /* 成功取到数据的次数 */
+    u32 errors;                 /* 触发或取数失败 */
+    u32 retries;                /* 取数时未就绪 */
+    u32 skipped;                /* 取数时跳过 */
+    u32 overruns;               /* 到了下一次触发时间上一轮还没取到数 */
+    u32 lat_ms;                 /* 最近一次：触发到取到数据 */
+    u32 lat_max;
+    u32 period_ms;              /* 最近两次取到数据的实际间隔 */
+    u32 io_us;                  /* 最近一轮 trigger + collect 调用耗时合计 */
+    u32 io_max;
+} HGQ_SensorStats;
+
+u8          HGQ_Sensor_Add(const HGQ_SensorDef *def);      /* 返回编号，HGQ_SENSOR_NONE 表示已满 */
+void        HGQ_Sensor_SetPeriod(u8 id, u16 period_ms);
+u32         HGQ_Sensor_Run(void);                           /* 处理到期的步骤，返回距下一个到期点的 ms */
+u8          HGQ_Sensor_Count(void);
+const char *HGQ_Sensor_Name(u8 id);
+u16         HGQ_Sensor_GetPeriod(u8 id);
+void        HGQ_Sensor_GetStats(u8 id, HGQ_SensorStats *st);
+
+/*
+ * 传感器快照：单写者 (sensor_task) 双缓冲 + 版本号，读者不加锁
+ *   - 写者写进不在用的那一份，写完再把版本号加 1 切过去
+ *   - 读者记下版本号后拷贝，拷完版本号没变才算数，否则重读
+ *   - 写者优先级最低，读者拷贝期间不会被它打断，重读只是兜底
+ */
+#define HGQ_SNAP_AHT    0x01        /* temp_x10 / humi 有效 */
+#define HGQ_SNAP_LUX    0x02
+#define HGQ_SNAP_TOF    0x04
+
+typedef struct {
+    s16 temp_x10;               /* 温度放大10倍 */
+    s16 lux;                    /* -1 表示光照传感器掉线 */
+    u16 tof_mm;
+    u8  humi;
+    u8  valid;                  /* HGQ_SNAP_xxx，至少更新过一次的数值 */
+    u32 tick;                   /* 发布时的节拍 */
+} HGQ_SensorSnap;
+
+void HGQ_Sensor_Publish(HGQ_SensorSnap *s);                /* 只允许一个任务调用，会填 tick */
+u32  HGQ_Sensor_Read(HGQ_SensorSnap *s);                    /* 返回版本号，0 表示还没发布过 */
+void HGQ_Sensor_SnapStats(u32 *version, u32 *retries);
+
+#endif
@@ -0,0 +1,74 @@
+#include "hgq_telem.h"
+#include <string.h>
+
+static HGQ_TelemCfg   s_cfg;
+static HGQ_TelemEntry s_batch[HGQ_TELEM_BATCH_MAX];
+static uint8_t        s_n = 0;
+static HGQ_TelemSample s_last;          /* 上一次记录的值，死区以它为基准 */
+static uint32_t       s_last_ms = 0;
+static uint8_t        s_has_last = 0;
+static uint8_t        s_force = 0;
+static HGQ_TelemStats s_stats = {0};
+
+static int Abs(int v) { return v < 0 ? -v : v; }
+
+void HGQ_Telem_Init(const HGQ_TelemCfg *cfg)
+{
+    s_cfg = *cfg;
+    if(s_cfg.batch_n == 0) s_cfg.batch_n = 1;
+    if(s_cfg.batch_n > HGQ_TELEM_BATCH_MAX) s_cfg.batch_n = HGQ_TELEM_BATCH_MAX;
+    s_n = 0; s_has_last = 0; s_force = 0;
+}
+
+void HGQ_Telem_Force(void) { s_force = 1; }
+
+static uint8_t Telem_Changed(const HGQ_TelemSample *s)
+{
+    if(Abs(s->temp_x10 - s_last.temp_x10) >= s_cfg.db_temp_x10) return 1;
+    if(Abs(s->humi - s_last.humi) >= s_cfg.db_humi) return 1;
+    if((s->lux < 0) != (s_last.lux < 0)) return 1;             /* 传感器掉线/恢复 */
+    if(Abs(s->lux - s_last.lux) >= s_cfg.db_lux) return 1;
+    if(Abs((int)s->tof_mm - (int)s_last.tof_mm) >= s_cfg.db_tof_mm) return 1;
+    return 0;
+}
+
+uint8_t HGQ_Telem_Feed(const HGQ_TelemSample *s, uint32_t now_ms)
+{
+    uint8_t hb;
+    s_stats.fed++;
+
+    hb = s_has_last && (now_ms - s_last_ms >= (uint32_t)s_cfg.heartbeat_s * 1000);
+    if(s_has_last && !s_force && !hb && !Telem_Changed(s)) return 0;
+
+    if(s_n >= HGQ_TELEM_BATCH_MAX) {        /* 发不出去时丢最旧的 */
+        memmove(&s_batch[0], &s_batch[1], sizeof(s_batch[0]) * (HGQ_TELEM_BATCH_MAX - 1));
+        s_n = HGQ_TELEM_BATCH_MAX - 1;
+    }
+    s_batch[s_n].s = *s;
+    s_batch[s_n].t_ms = now_ms;
+    s_n++;
+
+    s_last = *s; s_last_ms = now_ms; s_has_last = 1; s_force = 0;
+    s_stats.recorded++;
+    if(hb) s_stats.heartbeats++;
+    return 1;
+}
+
+uint8_t HGQ_Telem_Ready(uint32_t now_ms)
+{
+    if(s_n == 0) return 0;
+    if(s_n >= s_cfg.batch_n) return 1;
+    return now_ms - s_batch[0].t_ms >= (uint32_t)s_cfg.batch_max_s * 1000;
+}
+
+uint8_t HGQ_Telem_Take(HGQ_TelemEntry *out, uint8_t max)
+{
+    uint8_t n = s_n < max ? s_n : max;
+    memcpy(out, s_batch, sizeof(s_batch[0]) * n);
+    memmove(&s_batch[0], &s_batch[n], sizeof(s_batch[0]) * (s_n - n));
+    s_n -= n;
+    if(n) s_stats.batches++;
+    return n;
+}
+
+void HGQ_Telem_GetStats(HGQ_TelemStats *st) { *st = s_stats; }
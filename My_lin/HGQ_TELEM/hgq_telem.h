@@ -0,0 +1,50 @@
+#ifndef __HGQ_TELEM_H
+#define __HGQ_TELEM_H
+
+#include "stm32f4xx.h"
+
+/*
+ * 遥测死区 / 心跳 / 打包
+ *   - 任一字段变化超过死区才记录样本，否则静默
+ *   - 静默超过 heartbeat_s 强制记录一次 (服务器据此判断设备在线)
+ *   - 记录的样本带时间戳攒批，满 batch_n 个或最早样本等待超过 batch_max_s 时整批发出
+ */
+#define HGQ_TELEM_BATCH_MAX     6       /* 二进制批量 3 + n*9 字节 (n=6 时 57)，不超过 HGQ_AT_RAW_MAX */
+
+typedef struct {
+    int16_t  temp_x10;      /* 温度 x10 */
+    uint8_t  humi;          /* 湿度 %RH */
+    int16_t  lux;           /* 光照，-1 = 传感器异常 */
+    uint16_t tof_mm;        /* 测距 */
+} HGQ_TelemSample;
+
+typedef struct {
+    HGQ_TelemSample s;
+    uint32_t t_ms;          /* 记录时刻 (系统节拍 ms) */
+} HGQ_TelemEntry;
+
+typedef struct {
+    int16_t  db_temp_x10;   /* 温度死区 (0.1 ℃) */
+    uint8_t  db_humi;       /* 湿度死区 (%RH) */
+    int16_t  db_lux;        /* 光照死区 (lx) */
+    uint16_t db_tof_mm;     /* 测距死区 (mm) */
+    uint16_t heartbeat_s;   /* 最长静默时间 */
+    uint8_t  batch_n;       /* 每条消息样本数，1 = 不打包 */
+    uint16_t batch_max_s;   /* 批次最长等待时间 */
+} HGQ_TelemCfg;
+
+typedef struct {
+    uint32_t fed;           /* 喂入次数 */
+    uint32_t recorded;      /* 记录的样本数 */
+    uint32_t heartbeats;    /* 其中由心跳触发的 */
+    uint32_t batches;       /* 发出的消息数 */
+} HGQ_TelemStats;
+
+void    HGQ_Telem_Init(const HGQ_TelemCfg *cfg);
+uint8_t HGQ_Telem_Feed(const HGQ_TelemSample *s, uint32_t now_ms);   /* 返回 1 = 已记录 */
+void    HGQ_Telem_Force(void);                                       /* 下一次喂入无条件记录 */
+uint8_t HGQ_Telem_Ready(uint32_t now_ms);                            /* 批次是否该发出 */
+uint8_t HGQ_Telem_Take(HGQ_TelemEntry *out, uint8_t max);            /* 取出批次，返回样本数 */
+void    HGQ_Telem_GetStats(HGQ_TelemStats *st);
+
+#endif
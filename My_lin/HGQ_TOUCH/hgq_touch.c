@@ -0,0 +1,154 @@
+#include "hgq_touch.h"
+#include "ft5206.h"
+#include "gt9147.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <string.h>
+
+static u8 (*s_read)(u16 *x, u16 *y) = 0;
+static void (*s_notify)(void) = 0;
+static TaskHandle_t  s_task = NULL;
+static QueueHandle_t s_queue = NULL;
+static volatile uint32_t s_irq_tick = 0;
+static volatile uint8_t  s_irq_new = 0;
+static HGQ_TouchStats s_stats = {0};
+
+static void Touch_Post(HGQ_TouchEvent *ev)
+{
+    if(xQueueSend(s_queue, ev, 0) == pdPASS) {
+        s_stats.events++;
+        if(s_notify) s_notify();
+    } else {
+        s_stats.dropped++;
+    }
+}
+
+/* 同步到 tp_dev，保留旧接口的读法 */
+static void Touch_Legacy(const HGQ_TouchEvent *ev)
+{
+    tp_dev.x[0] = ev->x[0];
+    tp_dev.y[0] = ev->y[0];
+    if(ev->n) tp_dev.sta = (u8)((~(0xFF << ev->n)) | TP_PRES_DOWN | TP_CATH_PRES);
+    else      tp_dev.sta &= ~TP_PRES_DOWN;
+}
+
+static void Touch_Task(void *arg)
+{
+    HGQ_TouchEvent ev, last;
+    uint8_t down = 0, stale = 0, n;
+    (void)arg;
+
+    memset(&last, 0, sizeof(last));
+    while(1) {
+        /* 松开后一直阻塞，按住时定时跟踪 (FT 电平模式下按住期间不再有边沿) */
+        ulTaskNotifyTake(pdTRUE, down ? pdMS_TO_TICKS(HGQ_TOUCH_ACTIVE_MS) : portMAX_DELAY);
+
+        memset(&ev, 0, sizeof(ev));
+        n = s_read(ev.x, ev.y);
+        ev.t_read = xTaskGetTickCount();
+        ev.t_irq = s_irq_new ? s_irq_tick : ev.t_read;
+        s_irq_new = 0;
+        s_stats.reads++;
+
+        if(n == 0xFF) {                     /* 控制器还没准备好新数据 */
+            if(!down || ++stale < HGQ_TOUCH_STALE_MAX) continue;
+            n = 0;
+        }
+        stale = 0;
+
+        if(n) {
+            ev.n = n;
+            if(!down) {
+                ev.type = TOUCH_EV_DOWN;
+                if(ev.t_read - ev.t_irq > s_stats.max_lat) s_stats.max_lat = ev.t_read - ev.t_irq;
+            } else if(ev.n != last.n || memcmp(ev.x, last.x, sizeof(ev.x)) || memcmp(ev.y, last.y, sizeof(ev.y))) {
+                ev.type = TOUCH_EV_MOVE;
+            } else {
+                continue;                   /* 按住不动不产生事件 */
+            }
+            down = 1;
+        } else {
+            if(!down) continue;
+            ev.type = TOUCH_EV_UP;
+            memcpy(ev.x, last.x, sizeof(ev.x));
+            memcpy(ev.y, last.y, sizeof(ev.y));
+            down = 0;
+        }
+        last = ev;
+        Touch_Legacy(&ev);
+        Touch_Post(&ev);
+    }
+}
+
+/* PB1 -> EXTI1，双边沿 */
+static void Touch_EXTI_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+
+    /* GT9147_Init 用 PB1 输出选择 I2C 地址后没有改回输入，这里统一设为上拉输入 */
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_100MHz;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource1);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line1;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+    EXTI_ClearITPendingBit(EXTI_Line1);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = HGQ_TOUCH_IRQ_PRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+uint8_t HGQ_Touch_Init(void (*notify)(void))
+{
+    if(tp_dev.scan == FT5206_Scan)      s_read = FT5206_ReadPoints;
+    else if(tp_dev.scan == GT9147_Scan) s_read = GT9147_ReadPoints;
+    else return 1;
+
+    s_notify = notify;
+    s_queue = xQueueCreate(HGQ_TOUCH_QUEUE_LEN, sizeof(HGQ_TouchEvent));
+    if(s_queue == NULL) return 1;
+    if(xTaskCreate(Touch_Task, "Touch", HGQ_TOUCH_STK_SIZE, NULL, HGQ_TOUCH_TASK_PRIO, &s_task) != pdPASS) return 1;
+    Touch_EXTI_Init();
+    return 0;
+}
+
+uint8_t HGQ_Touch_Get(HGQ_TouchEvent *ev)
+{
+    return xQueueReceive(s_queue, ev, 0) == pdPASS;
+}
+
+void HGQ_Touch_GetStats(HGQ_TouchStats *st)
+{
+    taskENTER_CRITICAL();
+    *st = s_stats;
+    taskEXIT_CRITICAL();
+}
+
+/* 中断服务函数：只记时间并唤醒读取任务，I2C 读在任务里做 */
+void EXTI1_IRQHandler(void)
+{
+    BaseType_t woken = pdFALSE;
+    if(EXTI_GetITStatus(EXTI_Line1) != RESET) {
+        EXTI_ClearITPendingBit(EXTI_Line1);
+        s_stats.irqs++;
+        if(!s_irq_new) { s_irq_tick = xTaskGetTickCountFromISR(); s_irq_new = 1; }
+        if(s_task) vTaskNotifyGiveFromISR(s_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
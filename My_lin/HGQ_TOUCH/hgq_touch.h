@@ -0,0 +1,49 @@
+#ifndef __HGQ_TOUCH_H
+#define __HGQ_TOUCH_H
+
+#include "stm32f4xx.h"
+#include "touch.h"
+
+/*
+ * 电容触摸中断读取 (FT5206 / GT9147 / GT911)
+ *   - 控制器 INT 接 PB1，EXTI1 双边沿触发 (GT 出脉冲、FT 按住期间保持低电平，两种都能唤醒)，
+ *     中断里只记时间戳并唤醒读取任务
+ *   - 读取任务一次 I2C 连续读出全部触点，生成按下/移动/抬起事件放入队列后调用通知回调
+ *   - 按住期间按 HGQ_TOUCH_ACTIVE_MS 跟踪到抬起，松开后永久阻塞，空闲不占 I2C 和 CPU
+ *   - 电阻屏 / OTT2001A 没有中断读取，Init 返回 1，调用者继续查询 tp_dev.scan
+ */
+#define HGQ_TOUCH_TASK_PRIO     5       /* 高于 UI 任务，读点不被界面刷新拖延 */
+#define HGQ_TOUCH_STK_SIZE      256
+#define HGQ_TOUCH_QUEUE_LEN     8
+#define HGQ_TOUCH_ACTIVE_MS     10      /* 按住期间的跟踪周期 */
+#define HGQ_TOUCH_STALE_MAX     10      /* 连续这么多个周期没有新数据视为已抬起 (防丢 UP) */
+#define HGQ_TOUCH_IRQ_PRIO      6       /* 中断里调用 FromISR，抢占优先级必须 >= 5 */
+
+typedef enum {
+    TOUCH_EV_DOWN = 0,
+    TOUCH_EV_MOVE,
+    TOUCH_EV_UP
+} HGQ_TouchEvType;
+
+typedef struct {
+    uint8_t  type;                  /* HGQ_TouchEvType */
+    uint8_t  n;                     /* 触点数，UP 时为 0，坐标保留最后位置 */
+    uint16_t x[CT_MAX_TOUCH];
+    uint16_t y[CT_MAX_TOUCH];
+    uint32_t t_irq;                 /* 触发本次读取的中断时刻 (tick)，超时跟踪时为读取时刻 */
+    uint32_t t_read;                /* 读完坐标的时刻 */
+} HGQ_TouchEvent;
+
+typedef struct {
+    uint32_t irqs;          /* INT 边沿数 */
+    uint32_t reads;         /* 连续读次数 */
+    uint32_t events;        /* 入队事件数 */
+    uint32_t dropped;       /* 队列满丢弃 */
+    uint32_t max_lat;       /* 中断到读完坐标的最长时间 (ms) */
+} HGQ_TouchStats;
+
+uint8_t HGQ_Touch_Init(void (*notify)(void));  /* 0 中断模式，1 不支持 (需查询) */
+uint8_t HGQ_Touch_Get(HGQ_TouchEvent *ev);      /* 不阻塞，1 取到事件 */
+void    HGQ_Touch_GetStats(HGQ_TouchStats *st);
+
+#endif
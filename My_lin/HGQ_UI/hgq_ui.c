@@ -1,6 +1,7 @@
 #include "hgq_ui.h"
 #include "lcd.h"
 #include "text.h"
+#include "hgq_widget.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -61,64 +62,45 @@ const u8 STR_ESP_CON[] = {0xC1,0xAC,0xBD,0xD3,0xD6,0xD0,0x00};
 const u8 STR_ESP_OK[]  = {0xD4,0xDA,0xCF,0xDF,0x00};
 const u8 STR_ESP_OFF[] = {0xC0,0xEB,0xCF,0xDF,0x00};
 
-/*  */
-static HGQ_UI_Data s_cache = {0};
-static char s_time_cache[10] = "";
-static u8 s_first_run = 1;
+/* ؼ ( HGQ_UI_DrawFramework аִ) */
+static u8 W_TIME, W_AREA, W_ESP;
+static u8 W_TEMP, W_HUMI, W_LUX;
+static u8 W_STATUS, W_USER, W_RES, W_START, W_REMAIN;
+static u8 W_BRI, W_BRI_UP, W_BRI_DN;
+static u8 W_BTN[4];
+static u8 s_built = 0;
 static int s_bri_now = 0;
 
-/* ť */
-static u16 btn_up_x1, btn_up_y1, btn_up_x2, btn_up_y2;
-static u16 btn_dn_x1, btn_dn_y1, btn_dn_x2, btn_dn_y2;
-
 void HGQ_UI_Init(void) {
+    /* ̶ֵĺֵԤ棬Ʋֶ W25Q128 */
+    static const u8 * const warm[] = {
+        STR_TITLE, STR_ENV, STR_SEAT, STR_LIGHT, STR_T, STR_H, STR_L,
+        STR_STAT, STR_USER, STR_RES_T, STR_START_T, STR_REM_T, STR_UNIT_C,
+        STR_CHECKIN, STR_CHECKOUT, STR_MODE_M, STR_MODE_A, STR_ON, STR_OFF,
+        STR_ESP_CON, STR_ESP_OK, STR_ESP_OFF
+    };
+    u8 i;
+    for(i = 0; i < sizeof(warm) / sizeof(warm[0]); i++) HZ_Cache_Prewarm(warm[i], 16);
     HGQ_UI_ResetCache();
 }
 
+/* ǵ˽棺һ֡ȫػ */
 void HGQ_UI_ResetCache(void) {
-    s_first_run = 1; 
     s_bri_now = 0;
-    memset(&s_cache, 0, sizeof(s_cache));
-    s_cache.esp_state = -1; 
-    s_time_cache[0] = 0;
+    HGQ_WG_InvalidateAll();
 }
 
 int HGQ_UI_GetBrightnessNow(void) { return s_bri_now; }
 
-/* ͼ */
-static void Show_Label(u16 x, u16 y, const u8* str) {
-    POINT_COLOR = UI_C_LABEL; BACK_COLOR = UI_C_CARD;
-    Show_Str(x, y, 200, 16, (u8*)str, 16, 0);
-}
-static void Show_Value_Str(u16 x, u16 y, u16 w, char* str, u16 color) {
-    LCD_Fill(x, y, x+w, y+16, UI_C_CARD);
-    POINT_COLOR = color; BACK_COLOR = UI_C_CARD;
-    Show_Str(x, y, w, 16, (u8*)str, 16, 0);
-}
-static void DrawBottomBtn(int idx, const u8* str, int active) {
-    u16 w = (lcddev.width - 5*GAP) / 4;
-    u16 x = GAP + idx * (w + GAP);
-    u16 y = lcddev.height - BOTTOM_H + GAP;
-    u16 h = BOTTOM_H - 2*GAP;
-    u16 color = active ? UI_C_BTN_ON : UI_C_BTN_OFF;
-    u16 tc = active ? WHITE : BLACK;
-    LCD_Fill(x, y, x+w, y+h, color);
-    POINT_COLOR = 0xCE79; LCD_DrawRectangle(x, y, x+w, y+h);
-    POINT_COLOR = tc; BACK_COLOR = color;
-    /* ־ */
-    u16 str_w = 0;
-    while(str[str_w]) str_w++; // 򵥹
-    str_w = (str_w > 6) ? 32 : 16; // 
-    Show_Str(x + (w-32)/2, y + (h-16)/2, 60, 16, (u8*)str, 16, 0);
-}
-static void DrawPlusMinusBtn(u16 x1, u16 y1, u16 x2, u16 y2, char* symbol) {
-    LCD_Fill(x1, y1, x2, y2, UI_C_BTN_OFF);
-    POINT_COLOR = 0xCE79; LCD_DrawRectangle(x1, y1, x2, y2);
-    POINT_COLOR = UI_C_ACCENT; BACK_COLOR = UI_C_BTN_OFF;
-    LCD_ShowString(x1+(x2-x1-8)/2, y1+(y2-y1-16)/2, 16, 16, 16, (u8*)symbol);
+/* ״̬ɫ +  */
+static void Draw_Esp(const HGQ_Widget *w) {
+    LCD_Fill(w->x, w->y, w->x + w->w - 1, w->y + w->h - 1, UI_C_TOP);
+    LCD_Fill(w->x, w->y + 5, w->x + 6, w->y + 11, w->fg);
+    POINT_COLOR = WHITE; BACK_COLOR = UI_C_TOP;
+    Show_Str(w->x + 10, w->y + 2, w->w - 10, 16, (u8*)w->val, 16, 0);
 }
 
-/*  */
+/*  (ֱӻڿؼϷرպ HGQ_UI_ResetCache ָ) */
 void HGQ_UI_ShowPopup(const char *msg) {
     u16 w = 240, h = 100;
     u16 x = (lcddev.width - w) / 2;
@@ -135,181 +117,136 @@ void HGQ_UI_ShowPopup(const char *msg) {
     Show_Str(x + 20, y + 42, 200, 16, (u8*)msg, 16, 0);
 }
 
-/* ================== 1. ̬ܻ ================== */
+/* ================== 1. ؼ () ================== */
 void HGQ_UI_DrawFramework(void) {
-    u16 x, y;
-    LCD_Clear(UI_C_BG);
-    LCD_Fill(0, 0, lcddev.width, TOP_H, UI_C_TOP);
-    
+    u8 root, top, card, i;
+    u16 x, y, w, h, cx;
+    u16 y_base = CARD_Y_START + 30;
+
+    HGQ_WG_Reset();
+    root = HGQ_WG_Card(HGQ_WG_NONE, 0, 0, lcddev.width, lcddev.height, UI_C_BG, 0, 0);
+
+    /*  */
+    top = HGQ_WG_Card(root, 0, 0, lcddev.width, TOP_H + 1, UI_C_TOP, 0, 0);
+    HGQ_WG_Label(top, 10, 7, 0, STR_TITLE, WHITE, UI_C_TOP);
+    W_TIME = HGQ_WG_Value(top, 115, 7, 41, WHITE, UI_C_TOP);
+    W_AREA = HGQ_WG_Value(top, lcddev.width - 140, 7, 80, WHITE, UI_C_TOP);
+    W_ESP  = HGQ_WG_Value(top, lcddev.width - 60, 5, 60, UI_C_WARN, UI_C_TOP);
+    HGQ_WG_Get(W_ESP)->h = 21;
+    HGQ_WG_SetDraw(W_ESP, Draw_Esp);
+
     /* 1. Ƭ */
-    x = GAP; LCD_Fill(x, CARD_Y_START, x+100, CARD_Y_START+CARD_H, UI_C_CARD);
-    POINT_COLOR = UI_C_ACCENT; BACK_COLOR = UI_C_CARD;
-    Show_Str(x+5, CARD_Y_START+5, 80, 16, (u8*)STR_ENV, 16, 0);
-    
-    y = CARD_Y_START + 30;
-    Show_Label(x+5, y, STR_T); 
-    Show_Label(x+5, y+30, STR_H); 
-    Show_Label(x+5, y+60, STR_L);
-    
+    x = GAP;
+    card = HGQ_WG_Card(root, x, CARD_Y_START, 101, CARD_H + 1, UI_C_CARD, STR_ENV, UI_C_ACCENT);
+    HGQ_WG_Label(card, x+5, y_base,    0, STR_T, UI_C_LABEL, UI_C_CARD);
+    HGQ_WG_Label(card, x+5, y_base+30, 0, STR_H, UI_C_LABEL, UI_C_CARD);
+    HGQ_WG_Label(card, x+5, y_base+60, 0, STR_L, UI_C_LABEL, UI_C_CARD);
+    W_TEMP = HGQ_WG_Value(card, x+50, y_base,    46, UI_C_TEXT, UI_C_CARD);
+    W_HUMI = HGQ_WG_Value(card, x+50, y_base+30, 46, UI_C_TEXT, UI_C_CARD);
+    W_LUX  = HGQ_WG_Value(card, x+50, y_base+60, 51, UI_C_TEXT, UI_C_CARD);
+
     /* 2. λƬ */
-    x = GAP + 100 + GAP; 
-    LCD_Fill(x, CARD_Y_START, x+120, CARD_Y_START+CARD_H, UI_C_CARD);
-    POINT_COLOR = UI_C_ACCENT; BACK_COLOR = UI_C_CARD;
-    Show_Str(x+5, CARD_Y_START+5, 80, 16, (u8*)STR_SEAT, 16, 0);
-    
-    y = CARD_Y_START + 30;
-    Show_Label(x+5, y, STR_STAT);       
-    Show_Label(x+5, y+25, STR_USER);    
-    Show_Label(x+5, y+50, STR_RES_T);   
-    Show_Label(x+5, y+75, STR_START_T); 
-    //Show_Label(x+5, y+100, STR_REM_T);  
+    x = GAP + 100 + GAP;
+    card = HGQ_WG_Card(root, x, CARD_Y_START, 121, CARD_H + 1, UI_C_CARD, STR_SEAT, UI_C_ACCENT);
+    HGQ_WG_Label(card, x+5, y_base,    0, STR_STAT,    UI_C_LABEL, UI_C_CARD);
+    HGQ_WG_Label(card, x+5, y_base+25, 0, STR_USER,    UI_C_LABEL, UI_C_CARD);
+    HGQ_WG_Label(card, x+5, y_base+50, 0, STR_RES_T,   UI_C_LABEL, UI_C_CARD);
+    HGQ_WG_Label(card, x+5, y_base+75, 0, STR_START_T, UI_C_LABEL, UI_C_CARD);
+    W_STATUS = HGQ_WG_Value(card, x+50, y_base,     61, UI_C_OK,     UI_C_CARD);
+    W_USER   = HGQ_WG_Value(card, x+50, y_base+25,  61, UI_C_TEXT,   UI_C_CARD);
+    W_RES    = HGQ_WG_Value(card, x+70, y_base+50,  46, UI_C_TEXT,   UI_C_CARD);
+    W_START  = HGQ_WG_Value(card, x+70, y_base+75,  46, UI_C_TEXT,   UI_C_CARD);
+    W_REMAIN = HGQ_WG_Value(card, x+70, y_base+100, 46, UI_C_ACCENT, UI_C_CARD);
 
     /* 3. ƹ⿨Ƭ */
-    x = GAP + 100 + GAP + 120 + GAP; 
-    u16 w_light = lcddev.width - x - GAP;
-    LCD_Fill(x, CARD_Y_START, lcddev.width-GAP, CARD_Y_START+CARD_H, UI_C_CARD);
-    POINT_COLOR = UI_C_ACCENT; BACK_COLOR = UI_C_CARD;
-    Show_Str(x+5, CARD_Y_START+5, 80, 16, (u8*)STR_LIGHT, 16, 0);
-    
-    u16 cx = x + w_light / 2;
-    btn_up_x1 = cx - 20; btn_up_x2 = cx + 20;
-    btn_up_y1 = CARD_Y_START + 35; btn_up_y2 = btn_up_y1 + 30;
-    DrawPlusMinusBtn(btn_up_x1, btn_up_y1, btn_up_x2, btn_up_y2, "+");
-    
-    btn_dn_x1 = cx - 20; btn_dn_x2 = cx + 20;
-    btn_dn_y1 = CARD_Y_START + 105; btn_dn_y2 = btn_dn_y1 + 30;
-    DrawPlusMinusBtn(btn_dn_x1, btn_dn_y1, btn_dn_x2, btn_dn_y2, "-");
-    
-    /*  */
-    POINT_COLOR = WHITE; BACK_COLOR = UI_C_TOP;
-    Show_Str(10, 7, 100, 16, (u8*)STR_TITLE, 16, 0);
-    
-    // ťʼ״̬ƣUpdateл
+    x = GAP + 100 + GAP + 120 + GAP;
+    w = lcddev.width - x - GAP;
+    cx = x + w / 2;
+    card = HGQ_WG_Card(root, x, CARD_Y_START, w + 1, CARD_H + 1, UI_C_CARD, STR_LIGHT, UI_C_ACCENT);
+    W_BRI_UP = HGQ_WG_Button(card, cx-20, CARD_Y_START+35,  41, 31, (const u8*)"+", UI_C_ACCENT, UI_C_ACCENT);
+    W_BRI    = HGQ_WG_Value(card, cx-15, CARD_Y_START+75, 31, 0xCE79, UI_C_CARD);
+    W_BRI_DN = HGQ_WG_Button(card, cx-20, CARD_Y_START+105, 41, 31, (const u8*)"-", UI_C_ACCENT, UI_C_ACCENT);
+    HGQ_WG_SetFlags(W_BRI, WG_F_CENTER, 0);
+
+    /* 4. ײťǩ/ǩˡģʽơص */
+    w = (lcddev.width - 5*GAP) / 4;
+    y = lcddev.height - BOTTOM_H + GAP;
+    h = BOTTOM_H - 2*GAP;
+    for(i = 0; i < 4; i++) {
+        W_BTN[i] = HGQ_WG_Button(root, GAP + i * (w + GAP), y, w + 1, h + 1, STR_CHECKIN, BLACK, UI_C_BTN_ON);
+    }
+
+    s_built = 1;
+    HGQ_WG_Render();
 }
 
-/* ================== 2. ̬ˢ ================== */
+/* ================== 2. ̬ˢ£ֻĿؼݣ HGQ_WG_Render ػ仯 ================== */
 void HGQ_UI_Update(HGQ_UI_Data *d, const char *time_str) {
-    u16 x_env = GAP; u16 x_seat = GAP + 100 + GAP; u16 y_base = CARD_Y_START + 30;
-    
-    POINT_COLOR = UI_C_TEXT; BACK_COLOR = UI_C_CARD;
+    char buf[HGQ_WG_TEXT_MAX];
+    u16 c;
+    u8 is_in_use;
+    if(!s_built) return;
 
     /*  */
-    /* ע⣺Щ޸ BACK_COLOR Ϊ UI_C_TOP ()ڻ궥ָɫ */
-    if(s_first_run) {
-        POINT_COLOR = WHITE; BACK_COLOR = UI_C_TOP;
-        Show_Str(lcddev.width-140, 7, 80, 16, (u8*)d->area_seat, 16, 0);
-    }
-    if(s_first_run || strcmp(time_str, s_time_cache) != 0) {
-        POINT_COLOR = WHITE; BACK_COLOR = UI_C_TOP;
-        LCD_Fill(115, 7, 115+40, 7+16, UI_C_TOP);
-        LCD_ShowString(115, 7, 40, 16, 16, (u8*)time_str);
-        strncpy(s_time_cache, time_str, sizeof(s_time_cache));
+    HGQ_WG_SetText(W_TIME, time_str);
+    HGQ_WG_SetText(W_AREA, d->area_seat);
+
+    /* 1.  */
+    sprintf(buf, "%2d.%d", d->temp_x10 / 10, abs(d->temp_x10 % 10));
+    strcat(buf, (const char*)STR_UNIT_C);
+    HGQ_WG_SetText(W_TEMP, buf);
+    sprintf(buf, "%d%%", d->humi);
+    HGQ_WG_SetText(W_HUMI, buf);
+    if(d->lux < 0) {
+        HGQ_WG_SetFg(W_LUX, RED);
+        HGQ_WG_SetText(W_LUX, "Err");
+    } else {
+        HGQ_WG_SetFg(W_LUX, UI_C_TEXT);
+        sprintf(buf, "%d%s", d->lux, (const char*)STR_UNIT_LUX);
+        HGQ_WG_SetText(W_LUX, buf);
     }
 
-    /* === ؼ޸ָɫãֹ·ʪʾ === */
-    POINT_COLOR = UI_C_TEXT; BACK_COLOR = UI_C_CARD;
-
-    /* 1. ݸ */
-    if(s_first_run || d->temp_x10 != s_cache.temp_x10) {
-        LCD_Fill(x_env+50, y_base, x_env+95, y_base+16, UI_C_CARD);
-        LCD_ShowNum(x_env+50, y_base, d->temp_x10/10, 2, 16);
-        LCD_ShowString(x_env+66, y_base, 8, 16, 16, (u8*)".");
-        LCD_ShowNum(x_env+74, y_base, d->temp_x10%10, 1, 16);
-        Show_Str(x_env+82, y_base, 16, 16, (u8*)STR_UNIT_C, 16, 0);
-    }
-    if(s_first_run || d->humi != s_cache.humi) {
-        LCD_Fill(x_env+50, y_base+30, x_env+95, y_base+46, UI_C_CARD);
-        LCD_ShowNum(x_env+50, y_base+30, d->humi, (d->humi>99?3:2), 16);
-        Show_Str(x_env+50+(d->humi>99?24:16), y_base+30, 16, 16, (u8*)STR_UNIT_PCT, 16, 0);
-    }
-    if(s_first_run || d->lux != s_cache.lux) {
-        LCD_Fill(x_env+50, y_base+60, x_env+100, y_base+76, UI_C_CARD);
-        if(d->lux < 0) {
-            POINT_COLOR = RED; LCD_ShowString(x_env+50, y_base+60, 40, 16, 16, (u8*)"Err");
-        } else {
-            POINT_COLOR = UI_C_TEXT;
-            u8 len = (d->lux>9999?5:(d->lux>999?4:(d->lux>99?3:(d->lux>9?2:1))));
-            LCD_ShowNum(x_env+50, y_base+60, d->lux, len, 16);
-            Show_Str(x_env+50+len*8, y_base+60, 24, 16, (u8*)STR_UNIT_LUX, 16, 0);
-        }
-    }
-
-    /* 2. λݸ */
-    if(s_first_run || strcmp(d->status, s_cache.status) != 0) {
-        u16 c = UI_C_OK; 
-        if(strstr(d->status, "In") || strstr(d->status, "Busy")) c = UI_C_ACCENT; 
-        else if(strstr(d->status, "Res") || strstr(d->status, "Book")) c = UI_C_WARN; 
-        Show_Value_Str(x_seat+50, y_base, 60, d->status, c);
-    }
-    if(s_first_run || strcmp(d->user_str, s_cache.user_str) != 0) {
-        Show_Value_Str(x_seat+50, y_base+25, 60, d->user_str, UI_C_TEXT);
-    }
-    if(s_first_run || strcmp(d->reserve_t, s_cache.reserve_t) != 0) {
-        Show_Value_Str(x_seat+70, y_base+50, 45, d->reserve_t, UI_C_TEXT);
-    }
-    if(s_first_run || strcmp(d->start_t, s_cache.start_t) != 0) {
-        Show_Value_Str(x_seat+70, y_base+75, 45, d->start_t, UI_C_TEXT);
-    }
-    if(s_first_run || strcmp(d->remain_t, s_cache.remain_t) != 0) {
-        Show_Value_Str(x_seat+70, y_base+100, 45, d->remain_t, UI_C_ACCENT);
-    }
-
-    /* 3. ƹ밴ť״̬ */
+    /* 2. λ */
+    c = UI_C_OK;
+    if(strstr(d->status, "In") || strstr(d->status, "Busy")) c = UI_C_ACCENT;
+    else if(strstr(d->status, "Res") || strstr(d->status, "Book")) c = UI_C_WARN;
+    HGQ_WG_SetFg(W_STATUS, c);
+    HGQ_WG_SetText(W_STATUS, d->status);
+    HGQ_WG_SetText(W_USER, d->user_str);
+    HGQ_WG_SetText(W_RES, d->reserve_t);
+    HGQ_WG_SetText(W_START, d->start_t);
+    HGQ_WG_SetText(W_REMAIN, d->remain_t);
+
+    /* 3. ƹȽ */
     if(s_bri_now < d->bri_target) s_bri_now += 2;
     if(s_bri_now > d->bri_target) s_bri_now -= 2;
     if(abs(s_bri_now - d->bri_target) < 2) s_bri_now = d->bri_target;
-    
-    if(s_first_run || s_bri_now != s_cache.bri_target || d->light_on != s_cache.light_on) {
-        u16 x_light = GAP + 100 + GAP + 120 + GAP;
-        u16 w_light = lcddev.width - x_light - GAP;
-        u16 cx = x_light + w_light / 2;
-        u16 val_y = CARD_Y_START + 75;
-        LCD_Fill(cx-15, val_y, cx+15, val_y+16, UI_C_CARD);
-        POINT_COLOR = d->light_on ? UI_C_ACCENT : 0xCE79; BACK_COLOR = UI_C_CARD;
-        LCD_ShowNum(cx-12, val_y, s_bri_now, 3, 16);
-    }
-    
-    /* ײťˢ */
-    /* ť0: ״̬ʾǩ/ǩ */
-    u8 is_in_use = (strstr(d->status, "In") != NULL);
-    if(s_first_run || is_in_use != (strstr(s_cache.status, "In")!=NULL)) {
-        DrawBottomBtn(0, is_in_use ? STR_CHECKOUT : STR_CHECKIN, 0); 
-    }
-    
-    if(s_first_run || d->auto_mode != s_cache.auto_mode) {
-        DrawBottomBtn(1, d->auto_mode ? STR_MODE_A : STR_MODE_M, d->auto_mode);
-    }
-    if(s_first_run || d->light_on != s_cache.light_on) {
-        DrawBottomBtn(2, STR_ON,   d->light_on);
-        DrawBottomBtn(3, STR_OFF, !d->light_on);
-    }
-    
-    /* 4. ״̬ͼ */
-    if(s_first_run || d->esp_state != s_cache.esp_state) {
-        u16 c = UI_C_WARN; const u8* s = STR_ESP_CON;
-        if(d->esp_state == 2) { c = UI_C_OK; s = STR_ESP_OK; }
-        else if(d->esp_state == 0) { c = RED; s = STR_ESP_OFF; }
-        LCD_Fill(lcddev.width-60, 10, lcddev.width-54, 16, c);
-        POINT_COLOR = WHITE; BACK_COLOR = UI_C_TOP;
-        LCD_Fill(lcddev.width-50, 5, lcddev.width, 25, UI_C_TOP);
-        Show_Str(lcddev.width-50, 7, 50, 16, (u8*)s, 16, 0);
-    }
-    
-    s_cache = *d; s_first_run = 0;
-}
-
-/* ж */
-static u8 IsIn(u16 x, u16 y, u16 x1, u16 y1, u16 x2, u16 y2) { return (x>=x1 && x<=x2 && y>=y1 && y<=y2); }
-static u8 IsBtn(u16 x, u16 y, int idx) {
-    u16 w = (lcddev.width - 5*GAP) / 4;
-    u16 x1 = GAP + idx * (w + GAP);
-    u16 y1 = lcddev.height - BOTTOM_H + GAP;
-    return IsIn(x, y, x1, y1, x1+w, y1+(BOTTOM_H - 2*GAP));
+    sprintf(buf, "%3d", s_bri_now);
+    HGQ_WG_SetFg(W_BRI, d->light_on ? UI_C_ACCENT : 0xCE79);
+    HGQ_WG_SetText(W_BRI, buf);
+
+    /* ײť */
+    is_in_use = (strstr(d->status, "In") != NULL);
+    HGQ_WG_SetLabel(W_BTN[0], is_in_use ? STR_CHECKOUT : STR_CHECKIN);
+    HGQ_WG_SetLabel(W_BTN[1], d->auto_mode ? STR_MODE_A : STR_MODE_M);
+    HGQ_WG_SetActive(W_BTN[1], d->auto_mode);
+    HGQ_WG_SetLabel(W_BTN[2], STR_ON);
+    HGQ_WG_SetActive(W_BTN[2], d->light_on);
+    HGQ_WG_SetLabel(W_BTN[3], STR_OFF);
+    HGQ_WG_SetActive(W_BTN[3], !d->light_on);
+
+    /* 4. ״̬ */
+    if(d->esp_state == 2)      { HGQ_WG_SetFg(W_ESP, UI_C_OK);   HGQ_WG_SetText(W_ESP, (const char*)STR_ESP_OK); }
+    else if(d->esp_state == 0) { HGQ_WG_SetFg(W_ESP, RED);       HGQ_WG_SetText(W_ESP, (const char*)STR_ESP_OFF); }
+    else                       { HGQ_WG_SetFg(W_ESP, UI_C_WARN); HGQ_WG_SetText(W_ESP, (const char*)STR_ESP_CON); }
+
+    HGQ_WG_Render();
 }
 
-u8 HGQ_UI_TouchBtn_Check(u16 x, u16 y) { return IsBtn(x, y, 0); }
-u8 HGQ_UI_TouchBtn_Mode(u16 x, u16 y)  { return IsBtn(x, y, 1); }
-u8 HGQ_UI_TouchBtn_On(u16 x, u16 y)    { return IsBtn(x, y, 2); }
-u8 HGQ_UI_TouchBtn_Off(u16 x, u16 y)   { return IsBtn(x, y, 3); }
-u8 HGQ_UI_TouchBtn_BriUp(u16 x, u16 y)   { return IsIn(x, y, btn_up_x1, btn_up_y1, btn_up_x2, btn_up_y2); }
-u8 HGQ_UI_TouchBtn_BriDown(u16 x, u16 y) { return IsIn(x, y, btn_dn_x1, btn_dn_y1, btn_dn_x2, btn_dn_y2); }
+/* жؼ߽ */
+u8 HGQ_UI_TouchBtn_Check(u16 x, u16 y) { return s_built && HGQ_WG_Hit(W_BTN[0], x, y); }
+u8 HGQ_UI_TouchBtn_Mode(u16 x, u16 y)  { return s_built && HGQ_WG_Hit(W_BTN[1], x, y); }
+u8 HGQ_UI_TouchBtn_On(u16 x, u16 y)    { return s_built && HGQ_WG_Hit(W_BTN[2], x, y); }
+u8 HGQ_UI_TouchBtn_Off(u16 x, u16 y)   { return s_built && HGQ_WG_Hit(W_BTN[3], x, y); }
+u8 HGQ_UI_TouchBtn_BriUp(u16 x, u16 y)   { return s_built && HGQ_WG_Hit(W_BRI_UP, x, y); }
+u8 HGQ_UI_TouchBtn_BriDown(u16 x, u16 y) { return s_built && HGQ_WG_Hit(W_BRI_DN, x, y); }
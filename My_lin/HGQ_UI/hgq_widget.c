@@ -0,0 +1,321 @@
+#include "hgq_widget.h"
+#include "lcd.h"
+#include "text.h"
+#include <string.h>
+
+#define WG_BORDER_COLOR 0xCE79
+
+typedef struct { u16 x0, y0, x1, y1; } WG_Rect;    /* 闭区间 */
+
+static HGQ_Widget   s_wg[HGQ_WG_MAX];
+static u8           s_num = 0;
+static WG_Rect      s_rect[HGQ_WG_RECT_MAX];
+static u8           s_nrect = 0;
+static HGQ_WG_Stats s_stats = {0};
+
+/* ---------- 矩形 ---------- */
+static WG_Rect Wg_Bounds(const HGQ_Widget *w)
+{
+    WG_Rect r;
+    r.x0 = w->x; r.y0 = w->y;
+    r.x1 = w->x + w->w - 1; r.y1 = w->y + w->h - 1;
+    return r;
+}
+
+static u8 Rect_Near(const WG_Rect *a, const WG_Rect *b, u16 gap)
+{
+    return a->x0 <= b->x1 + gap && b->x0 <= a->x1 + gap &&
+           a->y0 <= b->y1 + gap && b->y0 <= a->y1 + gap;
+}
+
+static WG_Rect Rect_Union(const WG_Rect *a, const WG_Rect *b)
+{
+    WG_Rect r;
+    r.x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    r.y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    r.x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    r.y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+    return r;
+}
+
+static u32 Rect_Area(const WG_Rect *r)
+{
+    return (u32)(r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1);
+}
+
+/* 加入本帧区域表：与已有矩形相邻/重叠就合并 (合并后可能再碰到别的，循环到稳定)；
+ * 表满时并入面积增量最小的那个 */
+static void Rect_Add(WG_Rect r)
+{
+    u8 i, merged = 1;
+    while(merged) {
+        merged = 0;
+        for(i = 0; i < s_nrect; i++) {
+            if(Rect_Near(&s_rect[i], &r, HGQ_WG_MERGE_GAP)) {
+                r = Rect_Union(&s_rect[i], &r);
+                s_rect[i] = s_rect[--s_nrect];
+                merged = 1;
+                break;
+            }
+        }
+    }
+    if(s_nrect < HGQ_WG_RECT_MAX) {
+        s_rect[s_nrect++] = r;
+    } else {
+        u8 best = 0;
+        u32 best_grow = 0xFFFFFFFF;
+        for(i = 0; i < s_nrect; i++) {
+            WG_Rect u = Rect_Union(&s_rect[i], &r);
+            u32 grow = Rect_Area(&u) - Rect_Area(&s_rect[i]);
+            if(grow < best_grow) { best_grow = grow; best = i; }
+        }
+        s_rect[best] = Rect_Union(&s_rect[best], &r);
+    }
+}
+
+static u8 Rect_Hit(const WG_Rect *r)
+{
+    u8 i;
+    for(i = 0; i < s_nrect; i++) if(Rect_Near(&s_rect[i], r, 0)) return 1;
+    return 0;
+}
+
+/* ---------- 默认绘制 ---------- */
+static u16 Text_W(const char *s)
+{
+    return (u16)strlen(s) * 8;          /* 16 号字：ASCII 8 像素，汉字两个字节 16 像素 */
+}
+
+static void Wg_Text(const HGQ_Widget *w, u16 x, u16 y, u16 maxw, const char *s, u16 fg, u16 bg)
+{
+    if(w->flags & WG_F_CENTER) {
+        u16 tw = Text_W(s);
+        if(tw < maxw) x += (maxw - tw) / 2;
+    }
+    POINT_COLOR = fg; BACK_COLOR = bg;
+    Show_Str(x, y, maxw, 16, (u8 *)s, 16, 0);
+}
+
+static void Wg_DrawDefault(const HGQ_Widget *w)
+{
+    u16 x1 = w->x + w->w - 1, y1 = w->y + w->h - 1;
+    switch(w->type) {
+    case WG_CARD:
+        LCD_Fill(w->x, w->y, x1, y1, w->bg);
+        if(w->text) Wg_Text(w, w->x + 5, w->y + 5, w->w > 10 ? w->w - 10 : w->w, (const char *)w->text, w->fg, w->bg);
+        break;
+    case WG_LABEL:
+        LCD_Fill(w->x, w->y, x1, y1, w->bg);
+        Wg_Text(w, w->x, w->y, w->w, (const char *)w->text, w->fg, w->bg);
+        break;
+    case WG_VALUE:
+        LCD_Fill(w->x, w->y, x1, y1, w->bg);
+        Wg_Text(w, w->x, w->y, w->w, w->val, w->fg, w->bg);
+        break;
+    case WG_BUTTON: {
+        u8  on = (w->flags & WG_F_ACTIVE) != 0;
+        u16 bg = on ? w->act : w->bg;
+        const char *s = w->text ? (const char *)w->text : w->val;
+        LCD_Fill(w->x, w->y, x1, y1, bg);
+        POINT_COLOR = WG_BORDER_COLOR; LCD_DrawRectangle(w->x, w->y, x1, y1);
+        Wg_Text(w, w->x + 1, w->y + (w->h - 16) / 2, w->w - 2, s, on ? WHITE : w->fg, bg);
+        break;
+    }
+    }
+}
+
+/* ---------- 创建 ---------- */
+void HGQ_WG_Reset(void)
+{
+    s_num = 0;
+    s_nrect = 0;
+}
+
+static u8 Wg_New(u8 type, u8 parent, u16 x, u16 y, u16 w, u16 h, u16 fg, u16 bg)
+{
+    HGQ_Widget *p;
+    if(s_num >= HGQ_WG_MAX) return HGQ_WG_NONE;
+    p = &s_wg[s_num];
+    memset(p, 0, sizeof(*p));
+    p->type = type; p->parent = parent;
+    p->x = x; p->y = y; p->w = w ? w : 1; p->h = h ? h : 1;
+    p->fg = fg; p->bg = bg;
+    p->flags = WG_F_DIRTY;
+    if(parent < s_num) s_wg[parent].is_parent = 1;
+    return s_num++;
+}
+
+u8 HGQ_WG_Card(u8 parent, u16 x, u16 y, u16 w, u16 h, u16 bg, const u8 *title, u16 title_fg)
+{
+    u8 id = Wg_New(WG_CARD, parent, x, y, w, h, title_fg, bg);
+    if(id != HGQ_WG_NONE) s_wg[id].text = title;
+    return id;
+}
+
+u8 HGQ_WG_Label(u8 parent, u16 x, u16 y, u16 w, const u8 *text, u16 fg, u16 bg)
+{
+    u8 id = Wg_New(WG_LABEL, parent, x, y, w ? w : Text_W((const char *)text), 16, fg, bg);
+    if(id != HGQ_WG_NONE) s_wg[id].text = text;
+    return id;
+}
+
+u8 HGQ_WG_Value(u8 parent, u16 x, u16 y, u16 w, u16 fg, u16 bg)
+{
+    return Wg_New(WG_VALUE, parent, x, y, w, 16, fg, bg);
+}
+
+/* 按钮未选中为白底 fg 色字，选中为 act 底白字 */
+u8 HGQ_WG_Button(u8 parent, u16 x, u16 y, u16 w, u16 h, const u8 *text, u16 fg, u16 act)
+{
+    u8 id = Wg_New(WG_BUTTON, parent, x, y, w, h, fg, WHITE);
+    if(id != HGQ_WG_NONE) { s_wg[id].text = text; s_wg[id].act = act; s_wg[id].flags |= WG_F_CENTER; }
+    return id;
+}
+
+HGQ_Widget *HGQ_WG_Get(u8 id)
+{
+    return id < s_num ? &s_wg[id] : 0;
+}
+
+/* ---------- 修改 ---------- */
+void HGQ_WG_SetText(u8 id, const char *s)
+{
+    if(id >= s_num || strncmp(s_wg[id].val, s, HGQ_WG_TEXT_MAX - 1) == 0) return;
+    strncpy(s_wg[id].val, s, HGQ_WG_TEXT_MAX - 1);
+    s_wg[id].val[HGQ_WG_TEXT_MAX - 1] = 0;
+    s_wg[id].flags |= WG_F_DIRTY;
+}
+
+void HGQ_WG_SetLabel(u8 id, const u8 *text)
+{
+    if(id >= s_num || s_wg[id].text == text) return;
+    s_wg[id].text = text;
+    s_wg[id].flags |= WG_F_DIRTY;
+}
+
+void HGQ_WG_SetFg(u8 id, u16 fg)
+{
+    if(id >= s_num || s_wg[id].fg == fg) return;
+    s_wg[id].fg = fg;
+    s_wg[id].flags |= WG_F_DIRTY;
+}
+
+void HGQ_WG_SetActive(u8 id, u8 on)
+{
+    HGQ_WG_SetFlags(id, on ? WG_F_ACTIVE : 0, on ? 0 : WG_F_ACTIVE);
+}
+
+void HGQ_WG_SetFlags(u8 id, u8 set, u8 clr)
+{
+    u8 f;
+    if(id >= s_num) return;
+    f = (s_wg[id].flags & ~clr) | set;
+    if((f ^ s_wg[id].flags) & ~WG_F_DIRTY) s_wg[id].flags = f | WG_F_DIRTY;
+}
+
+void HGQ_WG_SetDraw(u8 id, HGQ_WidgetDraw draw)
+{
+    if(id >= s_num) return;
+    s_wg[id].draw = draw;
+    s_wg[id].flags |= WG_F_DIRTY;
+}
+
+void HGQ_WG_Invalidate(u8 id)
+{
+    if(id < s_num) s_wg[id].flags |= WG_F_DIRTY;
+}
+
+void HGQ_WG_InvalidateAll(void)
+{
+    u8 i;
+    for(i = 0; i < s_num; i++) s_wg[i].flags |= WG_F_DIRTY;
+}
+
+u8 HGQ_WG_Hit(u8 id, u16 x, u16 y)
+{
+    const HGQ_Widget *w;
+    if(id >= s_num) return 0;
+    w = &s_wg[id];
+    if(w->flags & WG_F_HIDDEN) return 0;
+    return x >= w->x && x < w->x + w->w && y >= w->y && y < w->y + w->h;
+}
+
+/* ---------- 刷新 ---------- */
+static u32 Cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+static void Wg_DirtyChildren(u8 id)
+{
+    u8 k;
+    for(k = id + 1; k < s_num; k++) if(s_wg[k].parent == id) s_wg[k].flags |= WG_F_DIRTY;
+}
+
+/* 控件刚被隐藏：它的矩形并入区域表，压在下面的普通控件随之重画；容器不因区域相交重画，
+ * 所以往下找与它相交的容器置脏，找到完全包住它的那个为止 (更下面的被这个盖住) */
+static void Wg_Uncover(u8 id)
+{
+    WG_Rect r = Wg_Bounds(&s_wg[id]), c;
+    u8 j = id;
+
+    Rect_Add(r);
+    while(j--) {
+        HGQ_Widget *w = &s_wg[j];
+        if(!w->is_parent || (w->flags & WG_F_HIDDEN)) continue;
+        c = Wg_Bounds(w);
+        if(!Rect_Near(&c, &r, 0)) continue;
+        w->flags |= WG_F_DIRTY;
+        if(c.x0 <= r.x0 && c.y0 <= r.y0 && c.x1 >= r.x1 && c.y1 >= r.y1) break;
+    }
+}
+
+u8 HGQ_WG_Render(void)
+{
+    u8 i, drawn = 0;
+    u32 px = 0, t0;
+
+    /* 1. 本帧脏区域 (刚隐藏的控件先把它露出的区域交给下面的控件) */
+    s_nrect = 0;
+    for(i = 0; i < s_num; i++) {
+        if(!(s_wg[i].flags & WG_F_HIDDEN)) continue;
+        if(s_wg[i].flags & WG_F_SHOWN) Wg_Uncover(i);
+        s_wg[i].flags &= ~(WG_F_DIRTY | WG_F_SHOWN);
+    }
+    for(i = 0; i < s_num; i++) {
+        if((s_wg[i].flags & (WG_F_DIRTY | WG_F_HIDDEN)) == WG_F_DIRTY) Rect_Add(Wg_Bounds(&s_wg[i]));
+    }
+    if(s_nrect == 0) return 0;
+    s_stats.rects = s_nrect;
+
+    /* 2. 按 z 序重画与区域相交的控件。重画的控件会盖住自己整个矩形，
+     *    所以把它的矩形并入区域表，后面压在它上面的控件也随之重画 */
+    t0 = Cycles();
+    for(i = 0; i < s_num; i++) {
+        HGQ_Widget *w = &s_wg[i];
+        WG_Rect r;
+        if(w->flags & WG_F_HIDDEN) continue;
+        r = Wg_Bounds(w);
+        if(!(w->flags & WG_F_DIRTY)) {
+            if(w->is_parent || !Rect_Hit(&r)) continue;     /* 容器不因子控件变化重画 */
+        }
+        if(w->draw) w->draw(w); else Wg_DrawDefault(w);
+        w->flags = (w->flags & ~WG_F_DIRTY) | WG_F_SHOWN;
+        if(w->is_parent) Wg_DirtyChildren(i);  /* 底色盖掉了子控件，子容器不会因区域相交重画 */
+        Rect_Add(r);
+        px += Rect_Area(&r);
+        drawn++;
+    }
+    s_stats.us = (Cycles() - t0) / (SystemCoreClock / 1000000);
+    if(s_stats.us > s_stats.max_us) s_stats.max_us = s_stats.us;
+    s_stats.widgets = drawn;
+    s_stats.pixels = px;
+    s_stats.total_pixels += px;
+    s_stats.frames++;
+    return drawn;
+}
+
+void HGQ_WG_GetStats(HGQ_WG_Stats *st)
+{
+    *st = s_stats;
+}
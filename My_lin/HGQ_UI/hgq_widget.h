@@ -0,0 +1,79 @@
+#ifndef __HGQ_WIDGET_H
+#define __HGQ_WIDGET_H
+
+#include "stm32f4xx.h"
+
+/*
+ * 保留模式控件树 + 脏矩形刷新
+ *   - 控件按创建顺序存放，即绘制顺序 (z 序)，父控件必须先于子控件创建
+ *   - 每个控件绘制时覆盖自己的整个矩形 (不透明)，修改内容只置脏标志，不立即画
+ *   - HGQ_WG_Render 收集脏控件矩形并合并，重画与这些区域相交的控件；
+ *     卡片等容器只有自身变脏才重画，子控件变化不会带动整张卡片；容器重画时它的子控件一并重画
+ *   - 隐藏控件 (WG_F_HIDDEN) 时，它露出的区域由下面的控件补画，压在下面的容器整个重画
+ */
+#define HGQ_WG_MAX          40      /* 控件池大小 */
+#define HGQ_WG_TEXT_MAX     24      /* 动态文字长度 (含结尾 0) */
+#define HGQ_WG_RECT_MAX     8       /* 每帧最多保留的合并后矩形数，超出时并入增量最小的一个 */
+#define HGQ_WG_MERGE_GAP    4       /* 间距不超过此值的两个矩形直接合并 */
+#define HGQ_WG_NONE         0xFF    /* 无父控件 / 创建失败 */
+
+typedef enum {
+    WG_CARD = 0,        /* 容器：底色 + 可选标题 */
+    WG_LABEL,           /* 固定文字 */
+    WG_VALUE,           /* 动态文字 */
+    WG_BUTTON           /* 带边框的按钮，active 时反色 */
+} HGQ_WidgetType;
+
+#define WG_F_DIRTY      0x01
+#define WG_F_HIDDEN     0x02
+#define WG_F_CENTER     0x04    /* 文字水平居中 */
+#define WG_F_ACTIVE     0x08    /* 按钮按下/选中 */
+#define WG_F_SHOWN      0x10    /* 内部：画过且还没隐藏，隐藏时据此补画它露出的区域 */
+
+typedef struct HGQ_Widget HGQ_Widget;
+typedef void (*HGQ_WidgetDraw)(const HGQ_Widget *w);
+
+struct HGQ_Widget {
+    u16 x, y, w, h;             /* 边界 (w/h 为像素数) */
+    u16 fg, bg;
+    u16 act;                    /* 按钮选中时的底色 (文字转白) */
+    u8  type;
+    u8  flags;
+    u8  parent;
+    u8  is_parent;              /* 有子控件，按容器规则重画 */
+    const u8 *text;             /* 固定文字 (GBK)，卡片标题 / 标签 / 按钮 */
+    char val[HGQ_WG_TEXT_MAX];  /* 动态文字 (GBK) */
+    HGQ_WidgetDraw draw;        /* 自定义绘制，NULL 用类型默认绘制 */
+};
+
+typedef struct {
+    u32 frames;         /* 实际画过东西的帧数 */
+    u16 rects;          /* 上一帧合并后的脏矩形数 */
+    u16 widgets;        /* 上一帧重画的控件数 */
+    u32 pixels;         /* 上一帧重画的像素数 */
+    u32 us;             /* 上一帧绘制耗时 */
+    u32 max_us;         /* 最长一帧 */
+    u32 total_pixels;   /* 累计像素 */
+} HGQ_WG_Stats;
+
+void HGQ_WG_Reset(void);
+u8   HGQ_WG_Card(u8 parent, u16 x, u16 y, u16 w, u16 h, u16 bg, const u8 *title, u16 title_fg);
+u8   HGQ_WG_Label(u8 parent, u16 x, u16 y, u16 w, const u8 *text, u16 fg, u16 bg);
+u8   HGQ_WG_Value(u8 parent, u16 x, u16 y, u16 w, u16 fg, u16 bg);
+u8   HGQ_WG_Button(u8 parent, u16 x, u16 y, u16 w, u16 h, const u8 *text, u16 fg, u16 act);
+HGQ_Widget *HGQ_WG_Get(u8 id);
+
+void HGQ_WG_SetText(u8 id, const char *s);      /* 文字变化才置脏 */
+void HGQ_WG_SetLabel(u8 id, const u8 *text);    /* 换固定文字 (指针比较) */
+void HGQ_WG_SetFg(u8 id, u16 fg);
+void HGQ_WG_SetActive(u8 id, u8 on);
+void HGQ_WG_SetFlags(u8 id, u8 set, u8 clr);
+void HGQ_WG_SetDraw(u8 id, HGQ_WidgetDraw draw);
+void HGQ_WG_Invalidate(u8 id);
+void HGQ_WG_InvalidateAll(void);
+u8   HGQ_WG_Hit(u8 id, u16 x, u16 y);
+
+u8   HGQ_WG_Render(void);                       /* 返回本帧重画的控件数 */
+void HGQ_WG_GetStats(HGQ_WG_Stats *st);
+
+#endif
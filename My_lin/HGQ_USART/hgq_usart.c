@@ -1,17 +1,160 @@
 #include "hgq_usart.h"
 #include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "semphr.h"
 #include <stdio.h>
+#include <string.h>
 
-/* 定义大缓冲区，防止WIFI长数据溢出 */
-#define RX_BUF_SIZE 1024 
+/*
+ * USART2 接收链路 (ESP8266)：
+ *   USART2_RX --DMA1_Stream5/CH4 循环--> s_dma_rx[] --IDLE/HT/TC中断--> 流缓冲区 --> net_task
+ * 每个数据块只进一次中断，整行到达 (空闲线) 即唤醒读取任务，不再按字节中断。
+ * USART2 发送链路：
+ *   调用者 --拷贝--> s_tx_ring[] --DMA1_Stream6/CH4--> USART2_TX，传输完成中断续传下一段
+ * 注意：中断里调用 FromISR 接口，抢占优先级必须 >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY (5)
+ */
+#define USART2_RX_IRQ_PRIO   6
+#define USART2_TX_IRQ_PRIO   6
 
-typedef struct {
-    uint8_t buf[RX_BUF_SIZE];
-    volatile uint16_t head;
-    volatile uint16_t tail;
-} RingBuf;
+/* 毫秒转节拍，portMAX_DELAY 原样保留 (pdMS_TO_TICKS 会溢出) */
+#define MS_TO_TICKS(ms)  ((ms) == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(ms))
 
-static RingBuf rb2 = {0}; // 用于 ESP8266
+static uint8_t s_dma_rx[HGQ_USART2_DMA_RX_SIZE];
+static uint16_t s_dma_last = 0;                 /* 上次搬运到的位置 */
+static StreamBufferHandle_t s_rx_sb = NULL;
+static HGQ_USART2_RxStats s_rx_stats = {0};
+static TaskHandle_t s_rx_notify = NULL;         /* 可选：数据到达时通知的任务 */
+static uint8_t s_err_muted = 0;                 /* FE/NE 后暂时关掉的错误中断，DMA 取走那个字节后再开 */
+
+static uint8_t s_tx_ring[HGQ_USART2_TXBUF_SIZE];
+static volatile uint16_t s_tx_head = 0;         /* 写入位置 (任务) */
+static volatile uint16_t s_tx_tail = 0;         /* 发送位置 (DMA) */
+static volatile uint16_t s_tx_dma_len = 0;      /* 正在发送的段长，0 = DMA 空闲 */
+static SemaphoreHandle_t s_tx_sem = NULL;       /* 每段发送完成释放一次 */
+static HGQ_USART_TxDoneCallback s_tx_done_cb = NULL;
+
+/* 把 [from, to) 一段推入流缓冲区 (仅中断上下文调用) */
+static void Rx_PushISR(uint16_t from, uint16_t to, BaseType_t *woken)
+{
+    size_t len = to - from, sent;
+    if(len == 0) return;
+    sent = xStreamBufferSendFromISR(s_rx_sb, &s_dma_rx[from], len, woken);
+    s_rx_stats.rx_bytes += sent;
+    if(sent < len) s_rx_stats.overrun += len - sent;
+}
+
+/* 按 DMA 当前写指针搬运新数据，IDLE / 半满 / 全满 共用 */
+static void Rx_DrainISR(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint16_t pos = HGQ_USART2_DMA_RX_SIZE - DMA_GetCurrDataCounter(DMA1_Stream5);
+    size_t level;
+
+    if(pos == s_dma_last) return;
+    if(pos > s_dma_last) {
+        Rx_PushISR(s_dma_last, pos, &woken);
+    } else { /* 回绕 */
+        Rx_PushISR(s_dma_last, HGQ_USART2_DMA_RX_SIZE, &woken);
+        Rx_PushISR(0, pos, &woken);
+    }
+    s_dma_last = (pos >= HGQ_USART2_DMA_RX_SIZE) ? 0 : pos;
+    s_rx_stats.rx_chunks++;
+
+    level = xStreamBufferBytesAvailable(s_rx_sb);
+    if(level > s_rx_stats.high_water) s_rx_stats.high_water = (uint16_t)level;
+    if(s_rx_notify) vTaskNotifyGiveFromISR(s_rx_notify, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void USART2_RxDMA_Init(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    DMA_DeInit(DMA1_Stream5);
+    while(DMA_GetCmdStatus(DMA1_Stream5) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = DMA_Channel_4;                 /* USART2_RX */
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)s_dma_rx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = HGQ_USART2_DMA_RX_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(DMA1_Stream5, &DMA_InitStructure);
+
+    DMA_ITConfig(DMA1_Stream5, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    USART_DMACmd(USART2, USART_DMAReq_Rx, ENABLE);
+    DMA_Cmd(DMA1_Stream5, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Stream5_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = USART2_RX_IRQ_PRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/* 启动下一段 DMA 发送 (临界区或中断中调用)，环形队列回绕时分两段发 */
+static void Tx_Kick(void)
+{
+    uint16_t head = s_tx_head, tail = s_tx_tail, len;
+    if(s_tx_dma_len != 0 || head == tail) return;
+    len = (head > tail) ? (head - tail) : (HGQ_USART2_TXBUF_SIZE - tail);
+    s_tx_dma_len = len;
+    DMA_ClearFlag(DMA1_Stream6, DMA_FLAG_TCIF6 | DMA_FLAG_HTIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_FEIF6);
+    DMA1_Stream6->M0AR = (uint32_t)&s_tx_ring[tail];
+    DMA1_Stream6->NDTR = len;
+    DMA_Cmd(DMA1_Stream6, ENABLE);
+}
+
+static void USART2_TxDMA_Init(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    if(s_tx_sem == NULL) s_tx_sem = xSemaphoreCreateBinary();
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    DMA_DeInit(DMA1_Stream6);
+    while(DMA_GetCmdStatus(DMA1_Stream6) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = DMA_Channel_4;                 /* USART2_TX */
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)s_tx_ring;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(DMA1_Stream6, &DMA_InitStructure);
+
+    DMA_ITConfig(DMA1_Stream6, DMA_IT_TC, ENABLE);
+    USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Stream6_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = USART2_TX_IRQ_PRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
 
 /* 初始化 USART2 (PA2/PA3) */
 void HGQ_USART2_Init(uint32_t bound) {
@@ -19,6 +162,9 @@ void HGQ_USART2_Init(uint32_t bound) {
     USART_InitTypeDef USART_InitStructure;
     NVIC_InitTypeDef NVIC_InitStructure;
 
+    /* 流缓冲区：触发水位 1 字节，任何数据到达都会唤醒读取任务 */
+    if(s_rx_sb == NULL) s_rx_sb = xStreamBufferCreate(HGQ_USART2_RXBUF_SIZE, 1);
+
     RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA, ENABLE);
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
 
@@ -39,53 +185,168 @@ void HGQ_USART2_Init(uint32_t bound) {
     USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
     USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
     USART_Init(USART2, &USART_InitStructure);
-    
-    /* 开启接收中断 */
-    USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+
+    USART2_RxDMA_Init();
+    USART2_TxDMA_Init();
+
+    /* 只开空闲线和错误中断，数据由 DMA 搬运；DMA 取数不及时产生的 ORE 靠错误中断计数 */
+    USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
+    USART_ITConfig(USART2, USART_IT_ERR, ENABLE);
     USART_Cmd(USART2, ENABLE);
 
     NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0; // 最高优先级
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = USART2_RX_IRQ_PRIO;
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 }
 
-void HGQ_USART2_SendString(char *str) {
-    while(*str) {
-        while((USART2->SR & 0x40) == 0); // 等待发送完成
-        USART2->DR = *str++;
+uint16_t HGQ_USART2_TxFree(void) {
+    uint16_t used = (uint16_t)((s_tx_head + HGQ_USART2_TXBUF_SIZE - s_tx_tail) % HGQ_USART2_TXBUF_SIZE);
+    return HGQ_USART2_TXBUF_SIZE - 1 - used;
+}
+
+/* 异步发送：拷入发送队列后立即返回，只有队列满时才等待 DMA 腾出空间 */
+uint16_t HGQ_USART2_Write(const uint8_t *data, uint16_t len, uint32_t timeout_ms) {
+    TickType_t start = xTaskGetTickCount(), wait = MS_TO_TICKS(timeout_ms);
+    uint16_t done = 0;
+
+    while(done < len) {
+        uint16_t n, head, first;
+
+        taskENTER_CRITICAL();
+        n = HGQ_USART2_TxFree();
+        if(n > len - done) n = len - done;
+        head = s_tx_head;
+        first = HGQ_USART2_TXBUF_SIZE - head;
+        if(first > n) first = n;
+        memcpy(&s_tx_ring[head], data + done, first);
+        memcpy(&s_tx_ring[0], data + done + first, n - first);
+        s_tx_head = (uint16_t)((head + n) % HGQ_USART2_TXBUF_SIZE);
+        done += n;
+        Tx_Kick();
+        taskEXIT_CRITICAL();
+
+        if(done < len) {
+            TickType_t used = xTaskGetTickCount() - start;
+            if(used >= wait) break;
+            xSemaphoreTake(s_tx_sem, wait - used);
+        }
     }
+    return done;
+}
+
+/* 等待发送队列清空 (如复位模块前)，1=完成 0=超时 */
+uint8_t HGQ_USART2_TxFlush(uint32_t timeout_ms) {
+    TickType_t start = xTaskGetTickCount(), wait = MS_TO_TICKS(timeout_ms);
+    while(s_tx_dma_len != 0 || s_tx_head != s_tx_tail) {
+        if(xTaskGetTickCount() - start >= wait) return 0;
+        xSemaphoreTake(s_tx_sem, 2); /* 信号量可能被写入方取走，短超时兜底 */
+    }
+    while((USART2->SR & USART_FLAG_TC) == 0); /* 最后一个字节移出移位寄存器，最多 ~87us */
+    return 1;
+}
+
+void HGQ_USART2_SetTxDoneCallback(HGQ_USART_TxDoneCallback cb) { s_tx_done_cb = cb; }
+
+void HGQ_USART2_SendChar(uint8_t ch) {
+    HGQ_USART2_Write(&ch, 1, portMAX_DELAY);
+}
+
+void HGQ_USART2_SendString(char *str) {
+    HGQ_USART2_Write((const uint8_t *)str, (uint16_t)strlen(str), portMAX_DELAY);
 }
 
 /* 兼容接口：实际上不做事，只为了编译通过 */
 void HGQ_USART2_SetRxCallback(void (*cb)(uint8_t)) { (void)cb; }
 void HGQ_USART2_EnableRxIRQ(FunctionalState en) { 
-    USART_ITConfig(USART2, USART_IT_RXNE, en); 
+    USART_ITConfig(USART2, USART_IT_IDLE, en); 
+    USART_ITConfig(USART2, USART_IT_ERR, en);
+    s_err_muted = 0;
 }
 
-/* 核心：从缓冲区取一个字节 (非阻塞) */
+/* 阻塞读取：最多等待 timeout_ms，有数据立即返回实际字节数 */
+uint16_t HGQ_USART2_Read(uint8_t *buf, uint16_t len, uint32_t timeout_ms) {
+    return (uint16_t)xStreamBufferReceive(s_rx_sb, buf, len, MS_TO_TICKS(timeout_ms));
+}
+
+/* 读取方需要同时等待其他事件 (如命令队列) 时，用任务通知代替阻塞在流缓冲区上 */
+void HGQ_USART2_SetRxNotify(void *task) {
+    s_rx_notify = (TaskHandle_t)task;
+}
+
+void HGQ_USART2_GetRxStats(HGQ_USART2_RxStats *st) {
+    taskENTER_CRITICAL();
+    *st = s_rx_stats;
+    taskEXIT_CRITICAL();
+}
+
+/* 从缓冲区取一个字节 (非阻塞) */
 int HGQ_USART2_IT_GetChar(uint8_t *ch) {
-    if(rb2.head == rb2.tail) return 0; // 空
-    *ch = rb2.buf[rb2.tail];
-    rb2.tail = (rb2.tail + 1) % RX_BUF_SIZE;
-    return 1;
+    return xStreamBufferReceive(s_rx_sb, ch, 1, 0) == 1;
 }
 
+/* 读空缓冲区 (其他任务可能阻塞在流缓冲区上，不能用 xStreamBufferReset) */
 void HGQ_USART2_IT_ClearRxBuffer(void) {
-    rb2.head = rb2.tail = 0;
+    uint8_t tmp[32];
+    while(xStreamBufferReceive(s_rx_sb, tmp, sizeof(tmp), 0) > 0);
+}
+
+/* 错误中断在 FE/NE 后关掉过：DMA 已经取走那个字节 (标志随之清除)，重新打开 */
+static void Rx_ErrUnmuteISR(void)
+{
+    if(s_err_muted) {
+        s_err_muted = 0;
+        USART_ITConfig(USART2, USART_IT_ERR, ENABLE);
+    }
 }
 
-/* 中断服务函数：极速存入缓冲区 */
+/* 中断服务函数：空闲线 = 一段数据结束，立即搬运
+ * 连续收数据没有空闲线时，ORE/FE/NE 由错误中断 (EIE) 进来：
+ *   - IDLE/ORE 读 SR 再读 DR 清除 (ORE 时 DR 里那个字节已经作废)
+ *   - FE/NE 时出错的字节还在 DR 里等 DMA 取，CPU 不能读，只计数；DMA 读 DR 时标志清除，
+ *     在那之前错误中断会一直挂着，先关掉，到 DMA 半满/全满或空闲线时再打开 */
 void USART2_IRQHandler(void) {
-    if(USART_GetITStatus(USART2, USART_IT_RXNE) != RESET) {
-        uint8_t res = USART2->DR;
-        uint16_t next = (rb2.head + 1) % RX_BUF_SIZE;
-        if(next != rb2.tail) { // 未满
-            rb2.buf[rb2.head] = res;
-            rb2.head = next;
+    uint32_t sr = USART2->SR;
+    if(sr & (USART_FLAG_IDLE | USART_FLAG_ORE)) {
+        if(sr & USART_FLAG_ORE) s_rx_stats.hw_overrun++;
+        (void)USART2->DR;
+        if(sr & USART_FLAG_IDLE) {
+            Rx_ErrUnmuteISR();
+            Rx_DrainISR();
         }
+    } else if(sr & (USART_FLAG_FE | USART_FLAG_NE)) {
+        s_rx_stats.line_err++;
+        s_err_muted = 1;
+        USART_ITConfig(USART2, USART_IT_ERR, DISABLE);
+    }
+}
+
+/* DMA 半满/全满：长数据包不等空闲线，分段搬运防止被覆盖 */
+void DMA1_Stream5_IRQHandler(void) {
+    Rx_ErrUnmuteISR();
+    if(DMA_GetITStatus(DMA1_Stream5, DMA_IT_HTIF5) != RESET) {
+        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_HTIF5);
+        Rx_DrainISR();
+    }
+    if(DMA_GetITStatus(DMA1_Stream5, DMA_IT_TCIF5) != RESET) {
+        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_TCIF5);
+        Rx_DrainISR();
+    }
+}
+
+/* DMA 发送完成：释放已发送段，续传下一段，队列发空时通知 */
+void DMA1_Stream6_IRQHandler(void) {
+    BaseType_t woken = pdFALSE;
+    if(DMA_GetITStatus(DMA1_Stream6, DMA_IT_TCIF6) != RESET) {
+        DMA_ClearITPendingBit(DMA1_Stream6, DMA_IT_TCIF6);
+        s_tx_tail = (uint16_t)((s_tx_tail + s_tx_dma_len) % HGQ_USART2_TXBUF_SIZE);
+        s_tx_dma_len = 0;
+        Tx_Kick();
+        if(s_tx_dma_len == 0 && s_tx_done_cb) s_tx_done_cb();
+        xSemaphoreGiveFromISR(s_tx_sem, &woken);
     }
+    portYIELD_FROM_ISR(woken);
 }
 
 // ---------------- USART1 保持原样 (简化版) ----------------
@@ -98,4 +359,3 @@ void HGQ_USART1_SendString(char *str)
 	
 }
 	
-	
\ No newline at end of file
@@ -6,24 +6,48 @@
 
 /* 缓冲区大小定义：根据内存情况调整，建议 512 或 1024 */
 #define HGQ_USART1_RXBUF_SIZE   256
-#define HGQ_USART2_RXBUF_SIZE   1024  /* 接收 WIFI 大包，开大一点 */
+#define HGQ_USART2_RXBUF_SIZE   1024  /* 流缓冲区：接收 WIFI 大包，开大一点 */
+#define HGQ_USART2_DMA_RX_SIZE  256   /* DMA 循环缓冲区：半满/全满/空闲线 三种时机搬运 */
+#define HGQ_USART2_TXBUF_SIZE   1024  /* 发送队列：DMA 从这里直接取数，满了才阻塞调用者 */
+
+/* USART2 接收统计 (用现场数据调整缓冲区大小) */
+typedef struct {
+    uint32_t rx_bytes;      /* 累计搬入流缓冲区的字节数 */
+    uint32_t rx_chunks;     /* 累计搬运次数 (IDLE/HT/TC 各算一次) */
+    uint32_t overrun;       /* 流缓冲区满而丢弃的字节数 */
+    uint32_t hw_overrun;    /* USART ORE 硬件溢出次数 */
+    uint32_t line_err;      /* FE/NE 帧错误/噪声次数 (字节照常由 DMA 收下) */
+    uint16_t high_water;    /* 流缓冲区历史最高水位 (字节) */
+} HGQ_USART2_RxStats;
 
 /* 初始化 */
 void HGQ_USART1_Init(uint32_t bound);
 void HGQ_USART2_Init(uint32_t bound);
 
-/* 基础发送 */
+/* 基础发送 (USART2 为异步：拷入发送队列即返回，由 DMA 发出) */
 void HGQ_USART1_SendChar(uint8_t ch);
 void HGQ_USART1_SendString(char *str);
 void HGQ_USART2_SendChar(uint8_t ch);
 void HGQ_USART2_SendString(char *str);
 
-/* 环形缓冲区接收接口 (推荐) */
-void HGQ_USART2_EnableRxIRQ(FunctionalState en);     /* 开启中断接收 */
+/* DMA 发送接口：返回实际入队字节数，队列满时最多等待 timeout_ms */
+typedef void (*HGQ_USART_TxDoneCallback)(void);
+uint16_t HGQ_USART2_Write(const uint8_t *data, uint16_t len, uint32_t timeout_ms);
+uint8_t  HGQ_USART2_TxFlush(uint32_t timeout_ms);           /* 等待队列发空，1=完成 0=超时 */
+uint16_t HGQ_USART2_TxFree(void);                           /* 队列剩余空间 */
+void     HGQ_USART2_SetTxDoneCallback(HGQ_USART_TxDoneCallback cb); /* 队列发空时在中断中回调 */
+
+/* DMA 接收接口 (推荐)：阻塞等待数据，数据到达立即唤醒，超时返回 0 */
+uint16_t HGQ_USART2_Read(uint8_t *buf, uint16_t len, uint32_t timeout_ms);
+void HGQ_USART2_GetRxStats(HGQ_USART2_RxStats *st);
+void HGQ_USART2_SetRxNotify(void *task);             /* 数据到达时额外通知该任务 (TaskHandle_t) */
+
+/* 兼容接口：逐字节读取 */
+void HGQ_USART2_EnableRxIRQ(FunctionalState en);     /* 开启空闲线中断 */
 int  HGQ_USART2_IT_GetChar(uint8_t *ch);             /* 从缓冲区取一个字节 (非阻塞) */
 void HGQ_USART2_IT_ClearRxBuffer(void);              /* 清空缓冲区 */
 
-/* 兼容旧代码的回调定义 (仅占位，实际逻辑已移入环形缓冲) */
+/* 兼容旧代码的回调定义 (仅占位，实际逻辑已移入流缓冲区) */
 typedef void (*HGQ_USART_RxCallback)(uint8_t ch);
 void HGQ_USART2_SetRxCallback(HGQ_USART_RxCallback cb);
 
@@ -1,161 +1,44 @@
 #include "hgq_vl53l0x.h"
-#include "stm32f4xx_gpio.h"
-#include "stm32f4xx_rcc.h"
+#include "hgq_i2c.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <string.h>
 
-/* ================= 软件I2C（独立） ================= */
-#define I2C_DELAY_US  2
-
-static inline void SCL_H(void){ GPIO_SetBits(HGQ_VL53L0X_I2C_PORT, HGQ_VL53L0X_SCL_PIN); }
-static inline void SCL_L(void){ GPIO_ResetBits(HGQ_VL53L0X_I2C_PORT, HGQ_VL53L0X_SCL_PIN); }
-static inline void SDA_H(void){ GPIO_SetBits(HGQ_VL53L0X_I2C_PORT, HGQ_VL53L0X_SDA_PIN); }
-static inline void SDA_L(void){ GPIO_ResetBits(HGQ_VL53L0X_I2C_PORT, HGQ_VL53L0X_SDA_PIN); }
-static inline uint8_t SDA_READ(void){ return (GPIO_ReadInputDataBit(HGQ_VL53L0X_I2C_PORT, HGQ_VL53L0X_SDA_PIN)==Bit_SET)?1:0; }
-
-static void SDA_OUT_OD(void)
-{
-    GPIO_InitTypeDef g;
-    g.GPIO_Pin   = HGQ_VL53L0X_SDA_PIN;
-    g.GPIO_Mode  = GPIO_Mode_OUT;
-    g.GPIO_OType = GPIO_OType_OD;
-    g.GPIO_Speed = GPIO_Speed_50MHz;
-    g.GPIO_PuPd  = GPIO_PuPd_UP;
-    GPIO_Init(HGQ_VL53L0X_I2C_PORT, &g);
-}
-static void SDA_IN(void)
-{
-    GPIO_InitTypeDef g;
-    g.GPIO_Pin   = HGQ_VL53L0X_SDA_PIN;
-    g.GPIO_Mode  = GPIO_Mode_IN;
-    g.GPIO_Speed = GPIO_Speed_50MHz;
-    g.GPIO_PuPd  = GPIO_PuPd_UP;
-    GPIO_Init(HGQ_VL53L0X_I2C_PORT, &g);
-}
-
+/* ================= 总线：HGQ_I2C_TOF (PB10/PB11, I2C2) ================= */
 void HGQ_VL53L0X_I2C_Init(void)
 {
-    GPIO_InitTypeDef g;
-    RCC_AHB1PeriphClockCmd(HGQ_VL53L0X_I2C_RCC, ENABLE);
-
-    g.GPIO_Pin   = HGQ_VL53L0X_SCL_PIN | HGQ_VL53L0X_SDA_PIN;
-    g.GPIO_Mode  = GPIO_Mode_OUT;
-    g.GPIO_OType = GPIO_OType_OD;
-    g.GPIO_Speed = GPIO_Speed_50MHz;
-    g.GPIO_PuPd  = GPIO_PuPd_UP;
-    GPIO_Init(HGQ_VL53L0X_I2C_PORT, &g);
-
-    SCL_H(); SDA_H();
-    delay_us(10);
-}
-
-static void I2C_Start(void)
-{
-    SDA_OUT_OD();
-    SDA_H(); SCL_H(); delay_us(I2C_DELAY_US);
-    SDA_L();          delay_us(I2C_DELAY_US);
-    SCL_L();          delay_us(I2C_DELAY_US);
-}
-static void I2C_Stop(void)
-{
-    SDA_OUT_OD();
-    SCL_L(); SDA_L(); delay_us(I2C_DELAY_US);
-    SCL_H();          delay_us(I2C_DELAY_US);
-    SDA_H();          delay_us(I2C_DELAY_US);
-}
-static void I2C_SendByte(uint8_t b)
-{
-    SDA_OUT_OD();
-    for(int i=0;i<8;i++)
-    {
-        (b & 0x80) ? SDA_H() : SDA_L();
-        delay_us(I2C_DELAY_US);
-        SCL_H(); delay_us(I2C_DELAY_US);
-        SCL_L(); delay_us(I2C_DELAY_US);
-        b <<= 1;
-    }
-}
-static uint8_t I2C_WaitAck(uint16_t timeout_us)
-{
-    uint16_t t=0;
-    SDA_IN();
-    SDA_H();
-    delay_us(I2C_DELAY_US);
-    SCL_H(); delay_us(I2C_DELAY_US);
-
-    while(SDA_READ())
-    {
-        if(t++ >= timeout_us){ SCL_L(); return 0; }
-        delay_us(1);
-    }
-    SCL_L();
-    return 1;
-}
-static void I2C_Ack(void)
-{
-    SDA_OUT_OD();
-    SDA_L(); delay_us(I2C_DELAY_US);
-    SCL_H(); delay_us(I2C_DELAY_US);
-    SCL_L(); delay_us(I2C_DELAY_US);
-    SDA_H();
-}
-static void I2C_NAck(void)
-{
-    SDA_OUT_OD();
-    SDA_H(); delay_us(I2C_DELAY_US);
-    SCL_H(); delay_us(I2C_DELAY_US);
-    SCL_L(); delay_us(I2C_DELAY_US);
-}
-static uint8_t I2C_ReadByte(uint8_t ack)
-{
-    uint8_t data=0;
-    SDA_IN(); SDA_H();
-    for(int i=0;i<8;i++)
-    {
-        data <<= 1;
-        SCL_H(); delay_us(I2C_DELAY_US);
-        if(SDA_READ()) data |= 1;
-        SCL_L(); delay_us(I2C_DELAY_US);
-    }
-    ack ? I2C_Ack() : I2C_NAck();
-    return data;
+    HGQ_I2C_Init(HGQ_I2C_TOF);
 }
 
 /* ================= 寄存器读写 ================= */
 static HGQ_VL53L0X_Status wr8(HGQ_VL53L0X_Handle *d, uint8_t reg, uint8_t val)
 {
-    I2C_Start();
-    I2C_SendByte((d->addr<<1)|0); if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    I2C_SendByte(reg);           if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    I2C_SendByte(val);           if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    I2C_Stop();
+    if(HGQ_I2C_MemWrite(HGQ_I2C_TOF, d->addr, reg, 1, &val, 1)) return HGQ_VL53L0X_ERR;
     return HGQ_VL53L0X_OK;
 }
 static HGQ_VL53L0X_Status rd8(HGQ_VL53L0X_Handle *d, uint8_t reg, uint8_t *val)
 {
-    I2C_Start();
-    I2C_SendByte((d->addr<<1)|0); if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    I2C_SendByte(reg);           if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-
-    I2C_Start();
-    I2C_SendByte((d->addr<<1)|1); if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    *val = I2C_ReadByte(0);
-    I2C_Stop();
+    if(HGQ_I2C_MemRead(HGQ_I2C_TOF, d->addr, reg, 1, val, 1)) return HGQ_VL53L0X_ERR;
     return HGQ_VL53L0X_OK;
 }
 static HGQ_VL53L0X_Status rd16(HGQ_VL53L0X_Handle *d, uint8_t reg, uint16_t *val)
 {
-    uint8_t hi, lo;
-    I2C_Start();
-    I2C_SendByte((d->addr<<1)|0); if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    I2C_SendByte(reg);           if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-
-    I2C_Start();
-    I2C_SendByte((d->addr<<1)|1); if(!I2C_WaitAck(2000)) { I2C_Stop(); return HGQ_VL53L0X_ERR; }
-    hi = I2C_ReadByte(1);
-    lo = I2C_ReadByte(0);
-    I2C_Stop();
+    uint8_t b[2];
+    if(HGQ_I2C_MemRead(HGQ_I2C_TOF, d->addr, reg, 1, b, 2)) return HGQ_VL53L0X_ERR;
+    *val = ((uint16_t)b[0]<<8) | b[1];
+    return HGQ_VL53L0X_OK;
+}
 
-    *val = ((uint16_t)hi<<8) | lo;
+static HGQ_VL53L0X_Status wr16(HGQ_VL53L0X_Handle *d, uint8_t reg, uint16_t val)
+{
+    uint8_t b[2] = {(uint8_t)(val>>8), (uint8_t)val};
+    if(HGQ_I2C_MemWrite(HGQ_I2C_TOF, d->addr, reg, 1, b, 2)) return HGQ_VL53L0X_ERR;
+    return HGQ_VL53L0X_OK;
+}
+static HGQ_VL53L0X_Status wr32(HGQ_VL53L0X_Handle *d, uint8_t reg, uint32_t val)
+{
+    uint8_t b[4] = {(uint8_t)(val>>24), (uint8_t)(val>>16), (uint8_t)(val>>8), (uint8_t)val};
+    if(HGQ_I2C_MemWrite(HGQ_I2C_TOF, d->addr, reg, 1, b, 4)) return HGQ_VL53L0X_ERR;
     return HGQ_VL53L0X_OK;
 }
 
@@ -239,12 +122,9 @@ static HGQ_VL53L0X_Status do_ref_cal(HGQ_VL53L0X_Handle *d)
     return HGQ_VL53L0X_OK;
 }
 
-/* ====== 单次读取 raw(mm) ====== */
-static HGQ_VL53L0X_Status read_raw_mm_once(HGQ_VL53L0X_Handle *dev, uint16_t *mm)
+/* ====== 每次启动测量前恢复 stop_variable ====== */
+static void restore_stop_var(HGQ_VL53L0X_Handle *dev)
 {
-    if(!dev || !mm) return HGQ_VL53L0X_ERR;
-
-    /* stop_variable restore */
     wr8(dev, 0x80, 0x01);
     wr8(dev, 0xFF, 0x01);
     wr8(dev, 0x00, 0x00);
@@ -252,62 +132,69 @@ static HGQ_VL53L0X_Status read_raw_mm_once(HGQ_VL53L0X_Handle *dev, uint16_t *mm
     wr8(dev, 0x00, 0x01);
     wr8(dev, 0xFF, 0x00);
     wr8(dev, 0x80, 0x00);
+}
+
+/* ====== 单次测量拆成 启动 / 取结果 两步 ====== */
+HGQ_VL53L0X_Status HGQ_VL53L0X_Start(HGQ_VL53L0X_Handle *dev)
+{
+    if(!dev) return HGQ_VL53L0X_ERR;
+
+    restore_stop_var(dev);
 
     /* start */
-    wr8(dev, 0x00, 0x01);
+    return wr8(dev, 0x00, 0x01);
+}
 
-    /* wait ready: RESULT_INTERRUPT_STATUS(0x13) bit[2:0] != 0 */
-    if(wait_reg_bit(dev, 0x13, 0x07, 1, dev->io_timeout_ms) != HGQ_VL53L0X_OK)
-        return HGQ_VL53L0X_TIMEOUT;
+HGQ_VL53L0X_Status HGQ_VL53L0X_Poll(HGQ_VL53L0X_Handle *dev, uint16_t *mm_raw)
+{
+    uint8_t v = 0;
+    if(!dev || !mm_raw) return HGQ_VL53L0X_ERR;
 
-    if(rd16(dev, 0x1E, mm) != HGQ_VL53L0X_OK)
+    /* ready: RESULT_INTERRUPT_STATUS(0x13) bit[2:0] != 0 */
+    if(rd8(dev, 0x13, &v) != HGQ_VL53L0X_OK) return HGQ_VL53L0X_ERR;
+    if(!(v & 0x07)) return HGQ_VL53L0X_BUSY;
+
+    if(rd16(dev, 0x1E, mm_raw) != HGQ_VL53L0X_OK)
         return HGQ_VL53L0X_ERR;
 
     wr8(dev, 0x0B, 0x01); /* clear */
     return HGQ_VL53L0X_OK;
 }
 
-/* ====== 小工具：排序（滤波用）====== */
-static void sort_u16(uint16_t *a, int n)
+/* ====== 单次读取 raw(mm)，阻塞等待 ====== */
+static HGQ_VL53L0X_Status read_raw_mm_once(HGQ_VL53L0X_Handle *dev, uint16_t *mm)
 {
-    for(int i=0;i<n-1;i++)
-        for(int j=0;j<n-1-i;j++)
-            if(a[j] > a[j+1]) { uint16_t t=a[j]; a[j]=a[j+1]; a[j+1]=t; }
+    if(!dev || !mm) return HGQ_VL53L0X_ERR;
+
+    if(HGQ_VL53L0X_Start(dev) != HGQ_VL53L0X_OK) return HGQ_VL53L0X_ERR;
+
+    if(wait_reg_bit(dev, 0x13, 0x07, 1, dev->io_timeout_ms) != HGQ_VL53L0X_OK)
+        return HGQ_VL53L0X_TIMEOUT;
+
+    return HGQ_VL53L0X_Poll(dev, mm);
 }
 
 /* ====== 对 raw 做滤波，输出 raw_filtered ====== */
 static HGQ_VL53L0X_Status read_raw_filtered(HGQ_VL53L0X_Handle *dev, uint16_t *raw_out)
 {
-    uint16_t buf[9]; /* 最多支持9点，够用了 */
+    HGQ_TrimMean tm;
+    int32_t out = 0;
     int ok = 0;
 
-    uint8_t n = dev->filter_n;
-    if(n < 1) n = 1;
-    if(n > 9) n = 9;
+    HGQ_TrimMean_Init(&tm, dev->filter_n, dev->filter_trim);
 
-    for(uint8_t i=0;i<n;i++)
+    for(uint8_t i=0;i<tm.n;i++)
     {
         uint16_t mm=0;
         HGQ_VL53L0X_Status st = read_raw_mm_once(dev, &mm);
-        if(st == HGQ_VL53L0X_OK)
-            buf[ok++] = mm;
+        if(st == HGQ_VL53L0X_OK) { out = HGQ_TrimMean_Put(&tm, mm); ok++; }
 
         if(dev->sample_delay_ms) delay_ms(dev->sample_delay_ms);
     }
 
     if(ok == 0) return HGQ_VL53L0X_TIMEOUT;
 
-    sort_u16(buf, ok);
-
-    uint8_t trim = dev->filter_trim;
-    if(ok < 3) trim = 0;
-    if(trim*2 >= ok) trim = 0;
-
-    uint32_t sum = 0;
-    uint8_t cnt = 0;
-    for(int i=trim;i<ok-trim;i++) { sum += buf[i]; cnt++; }
-
-    *raw_out = (cnt ? (uint16_t)(sum/cnt) : buf[ok/2]);
+    *raw_out = (uint16_t)out;
     return HGQ_VL53L0X_OK;
 }
 
@@ -335,6 +222,7 @@ HGQ_VL53L0X_Status HGQ_VL53L0X_Begin(HGQ_VL53L0X_Handle *dev, uint8_t addr_7bit)
     dev->filter_n = 5;
     dev->filter_trim = 1;
     dev->sample_delay_ms = 20;
+    HGQ_TrimMean_Init(&dev->filt, dev->filter_n, dev->filter_trim);
     dev->min_valid_mm = 30;
 
     /* 建议：在 main 里先调用一次 HGQ_VL53L0X_I2C_Init()，这里不强制重复 */
@@ -378,6 +266,7 @@ void HGQ_VL53L0X_SetFilter(HGQ_VL53L0X_Handle *dev, uint8_t n, uint8_t trim, uin
     if(!dev) return;
     dev->filter_n = n;
     dev->filter_trim = trim;
+    HGQ_TrimMean_Init(&dev->filt, n, trim);
     dev->sample_delay_ms = sample_delay_ms;
 }
 
@@ -397,8 +286,290 @@ HGQ_VL53L0X_Status HGQ_VL53L0X_ReadMmEx(HGQ_VL53L0X_Handle *dev, uint16_t *mm_ra
     return HGQ_VL53L0X_OK;
 }
 
+HGQ_VL53L0X_Status HGQ_VL53L0X_Feed(HGQ_VL53L0X_Handle *dev, uint16_t raw, uint16_t *mm_raw, uint16_t *mm_corr)
+{
+    if(!dev || !mm_corr) return HGQ_VL53L0X_ERR;
+
+    /* 滑动窗口：最近 filter_n 个样本去两端平均，每来一个样本就出一个结果 */
+    raw = (uint16_t)HGQ_TrimMean_Put(&dev->filt, raw);
+
+    if(mm_raw) *mm_raw = raw;
+
+    if(raw < dev->min_valid_mm) return HGQ_VL53L0X_TOO_CLOSE;
+
+    *mm_corr = apply_calib(dev, raw);
+    return HGQ_VL53L0X_OK;
+}
+
 HGQ_VL53L0X_Status HGQ_VL53L0X_ReadMm(HGQ_VL53L0X_Handle *dev, uint16_t *mm_corr)
 {
     return HGQ_VL53L0X_ReadMmEx(dev, 0, mm_corr);
 }
 
+
+/* ================= 测量时间预算（按公开实现的开销表计算 final range 超时） ================= */
+/* VCSEL 周期编码：寄存器值 v -> (v+1)*2 个 PCLK */
+static uint32_t macro_period_ns(uint8_t vcsel_pclks)
+{
+    return ((2304UL * vcsel_pclks * 1655UL) + 500) / 1000;
+}
+static uint32_t mclks_to_us(uint32_t mclks, uint8_t vcsel_pclks)
+{
+    uint32_t ns = macro_period_ns(vcsel_pclks);
+    return ((mclks * ns) + 500) / 1000;
+}
+static uint32_t us_to_mclks(uint32_t us, uint8_t vcsel_pclks)
+{
+    uint32_t ns = macro_period_ns(vcsel_pclks);
+    return ((us * 1000) + (ns / 2)) / ns;
+}
+static uint32_t decode_timeout(uint16_t v)
+{
+    return ((uint32_t)(v & 0xFF) << (v >> 8)) + 1;
+}
+static uint16_t encode_timeout(uint32_t mclks)
+{
+    uint32_t ls;
+    uint16_t ms = 0;
+    if(mclks == 0) return 0;
+    ls = mclks - 1;
+    while(ls & 0xFFFFFF00) { ls >>= 1; ms++; }
+    return (uint16_t)((ms << 8) | (ls & 0xFF));
+}
+
+HGQ_VL53L0X_Status HGQ_VL53L0X_SetTimingBudget(HGQ_VL53L0X_Handle *dev, uint32_t budget_us)
+{
+    uint8_t seq, v, pre_pclks, final_pclks;
+    uint16_t r16;
+    uint32_t msrc_us, pre_mclks, pre_us, used, final_mclks;
+
+    if(!dev || budget_us < 20000) return HGQ_VL53L0X_ERR;
+
+    /* SYSTEM_SEQUENCE_CONFIG：bit4 TCC, bit3 DSS, bit2 MSRC, bit6 PRE_RANGE, bit7 FINAL_RANGE */
+    if(rd8(dev, 0x01, &seq)) return HGQ_VL53L0X_ERR;
+    if(rd8(dev, 0x50, &v)) return HGQ_VL53L0X_ERR;
+    pre_pclks = (uint8_t)((v + 1) << 1);
+    if(rd8(dev, 0x70, &v)) return HGQ_VL53L0X_ERR;
+    final_pclks = (uint8_t)((v + 1) << 1);
+
+    if(rd8(dev, 0x46, &v)) return HGQ_VL53L0X_ERR;              /* MSRC_CONFIG_TIMEOUT_MACROP */
+    msrc_us = mclks_to_us((uint32_t)v + 1, pre_pclks);
+    if(rd16(dev, 0x51, &r16)) return HGQ_VL53L0X_ERR;           /* PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI */
+    pre_mclks = decode_timeout(r16);
+    pre_us = mclks_to_us(pre_mclks, pre_pclks);
+
+    used = 1910 + 960;                                          /* 启动 + 结束开销 */
+    if(seq & 0x10) used += msrc_us + 590;
+    if(seq & 0x08) used += 2 * (msrc_us + 690);
+    else if(seq & 0x04) used += msrc_us + 660;
+    if(seq & 0x40) used += pre_us + 660;
+    if(!(seq & 0x80)) { dev->budget_us = budget_us; return HGQ_VL53L0X_OK; }
+    used += 550;
+    if(used > budget_us) return HGQ_VL53L0X_ERR;
+
+    /* 剩下的时间全给 final range，超时值含 pre range 部分 */
+    final_mclks = us_to_mclks(budget_us - used, final_pclks);
+    if(seq & 0x40) final_mclks += pre_mclks;
+    if(wr16(dev, 0x71, encode_timeout(final_mclks))) return HGQ_VL53L0X_ERR;
+
+    dev->budget_us = budget_us;
+    return HGQ_VL53L0X_OK;
+}
+
+/* ================= 连续测距：GPIO1 数据就绪中断 + 采样环 ================= */
+/*
+ * GPIO1 在 Begin 里配成“新样本就绪”、低电平有效，清中断 (0x0B=1) 前一直为低
+ *   中断 -> 异步读 0x14 起 12 字节 (量程状态 + 距离) -> 完成回调写入采样环
+ *        -> 异步写 0x0B 清中断 -> GPIO1 回高，等下一个样本
+ * 硬件总线整条链都在中断里走完，不占任务时间；软件总线不能在中断里读，
+ * 中断只置标志，由 HGQ_VL53L0X_ContService 在任务里读
+ */
+static HGQ_VL53L0X_Handle *volatile s_cont_dev = 0;
+static HGQ_VL53L0X_Sample s_ring[HGQ_VL53L0X_RING_LEN];
+static volatile uint8_t s_ring_w = 0, s_ring_r = 0;
+static HGQ_I2C_Xfer s_rd_x, s_clr_x;
+static uint8_t s_rd_buf[12];
+static const uint8_t s_clr_val = 0x01;
+static volatile uint8_t s_busy = 0, s_pend = 0;
+static volatile uint32_t s_irq_tick = 0;
+static volatile uint32_t s_last_tick = 0;   /* 最近一次取到样本 (或启动) 的节拍 */
+static uint32_t s_period_ms = 0;            /* 预期的样本间隔 */
+static HGQ_VL53L0X_ContStats s_cst;
+
+static void Cont_ClrDone(HGQ_I2C_Xfer *x)
+{
+    if(x->status != HGQ_I2C_OK) s_cst.errors++;
+    s_busy = 0;
+}
+
+static void Cont_RdDone(HGQ_I2C_Xfer *x)
+{
+    if(x->status == HGQ_I2C_OK) {
+        uint8_t w = s_ring_w, n = (uint8_t)((w + 1) % HGQ_VL53L0X_RING_LEN);
+        if(n == s_ring_r) {
+            s_cst.dropped++;                /* 读的一方跟不上，丢最新的 */
+        } else {
+            s_ring[w].mm = ((uint16_t)s_rd_buf[10] << 8) | s_rd_buf[11];
+            s_ring[w].range_status = (s_rd_buf[0] >> 3) & 0x0F;
+            s_ring[w].tick = s_irq_tick;
+            s_ring_w = n;
+            s_last_tick = s_irq_tick;
+            s_cst.samples++;
+        }
+    } else {
+        s_cst.errors++;
+    }
+    /* 不管读成没成功都清中断，否则 GPIO1 一直为低不会再有下降沿 */
+    if(HGQ_I2C_Submit(HGQ_I2C_TOF, &s_clr_x) == HGQ_I2C_BUSY) { s_cst.errors++; s_busy = 0; }
+}
+
+/* 发起一轮 读结果 + 清中断；已有一轮在进行时直接返回 */
+static void Cont_Kick(void)
+{
+    UBaseType_t m = taskENTER_CRITICAL_FROM_ISR();
+    if(s_busy || !s_cont_dev) { taskEXIT_CRITICAL_FROM_ISR(m); return; }
+    s_busy = 1;
+    taskEXIT_CRITICAL_FROM_ISR(m);
+
+    if(HGQ_I2C_Submit(HGQ_I2C_TOF, &s_rd_x) == HGQ_I2C_BUSY) { s_cst.errors++; s_busy = 0; }
+}
+
+static void Cont_EXTI_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_AHB1PeriphClockCmd(HGQ_VL53L0X_INT_RCC, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+
+    /* GPIO1 开漏输出，模块上一般有上拉，这里再开内部上拉 */
+    GPIO_InitStructure.GPIO_Pin = HGQ_VL53L0X_INT_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(HGQ_VL53L0X_INT_PORT, &GPIO_InitStructure);
+
+    SYSCFG_EXTILineConfig(HGQ_VL53L0X_INT_PORTSRC, HGQ_VL53L0X_INT_PINSRC);
+    EXTI_InitStructure.EXTI_Line = HGQ_VL53L0X_INT_LINE;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+    EXTI_ClearITPendingBit(HGQ_VL53L0X_INT_LINE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = HGQ_VL53L0X_INT_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = HGQ_VL53L0X_IRQ_PRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+HGQ_VL53L0X_Status HGQ_VL53L0X_StartContinuous(HGQ_VL53L0X_Handle *dev, uint32_t period_ms)
+{
+    if(!dev) return HGQ_VL53L0X_ERR;
+
+    s_rd_x.addr = dev->addr; s_rd_x.reglen = 1; s_rd_x.reg = 0x14;      /* RESULT_RANGE_STATUS */
+    s_rd_x.rbuf = s_rd_buf; s_rd_x.rlen = sizeof(s_rd_buf); s_rd_x.done = Cont_RdDone;
+    s_clr_x.addr = dev->addr; s_clr_x.reglen = 1; s_clr_x.reg = 0x0B;   /* SYSTEM_INTERRUPT_CLEAR */
+    s_clr_x.wbuf = &s_clr_val; s_clr_x.wlen = 1; s_clr_x.done = Cont_ClrDone;
+    s_ring_r = s_ring_w;
+    s_busy = 0; s_pend = 0;
+    s_cst.polling = 0;
+    /* 背靠背时样本间隔就是时间预算，没设置过按上电默认约 33ms */
+    s_period_ms = period_ms ? period_ms : (dev->budget_us ? dev->budget_us / 1000 : 33);
+    s_last_tick = xTaskGetTickCount();
+
+    restore_stop_var(dev);
+    wr8(dev, 0x0B, 0x01);
+
+    if(period_ms) {
+        /* 定时模式：间隔要乘内部振荡器校准值 */
+        uint16_t osc = 0;
+        if(rd16(dev, 0xF8, &osc) == HGQ_VL53L0X_OK && osc) period_ms *= osc;
+        wr32(dev, 0x04, period_ms);                 /* SYSTEM_INTERMEASUREMENT_PERIOD */
+        if(wr8(dev, 0x00, 0x04)) return HGQ_VL53L0X_ERR;
+    } else {
+        if(wr8(dev, 0x00, 0x02)) return HGQ_VL53L0X_ERR;        /* 背靠背 */
+    }
+
+    Cont_EXTI_Init();
+    s_cont_dev = dev;
+    return HGQ_VL53L0X_OK;
+}
+
+HGQ_VL53L0X_Status HGQ_VL53L0X_StopContinuous(HGQ_VL53L0X_Handle *dev)
+{
+    if(!dev) return HGQ_VL53L0X_ERR;
+
+    s_cont_dev = 0;
+    EXTI->IMR &= ~HGQ_VL53L0X_INT_LINE;
+    while(s_busy) vTaskDelay(1);            /* 等正在进行的 读 + 清中断 结束 */
+
+    wr8(dev, 0x00, 0x01);
+    wr8(dev, 0xFF, 0x01);
+    wr8(dev, 0x00, 0x00);
+    wr8(dev, 0x91, 0x00);
+    wr8(dev, 0x00, 0x01);
+    wr8(dev, 0xFF, 0x00);
+    return HGQ_VL53L0X_OK;
+}
+
+void HGQ_VL53L0X_ContService(void)
+{
+    HGQ_VL53L0X_Handle *dev = s_cont_dev;
+    uint8_t st;
+
+    if(!dev) return;
+    /* 超过 2 个周期一个样本都没有且 PB12 一直是高 (上拉)：多半 GPIO1 没接，以后都查询 */
+    if(!s_cst.polling && !s_busy && xTaskGetTickCount() - s_last_tick > 2 * s_period_ms &&
+       GPIO_ReadInputDataBit(HGQ_VL53L0X_INT_PORT, HGQ_VL53L0X_INT_PIN) == Bit_SET) s_cst.polling = 1;
+    if(s_cst.polling) {
+        /* RESULT_INTERRUPT_STATUS 低 3 位非 0 表示新样本就绪，读取和清中断仍走中断那条链 */
+        s_pend = 0;
+        if(!s_busy && rd8(dev, 0x13, &st) == HGQ_VL53L0X_OK && (st & 0x07)) {
+            s_cst.polls++;
+            s_irq_tick = xTaskGetTickCount();
+            Cont_Kick();
+        }
+        return;
+    }
+    /* 软件总线：中断只置了标志；硬件总线：GPIO1 为低却没有在读，说明清中断失败或漏了下降沿 */
+    if(s_pend || GPIO_ReadInputDataBit(HGQ_VL53L0X_INT_PORT, HGQ_VL53L0X_INT_PIN) == Bit_RESET) {
+        s_pend = 0;
+        if(!s_busy) {
+            if(HGQ_I2C_IsHw(HGQ_I2C_TOF)) s_cst.kicks++;
+            s_irq_tick = xTaskGetTickCount();
+            Cont_Kick();
+        }
+    }
+}
+
+uint8_t HGQ_VL53L0X_ContGet(HGQ_VL53L0X_Sample *smp)
+{
+    uint8_t r = s_ring_r;
+    if(r == s_ring_w) return 0;
+    *smp = s_ring[r];
+    s_ring_r = (uint8_t)((r + 1) % HGQ_VL53L0X_RING_LEN);
+    return 1;
+}
+
+void HGQ_VL53L0X_ContGetStats(HGQ_VL53L0X_ContStats *st)
+{
+    taskENTER_CRITICAL();
+    *st = s_cst;
+    taskEXIT_CRITICAL();
+}
+
+/* 中断服务函数：EXTI10~15 共用，这里只处理 GPIO1 那一根 */
+void EXTI15_10_IRQHandler(void)
+{
+    if(EXTI_GetITStatus(HGQ_VL53L0X_INT_LINE) != RESET) {
+        EXTI_ClearITPendingBit(HGQ_VL53L0X_INT_LINE);
+        s_cst.irqs++;
+        s_irq_tick = xTaskGetTickCountFromISR();
+        if(HGQ_I2C_IsHw(HGQ_I2C_TOF)) Cont_Kick();
+        else s_pend = 1;
+    }
+}
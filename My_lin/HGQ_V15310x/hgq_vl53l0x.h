@@ -3,21 +3,32 @@
 
 #include "stm32f4xx.h"
 #include "delay.h"
+#include "hgq_filter.h"
 
-/* ========= 引脚：PB10=SCL, PB11=SDA（独立软件I2C，不复用你的其它I2C） ========= */
-#define HGQ_VL53L0X_I2C_RCC   RCC_AHB1Periph_GPIOB
-#define HGQ_VL53L0X_I2C_PORT  GPIOB
-#define HGQ_VL53L0X_SCL_PIN   GPIO_Pin_10
-#define HGQ_VL53L0X_SDA_PIN   GPIO_Pin_11
+/* ========= 引脚：PB10=SCL, PB11=SDA（HGQ_I2C_TOF 总线，I2C2 + DMA） ========= */
 
 #define HGQ_VL53L0X_ADDR      0x29   /* 7-bit address */
 
+/* ========= 连续测距：GPIO1 (数据就绪，低有效) -> PB12 / EXTI12 =========
+ * 模块的 GPIO1 脚需要另接一根线到 PB12；没接时超过 2 个测量周期收不到中断，
+ * ContService 自动改为查询 RESULT_INTERRUPT_STATUS，只是取数要等到下一次调用 */
+#define HGQ_VL53L0X_INT_RCC       RCC_AHB1Periph_GPIOB
+#define HGQ_VL53L0X_INT_PORT      GPIOB
+#define HGQ_VL53L0X_INT_PIN       GPIO_Pin_12
+#define HGQ_VL53L0X_INT_PORTSRC   EXTI_PortSourceGPIOB
+#define HGQ_VL53L0X_INT_PINSRC    EXTI_PinSource12
+#define HGQ_VL53L0X_INT_LINE      EXTI_Line12
+#define HGQ_VL53L0X_INT_IRQn      EXTI15_10_IRQn
+#define HGQ_VL53L0X_IRQ_PRIO      6      /* 中断里提交 I2C 传输，抢占优先级必须 >= 5 */
+#define HGQ_VL53L0X_RING_LEN      16     /* 采样环长度，实际可存 RING_LEN-1 个 */
+
 typedef enum
 {
     HGQ_VL53L0X_OK = 0,
     HGQ_VL53L0X_ERR = 1,
     HGQ_VL53L0X_TIMEOUT = 2,
-    HGQ_VL53L0X_TOO_CLOSE = 3
+    HGQ_VL53L0X_TOO_CLOSE = 3,
+    HGQ_VL53L0X_BUSY = 4           /* Poll：测量还没完成 */
 } HGQ_VL53L0X_Status;
 
 typedef struct
@@ -37,12 +48,16 @@ typedef struct
     /* 太近阈值（mm） */
     uint16_t min_valid_mm;
 
+    /* 测量时间预算 (us)，0 表示没设置过 (上电默认约 33ms) */
+    uint32_t budget_us;
+
     /* 内部变量 */
     uint8_t  stop_variable;
+    HGQ_TrimMean filt;          /* Feed 的滑动窗口 */
 } HGQ_VL53L0X_Handle;
 
 /* ========= API ========= */
-void HGQ_VL53L0X_I2C_Init(void);
+void HGQ_VL53L0X_I2C_Init(void);     /* 即 HGQ_I2C_Init(HGQ_I2C_TOF) */
 
 HGQ_VL53L0X_Status HGQ_VL53L0X_Begin(HGQ_VL53L0X_Handle *dev, uint8_t addr_7bit);
 
@@ -58,6 +73,44 @@ HGQ_VL53L0X_Status HGQ_VL53L0X_ReadMm(HGQ_VL53L0X_Handle *dev, uint16_t *mm_corr
 /* 读取：同时返回 raw/corr，便于你调试 */
 HGQ_VL53L0X_Status HGQ_VL53L0X_ReadMmEx(HGQ_VL53L0X_Handle *dev, uint16_t *mm_raw, uint16_t *mm_corr);
 
+/* 非阻塞用法：Start 启动一次测量 (默认时序约 33ms)，到时间后 Poll 取 raw，
+ * 未完成返回 HGQ_VL53L0X_BUSY；取到的 raw 交给 Feed 做滑动窗口滤波+标定+太近判定 */
+HGQ_VL53L0X_Status HGQ_VL53L0X_Start(HGQ_VL53L0X_Handle *dev);
+HGQ_VL53L0X_Status HGQ_VL53L0X_Poll(HGQ_VL53L0X_Handle *dev, uint16_t *mm_raw);
+HGQ_VL53L0X_Status HGQ_VL53L0X_Feed(HGQ_VL53L0X_Handle *dev, uint16_t raw, uint16_t *mm_raw, uint16_t *mm_corr);
+
+/* 测量时间预算：>=20000us，越长越准，连续模式下决定最高采样率 */
+HGQ_VL53L0X_Status HGQ_VL53L0X_SetTimingBudget(HGQ_VL53L0X_Handle *dev, uint32_t budget_us);
+
+/* ========= 连续测距 ========= */
+typedef struct
+{
+    uint16_t mm;                /* raw 距离，未滤波未标定 */
+    uint8_t  range_status;      /* 器件量程状态，11 为有效 */
+    uint32_t tick;              /* 数据就绪中断的节拍 */
+} HGQ_VL53L0X_Sample;
+
+typedef struct
+{
+    uint32_t irqs;              /* 数据就绪中断次数 */
+    uint32_t samples;           /* 进入采样环的样本 */
+    uint32_t dropped;           /* 采样环满丢弃 */
+    uint32_t errors;            /* 读结果 / 清中断失败 */
+    uint32_t kicks;             /* 硬件总线下由 ContService 补发的读取 (漏中断) */
+    uint32_t polls;             /* 查询方式发现的样本 */
+    uint8_t  polling;           /* 1: 没有中断，已改为查询 */
+} HGQ_VL53L0X_ContStats;
+
+/* period_ms=0 背靠背测量，否则按间隔定时测量 (间隔应大于时间预算)；
+ * 连续模式期间不要再调用 Start/Poll/ReadMm，只有一个器件能用连续模式 */
+HGQ_VL53L0X_Status HGQ_VL53L0X_StartContinuous(HGQ_VL53L0X_Handle *dev, uint32_t period_ms);
+HGQ_VL53L0X_Status HGQ_VL53L0X_StopContinuous(HGQ_VL53L0X_Handle *dev);
+/* 任务里周期调用：软件总线时在这里读数据，硬件总线时补救漏掉的中断，没有中断时查询 */
+void    HGQ_VL53L0X_ContService(void);
+/* 从采样环取一个样本，1 取到 0 空；单个任务读 */
+uint8_t HGQ_VL53L0X_ContGet(HGQ_VL53L0X_Sample *smp);
+void    HGQ_VL53L0X_ContGetStats(HGQ_VL53L0X_ContStats *st);
+
 /* 调试：读 ModelID（一般 0xEE） */
 HGQ_VL53L0X_Status HGQ_VL53L0X_ReadModelID(HGQ_VL53L0X_Handle *dev, uint8_t *model_id);
 
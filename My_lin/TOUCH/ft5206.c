@@ -1,6 +1,6 @@
 #include "ft5206.h"
 #include "touch.h"
-#include "ctiic.h"
+#include "hgq_i2c.h"
 #include "usart.h"
 #include "delay.h" 
 #include "string.h" 
@@ -27,21 +27,7 @@
 //返回值:0,成功;1,失败.
 u8 FT5206_WR_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i;
-	u8 ret=0;
-	CT_IIC_Start();	 
-	CT_IIC_Send_Byte(FT_CMD_WR);	//发送写命令 	 
-	CT_IIC_Wait_Ack(); 	 										  		   
-	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
-	for(i=0;i<len;i++)
-	{	   
-    	CT_IIC_Send_Byte(buf[i]);  	//发数据
-		ret=CT_IIC_Wait_Ack();
-		if(ret)break;  
-	}
-    CT_IIC_Stop();					//产生一个停止条件	    
-	return ret; 
+	return HGQ_I2C_MemWrite(HGQ_I2C_CT,FT_CMD_WR>>1,reg,1,buf,len)!=HGQ_I2C_OK;
 }
 //从FT5206读出一次数据
 //reg:起始寄存器地址
@@ -49,20 +35,7 @@ u8 FT5206_WR_Reg(u16 reg,u8 *buf,u8 len)
 //len:读数据长度			  
 void FT5206_RD_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i; 
- 	CT_IIC_Start();	
- 	CT_IIC_Send_Byte(FT_CMD_WR);   	//发送写命令 	 
-	CT_IIC_Wait_Ack(); 	 										  		   
- 	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
- 	CT_IIC_Start();  	 	   
-	CT_IIC_Send_Byte(FT_CMD_RD);   	//发送读命令		   
-	CT_IIC_Wait_Ack();	   
-	for(i=0;i<len;i++)
-	{	   
-    	buf[i]=CT_IIC_Read_Byte(i==(len-1)?0:1); //发数据	  
-	} 
-    CT_IIC_Stop();//产生一个停止条件     
+	HGQ_I2C_MemRead(HGQ_I2C_CT,FT_CMD_WR>>1,reg,1,buf,len);
 } 
 
 u8 CIP[5]; //用来存放触摸IC-GT911
@@ -86,7 +59,7 @@ u8 FT5206_Init(void)
 	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;//输出模式
 	GPIO_Init(GPIOC, &GPIO_InitStructure);//初始化	
 	
-	CT_IIC_Init();      	//初始化电容屏的I2C总线  
+	HGQ_I2C_Init(HGQ_I2C_CT);	//初始化电容屏的I2C总线  
 	FT_RST=0;				//复位
 	delay_ms(20);
  	FT_RST=1;				//释放复位		    
@@ -251,6 +224,35 @@ u8 FT5206_Scan(u8 mode)
 	if(t>240)t=10;//重新从10开始计数
 	return res;
 }
+
+//一次连续读出全部触点(中断模式下由触摸读取任务调用,不做查询间隔控制)
+//x,y:输出坐标,至少CT_MAX_TOUCH个
+//返回值:有效触点数;0XFF,没有新数据
+u8 FT5206_ReadPoints(u16 *x,u16 *y)
+{
+	u8 buf[1+6*CT_MAX_TOUCH];
+	u8 i,n,cnt=0;
+	if(strcmp((char *)CIP,"911")==0)return GT9147_ReadPoints(x,y);//触摸IC 911
+	FT5206_RD_Reg(FT_REG_NUM_FINGER,buf,sizeof(buf));//从触点数寄存器起连续读5个点
+	n=buf[0]&0X0F;
+	if(n>g_gt_tnum)return 0XFF;	//非法数据
+	for(i=0;i<n;i++)
+	{
+		u8 *p=&buf[1+6*i];		//TPn_XH,XL,YH,YL
+		if(tp_dev.touchtype&0X01)//横屏
+		{
+			y[cnt]=((u16)(p[0]&0X0F)<<8)+p[1];
+			x[cnt]=((u16)(p[2]&0X0F)<<8)+p[3];
+		}else
+		{
+			x[cnt]=lcddev.width-(((u16)(p[0]&0X0F)<<8)+p[1]);
+			y[cnt]=((u16)(p[2]&0X0F)<<8)+p[3];
+		}
+		if(x[cnt]<lcddev.width&&y[cnt]<lcddev.height)cnt++;//丢弃坐标超出的点
+	}
+	return cnt;
+}
+
  
 
 
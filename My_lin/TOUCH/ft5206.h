@@ -46,6 +46,7 @@ u8 FT5206_WR_Reg(u16 reg,u8 *buf,u8 len);
 void FT5206_RD_Reg(u16 reg,u8 *buf,u8 len);
 u8 FT5206_Init(void);
 u8 FT5206_Scan(u8 mode);
+u8 FT5206_ReadPoints(u16 *x,u16 *y);
 
 #endif
 
@@ -1,6 +1,6 @@
 #include "gt9147.h"
 #include "touch.h"
-#include "ctiic.h"
+#include "hgq_i2c.h"
 #include "usart.h"
 #include "delay.h" 
 #include "string.h" 
@@ -65,23 +65,7 @@ u8 GT9147_Send_Cfg(u8 mode)
 //返回值:0,成功;1,失败.
 u8 GT9147_WR_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i;
-	u8 ret=0;
-	CT_IIC_Start();	
- 	CT_IIC_Send_Byte(GT_CMD_WR);   	//发送写命令 	 
-	CT_IIC_Wait_Ack();
-	CT_IIC_Send_Byte(reg>>8);   	//发送高8位地址
-	CT_IIC_Wait_Ack(); 	 										  		   
-	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
-	for(i=0;i<len;i++)
-	{	   
-    	CT_IIC_Send_Byte(buf[i]);  	//发数据
-		ret=CT_IIC_Wait_Ack();
-		if(ret)break;  
-	}
-    CT_IIC_Stop();					//产生一个停止条件	    
-	return ret; 
+	return HGQ_I2C_MemWrite(HGQ_I2C_CT,GT_CMD_WR>>1,reg,2,buf,len)!=HGQ_I2C_OK;
 }
 //从GT9147读出一次数据
 //reg:起始寄存器地址
@@ -89,22 +73,7 @@ u8 GT9147_WR_Reg(u16 reg,u8 *buf,u8 len)
 //len:读数据长度			  
 void GT9147_RD_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i; 
- 	CT_IIC_Start();	
- 	CT_IIC_Send_Byte(GT_CMD_WR);   //发送写命令 	 
-	CT_IIC_Wait_Ack();
- 	CT_IIC_Send_Byte(reg>>8);   	//发送高8位地址
-	CT_IIC_Wait_Ack(); 	 										  		   
- 	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
- 	CT_IIC_Start();  	 	   
-	CT_IIC_Send_Byte(GT_CMD_RD);   //发送读命令		   
-	CT_IIC_Wait_Ack();	   
-	for(i=0;i<len;i++)
-	{	   
-    	buf[i]=CT_IIC_Read_Byte(i==(len-1)?0:1); //发数据	  
-	} 
-    CT_IIC_Stop();//产生一个停止条件    
+	HGQ_I2C_MemRead(HGQ_I2C_CT,GT_CMD_WR>>1,reg,2,buf,len);
 } 
 //初始化GT9147触摸屏
 //返回值:0,初始化成功;1,初始化失败 
@@ -126,7 +95,7 @@ u8 GT9147_Init(void)
 	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;//输出模式
 	GPIO_Init(GPIOC, &GPIO_InitStructure);//初始化	
 	
-	CT_IIC_Init();      	//初始化电容屏的I2C总线  
+	HGQ_I2C_Init(HGQ_I2C_CT);	//初始化电容屏的I2C总线  
 	GT_RST=0;				//复位
 	delay_ms(10);
  	GT_RST=1;				//释放复位		    
@@ -257,6 +226,37 @@ u8 GT9147_Scan(u8 mode)
 	if(t>240)t=10;//重新从10开始计数
 	return res;
 }
+
+//一次连续读出状态寄存器和全部触点(中断模式下由触摸读取任务调用)
+//x,y:输出坐标,至少CT_MAX_TOUCH个
+//返回值:有效触点数;0XFF,没有新数据(缓冲区未就绪)
+u8 GT9147_ReadPoints(u16 *x,u16 *y)
+{
+	u8 buf[2+8*CT_MAX_TOUCH];	//0X814E状态,0X814F起每点8字节:ID,XL,XH,YL,YH,...
+	u8 i,n,cnt=0,temp=0;
+	GT9147_RD_Reg(GT_GSTID_REG,buf,sizeof(buf));
+	if((buf[0]&0X80)==0)return 0XFF;
+	GT9147_WR_Reg(GT_GSTID_REG,&temp,1);//清标志
+	n=buf[0]&0X0F;
+	if(n>CT_MAX_TOUCH)return 0XFF;
+	for(i=0;i<n;i++)
+	{
+		u8 *p=&buf[2+8*i];		//XL,XH,YL,YH
+		u16 a=((u16)p[1]<<8)+p[0],b=((u16)p[3]<<8)+p[2];
+		if(lcddev.id==0X5510||lcddev.id==0X9806||lcddev.id==0X7796)//与GT9147_Scan相同的坐标映射
+		{
+			if(tp_dev.touchtype&0X01){y[cnt]=a;x[cnt]=lcddev.width-b;}//横屏
+			else {x[cnt]=a;y[cnt]=b;}
+		}else
+		{
+			if(tp_dev.touchtype&0X01){x[cnt]=a;y[cnt]=b;}//横屏
+			else {y[cnt]=a;x[cnt]=lcddev.width-b;}
+		}
+		if(x[cnt]<lcddev.width&&y[cnt]<lcddev.height)cnt++;//丢弃坐标超出的点
+	}
+	return cnt;
+}
+
  
 
 
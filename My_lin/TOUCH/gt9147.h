@@ -43,6 +43,7 @@ u8 GT9147_WR_Reg(u16 reg,u8 *buf,u8 len);
 void GT9147_RD_Reg(u16 reg,u8 *buf,u8 len); 
 u8 GT9147_Init(void);
 u8 GT9147_Scan(u8 mode); 
+u8 GT9147_ReadPoints(u16 *x,u16 *y);
 #endif
 
 
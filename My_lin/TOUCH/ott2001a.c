@@ -1,6 +1,6 @@
 #include "ott2001a.h"
 #include "touch.h"
-#include "ctiic.h"
+#include "hgq_i2c.h"
 #include "usart.h"
 #include "delay.h" 
 //////////////////////////////////////////////////////////////////////////////////	 
@@ -24,23 +24,7 @@
 //返回值:0,成功;1,失败.
 u8 OTT2001A_WR_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i;
-	u8 ret=0;
-	CT_IIC_Start();	
- 	CT_IIC_Send_Byte(OTT_CMD_WR);   //发送写命令 	 
-	CT_IIC_Wait_Ack();
-	CT_IIC_Send_Byte(reg>>8);   	//发送高8位地址
-	CT_IIC_Wait_Ack(); 	 										  		   
-	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
-	for(i=0;i<len;i++)
-	{	   
-    	CT_IIC_Send_Byte(buf[i]);  	//发数据
-		ret=CT_IIC_Wait_Ack();
-		if(ret)break;  
-	}
-    CT_IIC_Stop();					//产生一个停止条件	    
-	return ret; 
+	return HGQ_I2C_MemWrite(HGQ_I2C_CT,OTT_CMD_WR>>1,reg,2,buf,len)!=HGQ_I2C_OK;
 }
 //从OTT2001A读出一次数据
 //reg:起始寄存器地址
@@ -48,22 +32,7 @@ u8 OTT2001A_WR_Reg(u16 reg,u8 *buf,u8 len)
 //len:读数据长度			  
 void OTT2001A_RD_Reg(u16 reg,u8 *buf,u8 len)
 {
-	u8 i; 
- 	CT_IIC_Start();	
- 	CT_IIC_Send_Byte(OTT_CMD_WR);   //发送写命令 	 
-	CT_IIC_Wait_Ack();
- 	CT_IIC_Send_Byte(reg>>8);   	//发送高8位地址
-	CT_IIC_Wait_Ack(); 	 										  		   
- 	CT_IIC_Send_Byte(reg&0XFF);   	//发送低8位地址
-	CT_IIC_Wait_Ack();  
- 	CT_IIC_Start();  	 	   
-	CT_IIC_Send_Byte(OTT_CMD_RD);   //发送读命令		   
-	CT_IIC_Wait_Ack();	   
-	for(i=0;i<len;i++)
-	{	   
-    	buf[i]=CT_IIC_Read_Byte(i==(len-1)?0:1); //发数据	  
-	} 
-    CT_IIC_Stop();//产生一个停止条件    
+	HGQ_I2C_MemRead(HGQ_I2C_CT,OTT_CMD_WR>>1,reg,2,buf,len);
 }
 //传感器打开/关闭操作
 //cmd:1,打开传感器;0,关闭传感器
@@ -94,7 +63,7 @@ u8 OTT2001A_Init(void)
 	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;//输出模式
 	GPIO_Init(GPIOC, &GPIO_InitStructure);//初始化	
  
-	CT_IIC_Init();      	//初始化电容屏的I2C总线  
+	HGQ_I2C_Init(HGQ_I2C_CT);	//初始化电容屏的I2C总线  
 	OTT_RST=0;				//复位
 	delay_ms(100);
  	OTT_RST=1;				//释放复位		    
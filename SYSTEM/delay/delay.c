@@ -63,6 +63,15 @@ void delay_ms(u16 nms)
 	delay_us((u32)(nms*1000));
 }
 
+//  DWT ڼ (DWT->CYCCNT)
+// ģĺʱͳƶ,main() ﴴ֮ǰһ,طٸԴ
+void delay_cyc_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 // ʱ xms (Ϊ˼ݾɴ)
 void delay_xms(u16 nms)
 {
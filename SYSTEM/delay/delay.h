@@ -20,6 +20,7 @@
 void delay_init(u8 SYSCLK);
 void delay_ms(u16 nms);
 void delay_us(u32 nus);
+void delay_cyc_init(void);
 
 #endif
 
@@ -0,0 +1,6 @@
+//由 tools/font_subset.py 生成,请勿手工修改
+//当前为空表:用 python tools/font_subset.py --font 16=GBK16.FON 生成后提交
+#include "text.h"
+
+const _hz_subset hz_subset[1]={{0,0,0,0}};
+const u8 hz_subset_num=0;
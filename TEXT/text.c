@@ -18,8 +18,47 @@
 //All rights reserved									  
 ////////////////////////////////////////////////////////////////////////////////// 	 
  
+#if HZ_CACHE_NUM>0
+//汉字点阵缓存(LRU)
+//键:(GBK码,字号),满时替换最久未使用的一项;本身不加锁,依赖调用者持有xMutexUI
+//(弹窗也会在rfid_task/net_task里绘制,调度器启动前的预读除外)
+typedef struct
+{
+	u16 code;		//GBK码(高字节在前),0表示空
+	u8  size;		//字号
+	u32 stamp;		//最近一次使用的时刻(访问计数)
+	u8  mat[72];	//点阵数据,按24x24最大值分配
+}_hz_cache;
+static _hz_cache hz_cache[HZ_CACHE_NUM];
+static u32 hz_cache_clock=0;
+static u32 hz_cache_hit=0,hz_cache_miss=0;
+#endif
+
+//在内部Flash字模子集中查找(二分)
+//返回值:点阵数据地址,0表示不在子集中
+static const u8 *HZ_Subset_Find(u16 key,u8 size,u8 csize)
+{
+	u8 i;
+	for(i=0;i<hz_subset_num;i++)
+	{
+		const _hz_subset *t=&hz_subset[i];
+		s16 lo=0,hi=(s16)t->num-1,mid;
+		if(t->size!=size)continue;
+		while(lo<=hi)
+		{
+			mid=(lo+hi)/2;
+			if(t->code[mid]==key)return t->mat+(u32)mid*csize;
+			if(t->code[mid]<key)lo=mid+1;
+			else hi=mid-1;
+		}
+		break;
+	}
+	return 0;
+}
+
 //code 字符指针开始
 //从字库中查找出字模
+//查找顺序:内部Flash子集->SRAM缓存->W25Q128字库
 //code 字符串的开始地址,GBK码
 //mat  数据存放地址 (size/8+((size%8)?1:0))*(size) bytes大小	
 //size:字体大小
@@ -29,13 +68,51 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 	unsigned char i;					  
 	unsigned long foffset; 
 	u8 csize=(size/8+((size%8)?1:0))*(size);//得到字体一个字符对应点阵集所占的字节数	 
+	u8 *dst=mat;
+	const u8 *sub;
+#if HZ_CACHE_NUM>0
+	_hz_cache *slot=0;
+#endif
 	qh=*code;
 	ql=*(++code);
-	if(qh<0x81||ql<0x40||ql==0xff||qh==0xff)//非 常用汉字
+	if(qh<0x81||ql<0x40||ql==0xff||qh==0xff||(size!=12&&size!=16&&size!=24))//非 常用汉字
 	{   		    
 	    for(i=0;i<csize;i++)*mat++=0x00;//填充满格
 	    return; //结束访问
 	}          
+	sub=HZ_Subset_Find(((u16)qh<<8)|ql,size,csize);
+	if(sub)		//固定界面文字,不依赖SPI Flash
+	{
+		memcpy(mat,sub,csize);
+		return;
+	}
+	if(ftinfo.fontok!=0XAA)	//字库不可用,不去读无效数据
+	{
+	    for(i=0;i<csize;i++)*mat++=0x00;
+	    return;
+	}
+#if HZ_CACHE_NUM>0
+	{
+		u16 key=((u16)qh<<8)|ql;
+		slot=&hz_cache[0];
+		for(i=0;i<HZ_CACHE_NUM;i++)
+		{
+			if(hz_cache[i].code==key&&hz_cache[i].size==size)	//命中
+			{
+				hz_cache[i].stamp=++hz_cache_clock;
+				hz_cache_hit++;
+				memcpy(mat,hz_cache[i].mat,csize);
+				return;
+			}
+			if(hz_cache[i].stamp<slot->stamp)slot=&hz_cache[i];	//记下最久未用(空项stamp为0)
+		}
+		hz_cache_miss++;
+		slot->code=key;
+		slot->size=size;
+		slot->stamp=++hz_cache_clock;
+		dst=slot->mat;		//直接读到缓存项,再复制给调用者
+	}
+#endif
 	if(ql<0x7f)ql-=0x40;//注意!
 	else ql-=0x41;
 	qh-=0x81;   
@@ -43,17 +120,47 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 	switch(size)
 	{
 		case 12:
-			W25QXX_Read(mat,foffset+ftinfo.f12addr,csize);
+			W25QXX_Read(dst,foffset+ftinfo.f12addr,csize);
 			break;
 		case 16:
-			W25QXX_Read(mat,foffset+ftinfo.f16addr,csize);
+			W25QXX_Read(dst,foffset+ftinfo.f16addr,csize);
 			break;
 		case 24:
-			W25QXX_Read(mat,foffset+ftinfo.f24addr,csize);
+			W25QXX_Read(dst,foffset+ftinfo.f24addr,csize);
 			break;
 			
 	}     												    
+#if HZ_CACHE_NUM>0
+	memcpy(mat,dst,csize);
+#endif
 }  
+//预读字符串中的汉字到缓存(开机时对固定界面文字调用一次)
+//str:GBK字符串;size:字号
+void HZ_Cache_Prewarm(const u8 *str,u8 size)
+{
+#if HZ_CACHE_NUM>0
+	u8 mat[72];
+	while(*str)
+	{
+		if(*str>0x80&&str[1])
+		{
+			Get_HzMat((u8*)str,mat,size);
+			str+=2;
+		}else str++;
+	}
+#endif
+}
+//读取缓存命中/未命中次数
+void HZ_Cache_GetStats(u32 *hit,u32 *miss)
+{
+#if HZ_CACHE_NUM>0
+	*hit=hz_cache_hit;
+	*miss=hz_cache_miss;
+#else
+	*hit=0;
+	*miss=0;
+#endif
+}
 //显示一个指定大小的汉字
 //x,y :汉字的坐标
 //font:汉字GBK码
@@ -61,29 +168,10 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 //mode:0,正常显示,1,叠加显示	   
 void Show_Font(u16 x,u16 y,u8 *font,u8 size,u8 mode)
 {
-	u8 temp,t,t1;
-	u16 y0=y;
 	u8 dzk[72];   
-	u8 csize=(size/8+((size%8)?1:0))*(size);//得到字体一个字符对应点阵集所占的字节数	 
 	if(size!=12&&size!=16&&size!=24)return;	//不支持的size
 	Get_HzMat(font,dzk,size);	//得到相应大小的点阵数据 
-	for(t=0;t<csize;t++)
-	{   												   
-		temp=dzk[t];			//得到点阵数据                          
-		for(t1=0;t1<8;t1++)
-		{
-			if(temp&0x80)LCD_Fast_DrawPoint(x,y,POINT_COLOR);
-			else if(mode==0)LCD_Fast_DrawPoint(x,y,BACK_COLOR); 
-			temp<<=1;
-			y++;
-			if((y-y0)==size)
-			{
-				y=y0;
-				x++;
-				break;
-			}
-		}  	 
-	}  
+	LCD_Blit_Mono(x,y,size,size,dzk,mode);	//设置一次窗口后整块输出
 }
 //在指定位置开始显示一个字符串	    
 //支持自动换行
@@ -14,8 +14,25 @@
 //Copyright(C) 广州市星翼电子科技有限公司 2014-2024
 //All rights reserved									  
 ////////////////////////////////////////////////////////////////////////////////// 	 
+//内部Flash字模子集(由tools/font_subset.py从源码里的GBK常量生成TEXT/hzsub.c)
+//每个字号一项,code按升序排列,mat按code顺序存放点阵
+typedef struct
+{
+	u8 size;				//字号
+	u16 num;				//字数
+	const u16 *code;		//GBK码(高字节在前)
+	const u8 *mat;			//点阵数据,每字csize字节
+}_hz_subset;
+extern const _hz_subset hz_subset[];
+extern const u8 hz_subset_num;
+
+//汉字点阵缓存项数(每项约80字节),0表示不使用缓存
+//需大于开机预读的字数(界面固定文字+弹窗+座位名约58字),否则预读的字互相挤掉
+#define HZ_CACHE_NUM	64
  					     
 void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size);			//得到汉字的点阵码
+void HZ_Cache_Prewarm(const u8 *str,u8 size);							//预读字符串中的汉字到缓存
+void HZ_Cache_GetStats(u32 *hit,u32 *miss);								//缓存命中/未命中次数
 void Show_Font(u16 x,u16 y,u8 *font,u8 size,u8 mode);					//在指定位置显示一个汉字
 void Show_Str(u16 x,u16 y,u16 width,u16 height,u8*str,u8 size,u8 mode);	//在指定位置显示一个字符串 
 void Show_Str_Mid(u16 x,u16 y,u8*str,u8 size,u8 len);
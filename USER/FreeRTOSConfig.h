@@ -66,6 +66,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configGENERATE_RUN_TIME_STATS	0
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	3	/* index 0: task wake-ups, index 1: AT command futures, index 2: I2C transfers */
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -2,6 +2,8 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "queue.h"
+#include "timers.h"
 #include "delay.h"
 #include "usart.h"
 #include <stdio.h>
@@ -14,12 +16,19 @@
 #include "text.h"
 #include "led.h"
 #include "hgq_ui.h"
+#include "hgq_widget.h"
+#include "hgq_touch.h"
+#include "hgq_i2c.h"
 #include "hgq_vl53l0x.h"
 #include "hgq_aht20.h"
 #include "hgq_bh1750.h"
+#include "hgq_sensor.h"
 #include "hgq_rc522.h"
 #include "hgq_esp8266.h"
+#include "hgq_at.h"
 #include "hgq_usart.h"
+#include "hgq_telem.h"
+#include "hgq_journal.h"
 
 /* ==================  ================== */
 #define WIFI_SSID       "hhh"
@@ -30,10 +39,32 @@
 #define MQTT_PASS       ""
 
 #define DEV_ID          "A18" 
+/* ָ⣺ר + ȫ㲥 ( time_sync)ٽλ */
+#define MQTT_CMD_TOPIC    "stm32/cmd/" DEV_ID
+#define MQTT_BCAST_TOPIC  "stm32/bcast"
 #define SEAT_NAME_GBK   "\x41\xC7\xF8\x2D\x31\x38\xBA\xC5" // A-18
 
 #define TOF_OCCUPIED_MM 380  
 
+/* ң /  / ݲʱϱ仯 */
+#define TELEM_DB_TEMP_X10   3     /* 0.3  */
+#define TELEM_DB_HUMI       2     /* 2 %RH */
+#define TELEM_DB_LUX        30    /* 30 lx */
+#define TELEM_DB_TOF_MM     40    /* 40 mm */
+#define TELEM_HEARTBEAT_S   60    /*  60s رһ */
+#define TELEM_BATCH_N       4     /* ÿϢ 4  */
+#define TELEM_BATCH_MAX_S   20    /*  20s */
+
+/* ȣԵĲ / תʱ (ms)ͬʱת */
+#define SENS_AHT_PERIOD_MS  2000  /* AHT20  >= 2s */
+#define SENS_AHT_CONV_MS    80
+#define SENS_LUX_PERIOD_MS  250   /* BH1750 ߷ֱģʽ120ms һֵ */
+#define SENS_TOF_CONTINUOUS 1     /* 1: VL53L0X ࣬GPIO1  PB12 (ݾжϣûʱԶΪѯ)0: ﵥβ */
+#define SENS_TOF_BUDGET_US  20000 /* ģʽʱԤ */
+#define SENS_TOF_INTERVAL_MS 25   /* ģʽ40Hz */
+#define SENS_TOF_PERIOD_MS  50    /* ΣԼ 33ms һβȡļ */
+#define SENS_TOF_CONV_MS    33
+
 /* FreeRTOS ȼջ */
 #define START_TASK_PRIO     1
 #define START_STK_SIZE      512
@@ -50,8 +81,44 @@
 #define RFID_TASK_PRIO      3
 #define RFID_STK_SIZE       512
 
-#define TASK_QUEUE_SIZE     10
-#define TASK_CMD_LEN        256
+#define NET_CMD_QUEUE_LEN   8     /* ѽָ */
+
+/* ui_task ֻյ֪ͨʱУֵ֪ͨλʾԭ */
+#define UI_EV_STATE         (1u << 0)   /* ҵ / ״̬仯 */
+#define UI_EV_SENSOR        (1u << 1)   /* ֵ仯 */
+#define UI_EV_REDRAW        (1u << 2)   /* رաǩǩ˵Ҫػ */
+#define UI_EV_TOUCH         (1u << 3)   /*  */
+#define UI_EV_CLOCK         (1u << 4)   /* 1s ʱ */
+#define UI_EV_FADE          (1u << 5)   /* Ƚһ */
+#define UI_EV_DRAW          (UI_EV_STATE | UI_EV_SENSOR | UI_EV_REDRAW | UI_EV_CLOCK | UI_EV_FADE)
+#define UI_FADE_MS          100   /* Ƚ䲽 */
+#define UI_TOUCH_POLL_MS    100   /* ޴ж (/OTT2001A) ʱĲѯ */
+
+/*  1 ʱӡ W25Q128 ȡʽٶȣ/PCB ȷϸʱӿɿ */
+#define W25Q_BENCH_ON_BOOT  0
+/*  1 ʱӡٶȣȽ lcd.h  LCD_FIXED_CTRL /̶ֱ뷽ʽ */
+#define LCD_BENCH_ON_BOOT   0
+
+/* ߴ洢ת (W25Q128 ־) */
+#define JRN_TELEM_PERIOD_S  60    /* ʱң⽵ÿ 60s һ */
+#define JRN_REPLAY_SLOTS    4     /* ٣ÿ 4  50ms һ */
+#define JRN_ACK_EVERY       8     /* ÿ 8 дһν */
+#define JRN_EV_CHECKIN      1
+#define JRN_EV_CHECKOUT     2
+
+/* Ƹ v1 (AT+MQTTPUBRAW)ֽСˣλȡ⣺
+ *   [0] 0xB1 (4λ 0xB Ϊʶ4λΪ汾)  [1] 
+ *   telemetry(1): int16 temp_x10, uint8 humi, uint16 lux (0xFFFF=쳣), uint16 tof_mm
+ *   state(2):     uint8 state (0 FREE/1 RESERVED/2 IN_USE), uint8 flags (bit0 power, bit1 light, bit2 auto),
+ *                 uint8 uid_len, uid[uid_len]
+ *   telemetry_batch(3): uint8 n, n x { uint16 age_s, int16 temp_x10, uint8 humi, uint16 lux, uint16 tof_mm }
+ *                 age_s Ϊ෢ʱ̵
+ * ı key=value Ϊ˸ʽısync Я fmt=1 cmd=fmt&v=1 л
+ */
+#define BIN_MAGIC_V1        0xB1
+#define BIN_T_TELEMETRY     1
+#define BIN_T_STATE         2
+#define BIN_T_TELEM_BATCH   3
 
 /* ģʽ */
 typedef enum {
@@ -61,17 +128,45 @@ typedef enum {
     OP_WARNING 
 } OpMode_t;
 
-/* нṹ */
+/* ·ָURC صһΣֵн net_task */
+typedef enum {
+    NC_NONE = 0,
+    NC_TIME_SYNC,       /* time=HH:MM:SS */
+    NC_FMT,             /* v=ظʽ汾 */
+    NC_DENY,            /*  seat_id 뱾һ */
+    NC_RESERVE,         /* user / uid / expires_at */
+    NC_CHECKIN_OK,
+    NC_RELEASE,
+    NC_CHECKOUT_OK
+} NetCmdType;
+
+typedef struct {
+    uint8_t type;           /* NetCmdType */
+    uint8_t has_time;
+    uint8_t h, m, s;
+    uint8_t fmt_v;
+    char    uid[24];
+    char    user[20];       /*  ui.user_str ͬ */
+    char    expires[6];     /* HH:MM */
+} NetCmd;
+
+/* ַ key=value ״ֵ̬ضϣɷֶι */
 typedef struct {
-    char cmds[TASK_QUEUE_SIZE][TASK_CMD_LEN];
-    volatile uint16_t head;
-    volatile uint16_t tail;
-} TaskQueue_t;
+    NetCmd  cmd;
+    uint8_t seat_ok;        /* ֹ seat_id=DEV_ID */
+    uint8_t in_val;
+    uint8_t klen, vlen;
+    char    key[12];
+    char    val[24];
+} NetCmdParser;
 
 /* ================== ȫֱ ================== */
 /*  */
 SemaphoreHandle_t xMutexUI;   
-SemaphoreHandle_t xMutexESP;  
+
+/* ʱ1s ʱӡȽ */
+static TimerHandle_t xTimerClock;
+static TimerHandle_t xTimerFade;
 
 /*  */
 TaskHandle_t StartTask_Handler;
@@ -83,19 +178,23 @@ TaskHandle_t RFIDTask_Handler;
 /* ҵȫֱ */
 static OpMode_t g_op_mode = OP_NORMAL;
 static uint32_t g_popup_ts = 0; 
-static TaskQueue_t g_task_queue = {0};
+static QueueHandle_t g_cmd_queue;
+static uint32_t g_cmd_dropped = 0;
 
 static char g_state[12] = "FREE";
 static char g_expect_uid[24] = "";
 static HGQ_UI_Data ui = {0};
 static HGQ_VL53L0X_Handle g_tof;
-static uint16_t g_lux = 0, g_tof_mm = 0;
 static uint8_t  g_bh1750_ok = 0;
+/* صȡ (ֻ sensor_task )ÿͳһɿ */
+static HGQ_SensorSnap g_sens;
+static u8       g_sens_fresh = 0;   /* λHGQ_SNAP_xxx */
+static uint8_t  g_touch_irq = 0;    /* 1: ж϶ȡϱui_task ٲѯ */
 static uint8_t  g_rfid_uid[10], g_rfid_has_card = 0;
 static char     g_card_hex[24];
 static u8       g_mqtt_ok = 0;
-static uint8_t  g_need_ui_refresh = 0; 
-static uint8_t  g_force_redraw = 0; 
+static u8       g_bin_fmt = 0;   /* ȷ϶Ƹ */
+static volatile u8 g_state_pub = 0; /*  net_task ϱ״̬ (ֻ net_task ) */
 
 static uint8_t  g_time_h = 12, g_time_m = 0, g_time_s = 0; 
 static char     g_time_str[10] = "--:--"; 
@@ -107,23 +206,38 @@ const u8 STR_POP_ERR[]  = {0xBF,0xA8,0xBA,0xC5,0xB4,0xED,0xCE,0xF3,0x00}; // 
 const u8 STR_POP_WARN[] = {0xC7,0xEB,0xCF,0xC8,0xB5,0xE3,0xBB,0xF7,0xC6,0xC1,0xC4,0xBB,0x00}; // ȵĻ
 
 /* ================== ʵ ================== */
+/* ֪ͨ ui_task ˢ () */
+static void UI_Notify(uint32_t ev) {
+    if(UITask_Handler) xTaskNotify(UITask_Handler, ev, eSetBits);
+}
+static void UI_ClockCb(TimerHandle_t t) { (void)t; UI_Notify(UI_EV_CLOCK); }
+static void UI_FadeCb(TimerHandle_t t)  { (void)t; UI_Notify(UI_EV_FADE); }
+static void UI_TouchCb(void)            { UI_Notify(UI_EV_TOUCH); }
 
-static int TaskQueue_Push(const char *cmd_str) {
-    uint16_t next = (g_task_queue.head + 1) % TASK_QUEUE_SIZE;
-    if (next == g_task_queue.tail) return 0;
-    strncpy(g_task_queue.cmds[g_task_queue.head], cmd_str, TASK_CMD_LEN - 1);
-    g_task_queue.cmds[g_task_queue.head][TASK_CMD_LEN - 1] = '\0';
-    g_task_queue.head = next;
-    return 1;
+/* xMutexUI ͳƵȴʱ䣺һβȣòżΪ */
+static struct {
+    u32 takes, waits;               /*  / ҪȴĴ */
+    u32 wait_us, max_us;            /* ۼ / ȴ */
+    const char *max_task;
+} g_uilock;
+
+static void UI_Lock(void) {
+    u32 t0, us;
+    g_uilock.takes++;
+    if(xSemaphoreTake(xMutexUI, 0) == pdTRUE) return;
+    t0 = DWT->CYCCNT;
+    xSemaphoreTake(xMutexUI, portMAX_DELAY);
+    us = (DWT->CYCCNT - t0) / (SystemCoreClock / 1000000);
+    g_uilock.waits++;
+    g_uilock.wait_us += us;
+    if(us > g_uilock.max_us) { g_uilock.max_us = us; g_uilock.max_task = pcTaskGetName(NULL); }
 }
 
-static int TaskQueue_Pop(char *out_buf) {
-    if (g_task_queue.head == g_task_queue.tail) return 0;
-    strncpy(out_buf, g_task_queue.cmds[g_task_queue.tail], TASK_CMD_LEN);
-    g_task_queue.tail = (g_task_queue.tail + 1) % TASK_QUEUE_SIZE;
-    return 1;
+static void UI_Unlock(void) {
+    xSemaphoreGive(xMutexUI);
 }
 
+
 static void Topic_Make(char *out, u16 out_sz, const char *suffix) {
     snprintf(out, out_sz, "server/%s/%s", suffix, DEV_ID);
 }
@@ -135,26 +249,60 @@ static void UID_ToHexNoSpace(const uint8_t *uid, uint8_t uid_len, char *out, uin
     }
 }
 
-static u8 KV_Get(const char *kv, const char *key, char *out, u16 out_sz) {
-    const char *p = kv; 
-    u16 klen = strlen(key);
-    while((p = strstr(p, key)) != 0) {
-        char prev = (p == kv) ? 0 : *(p-1);
-        if(p == kv || prev == '&' || prev == '\"' || prev == ',' || prev == ' ') {
-            if(p[klen] == '=') {
-                const char *v = p + klen + 1;
-                u16 n = 0;
-                while(v[n] != 0 && v[n] != '&' && v[n] != '\"' && v[n] != '\r' && v[n] != '\n') {
-                    n++;
-                }
-                if(n >= out_sz) n = out_sz - 1;
-                memcpy(out, v, n); out[n] = 0; 
-                return 1;
-            }
+static uint8_t Two_Digits(const char *p) { return (uint8_t)((p[0] - '0') * 10 + (p[1] - '0')); }
+
+/* һֶνдӦԱδ֪ */
+static void NetCmd_Field(NetCmdParser *ps) {
+    NetCmd *c = &ps->cmd;
+    const char *k = ps->key, *v = ps->val;
+    ps->val[ps->vlen] = 0;
+    if(strcmp(k, "cmd") == 0) {
+        if     (strcmp(v, "time_sync") == 0)   c->type = NC_TIME_SYNC;
+        else if(strcmp(v, "fmt") == 0)         c->type = NC_FMT;
+        else if(strcmp(v, "deny") == 0)        c->type = NC_DENY;
+        else if(strcmp(v, "reserve") == 0)     c->type = NC_RESERVE;
+        else if(strcmp(v, "checkin_ok") == 0)  c->type = NC_CHECKIN_OK;
+        else if(strcmp(v, "release") == 0)     c->type = NC_RELEASE;
+        else if(strcmp(v, "checkout_ok") == 0) c->type = NC_CHECKOUT_OK;
+    }
+    else if(strcmp(k, "seat_id") == 0) ps->seat_ok = (strcmp(v, DEV_ID) == 0);
+    else if(strcmp(k, "time") == 0 && ps->vlen >= 8) {
+        c->h = Two_Digits(v); c->m = Two_Digits(v + 3); c->s = Two_Digits(v + 6);
+        c->has_time = 1;
+    }
+    else if(strcmp(k, "v") == 0) c->fmt_v = (uint8_t)atoi(v);
+    else if(strcmp(k, "uid") == 0) strncpy(c->uid, v, sizeof(c->uid) - 1);
+    else if(strcmp(k, "user") == 0) strncpy(c->user, v, sizeof(c->user) - 1);
+    else if(strcmp(k, "expires_at") == 0 && ps->vlen >= 16) memcpy(c->expires, v + 11, 5);  /* YYYY-MM-DD HH:MM:SS */
+}
+
+static void NetCmd_Begin(NetCmdParser *ps) {
+    memset(ps, 0, sizeof(*ps));
+}
+
+static void NetCmd_Feed(NetCmdParser *ps, const char *p, uint16_t n) {
+    for(uint16_t i = 0; i < n; i++) {
+        char ch = p[i];
+        if(ch == '&' || ch == '"' || ch == '\r' || ch == '\n') {
+            if(ps->in_val) NetCmd_Field(ps);
+            ps->in_val = 0; ps->klen = 0; ps->vlen = 0;
+        } else if(!ps->in_val) {
+            if(ch == '=') { ps->key[ps->klen] = 0; ps->in_val = 1; }
+            else if(ps->klen < sizeof(ps->key) - 1) ps->key[ps->klen++] = ch;
+        } else if(ps->vlen < sizeof(ps->val) - 1) {
+            ps->val[ps->vlen++] = ch;
         }
-        p += klen;
     }
-    return 0;
+}
+
+/*  1 = õҪָ */
+static uint8_t NetCmd_End(NetCmdParser *ps, NetCmd *out) {
+    if(ps->in_val) NetCmd_Field(ps);
+    ps->in_val = 0;
+    if(ps->cmd.type >= NC_DENY && !ps->seat_ok) return 0;   /* λָ */
+    if(ps->cmd.type == NC_NONE) return 0;
+    *out = ps->cmd;
+    return 1;
 }
 
 static int Calc_Auto_Brightness(int lux) {
@@ -167,33 +315,123 @@ static int Calc_Auto_Brightness(int lux) {
     return bri;
 }
 
-static void MQTT_PubTelemetry(void) {
+static void Put_U16LE(u8 *p, u16 v) { p[0] = (u8)v; p[1] = (u8)(v >> 8); }
+
+/* һңıʽɰݣ s=age,temp_x10,humi,lux,tof;... */
+static void MQTT_PubTelemetry(const HGQ_TelemEntry *e, uint8_t n) {
     char topic[64], msg[196];
+    uint32_t now = xTaskGetTickCount();
     Topic_Make(topic, sizeof(topic), "telemetry");
-    snprintf(msg, sizeof(msg), "type=telemetry&seat_id=%s&temp=%d.%d&humi=%d&lux=%d&tof_mm=%d", 
-             DEV_ID, ui.temp_x10/10, ui.temp_x10%10, ui.humi, ui.lux, g_tof_mm);
+    if(g_bin_fmt) {
+        u8 b[3 + HGQ_TELEM_BATCH_MAX * 9], *p = &b[3];
+        b[0] = BIN_MAGIC_V1; b[1] = BIN_T_TELEM_BATCH; b[2] = n;
+        for(uint8_t i = 0; i < n; i++, p += 9) {
+            Put_U16LE(&p[0], (u16)((now - e[i].t_ms) / 1000));
+            Put_U16LE(&p[2], (u16)e[i].s.temp_x10);
+            p[4] = e[i].s.humi;
+            Put_U16LE(&p[5], e[i].s.lux < 0 ? 0xFFFF : (u16)e[i].s.lux);
+            Put_U16LE(&p[7], e[i].s.tof_mm);
+        }
+        if(HGQ_ESP8266_MQTTPUBRAW_Fast(topic, b, 3 + n * 9, 0)) return;
+        g_bin_fmt = 0;
+    }
+    if(n == 1) {
+        snprintf(msg, sizeof(msg), "type=telemetry&seat_id=%s&temp=%d.%d&humi=%d&lux=%d&tof_mm=%d&age=%lu", 
+                 DEV_ID, e[0].s.temp_x10/10, abs(e[0].s.temp_x10%10), e[0].s.humi, e[0].s.lux, e[0].s.tof_mm,
+                 (unsigned long)((now - e[0].t_ms) / 1000));
+    } else {
+        int len = snprintf(msg, sizeof(msg), "type=telemetry&seat_id=%s&n=%d&s=", DEV_ID, n);
+        for(uint8_t i = 0; i < n && len < (int)sizeof(msg); i++) {
+            len += snprintf(msg + len, sizeof(msg) - len, "%s%lu,%d,%d,%d,%d", i ? ";" : "",
+                            (unsigned long)((now - e[i].t_ms) / 1000), e[i].s.temp_x10, e[i].s.humi, e[i].s.lux, e[i].s.tof_mm);
+        }
+    }
     HGQ_ESP8266_MQTTPUB_Fast(topic, msg, 0); 
 }
 
 static void MQTT_PubState(void) {
     char topic[64], msg[196];
     Topic_Make(topic, sizeof(topic), "state");
+    HGQ_Telem_Force();      /* ״̬仯ʱһβ¼õʱĻ */
+    if(g_bin_fmt) {
+        u8 b[5 + sizeof(g_expect_uid)], n = (u8)strlen(g_expect_uid);
+        b[0] = BIN_MAGIC_V1; b[1] = BIN_T_STATE;
+        b[2] = strcmp(g_state, "IN_USE") == 0 ? 2 : (strcmp(g_state, "RESERVED") == 0 ? 1 : 0);
+        b[3] = 0x01 | (ui.light_on ? 0x02 : 0) | (ui.auto_mode ? 0x04 : 0);
+        b[4] = n;
+        memcpy(&b[5], g_expect_uid, n);
+        if(HGQ_ESP8266_MQTTPUBRAW_Fast(topic, b, 5 + n, 0)) return;
+        g_bin_fmt = 0;
+    }
     snprintf(msg, sizeof(msg), "type=state&seat_id=%s&state=%s&uid=%s&power=1&light=%d&light_mode=%s",
              DEV_ID, g_state, g_expect_uid, ui.light_on, ui.auto_mode?"AUTO":"MANUAL");
     HGQ_ESP8266_MQTTPUB_Fast(topic, msg, 0);
 }
 
+/* ͬͬʱֵ֧ĶƸذ汾 */
 static void MQTT_PubSync(void) {
     char topic[64], msg[64];
     Topic_Make(topic, sizeof(topic), "state"); 
-    snprintf(msg, sizeof(msg), "type=sync&seat_id=%s", DEV_ID);
+    snprintf(msg, sizeof(msg), "type=sync&seat_id=%s&fmt=%d", DEV_ID, BIN_MAGIC_V1 & 0x0F);
     HGQ_ESP8266_MQTTPUB_Fast(topic, msg, 0);
 }
 
-static void MQTT_PubEvent(const char *msg_kv) {
-    char topic[64];
-    Topic_Make(topic, sizeof(topic), "event");
-    HGQ_ESP8266_MQTTPUB_Fast(topic, (char*)msg_kv, 0);
+/* ˢ¼һд־ net_task ģ OK ȷϣdata = cmd, uid_len, uid[] */
+static uint32_t Journal_Event(uint8_t cmd, const uint8_t *uid, uint8_t uid_len) {
+    uint8_t d[2 + 10];
+    if(uid_len > 10) uid_len = 10;
+    d[0] = cmd; d[1] = uid_len;
+    memcpy(&d[2], uid, uid_len);
+    return HGQ_Journal_Append(JRN_T_EVENT, d, 2 + uid_len);
+}
+
+/*
+ * һ־¼ net_task ÿ JRN_REPLAY_SLOTS ĵһ
+ * һ (ģ OK) ȷϲȡһʧ´طͬһϢ ep+seq ȥأ
+ * ϵڵļ¼ age () ʱ
+ */
+static HGQ_AT_Future s_replay_fut;
+static uint32_t s_replay_seq = 0;   /* ڷļ¼0 =  */
+static uint8_t  s_replay_unsaved = 0;
+
+static void Journal_Replay(void) {
+    HGQ_JournalRec r;
+    char topic[64], msg[160], age[20] = "", hex[24];
+
+    if(s_replay_seq) {
+        if(s_replay_fut.result == HGQ_AT_PENDING) return;
+        if(s_replay_fut.result == HGQ_AT_OK) {
+            HGQ_Journal_Ack(s_replay_seq);
+            if(++s_replay_unsaved >= JRN_ACK_EVERY) { s_replay_unsaved = 0; HGQ_Journal_Commit(); }
+        }
+        s_replay_seq = 0;
+        return;
+    }
+    if(!HGQ_Journal_Peek(&r)) {
+        if(s_replay_unsaved) { s_replay_unsaved = 0; HGQ_Journal_Commit(); }
+        return;
+    }
+    if(r.boot == HGQ_Journal_Boot())
+        snprintf(age, sizeof(age), "&age=%lu", (unsigned long)(xTaskGetTickCount() / configTICK_RATE_HZ - r.up_s));
+
+    if(r.type == JRN_T_EVENT) {
+        UID_ToHexNoSpace(&r.data[2], r.data[1], hex, sizeof(hex));
+        Topic_Make(topic, sizeof(topic), "event");
+        snprintf(msg, sizeof(msg), "type=event&cmd=%s&uid=%s&seat_id=%s&ep=%lu&seq=%lu%s",
+                 r.data[0] == JRN_EV_CHECKIN ? "checkin" : "checkout", hex, DEV_ID,
+                 (unsigned long)HGQ_Journal_Epoch(), (unsigned long)r.seq, age);
+    } else {
+        HGQ_TelemSample ts;
+        memcpy(&ts, r.data, sizeof(ts));
+        Topic_Make(topic, sizeof(topic), "telemetry");
+        snprintf(msg, sizeof(msg), "type=telemetry&seat_id=%s&temp=%d.%d&humi=%d&lux=%d&tof_mm=%d&ep=%lu&seq=%lu%s",
+                 DEV_ID, ts.temp_x10/10, abs(ts.temp_x10%10), ts.humi, ts.lux, ts.tof_mm,
+                 (unsigned long)HGQ_Journal_Epoch(), (unsigned long)r.seq, age);
+    }
+    if(HGQ_ESP8266_MQTTPUB_Async(topic, msg, 0, &s_replay_fut)) {
+        s_replay_seq = r.seq;
+        printf("[־]  #%lu: %s\r\n", (unsigned long)r.seq, msg);
+    }
 }
 
 /* ==================  ================== */
@@ -240,6 +478,7 @@ void rfid_task(void *pvParameters);
 int main(void) {
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4); 
     delay_init(168); 
+    delay_cyc_init();   /* DWT ڼUI //ؼ/ͳһʹ */
     uart_init(115200);      
     HGQ_USART2_Init(115200); 
     
@@ -249,9 +488,16 @@ int main(void) {
     LED_Init(); printf("[Լ] LEDָʾƳʼ......OK\r\n");
     LCD_Init(); printf("[Լ] LCDĻײʼ....OK\r\n");
     LCD_Display_Dir(1); 
+#if LCD_BENCH_ON_BOOT
+    LCD_Bench(100000);
+#endif
     tp_dev.init(); printf("[Լ] ݴʼ.....OK\r\n");
     W25QXX_Init(); printf("[Լ] W25Q128 Flashʼ..OK\r\n");
+#if W25Q_BENCH_ON_BOOT
+    W25QXX_Bench(0, 1024 * 1024);
+#endif
     font_init(); printf("[Լ] ֿϵͳʼ...OK\r\n");
+    HGQ_Journal_Init(); printf("[Լ] ־.......OK\r\n");
     
     printf("[SYSTEM] ſ...\r\n");
     Boot_Animation();
@@ -260,6 +506,8 @@ int main(void) {
     printf("========================================\r\n\r\n");
     
     HGQ_UI_Init(); 
+    HZ_Cache_Prewarm(STR_POP_IN, 16); HZ_Cache_Prewarm(STR_POP_OUT, 16);
+    HZ_Cache_Prewarm(STR_POP_ERR, 16); HZ_Cache_Prewarm((const u8 *)SEAT_NAME_GBK, 16);
     printf("[Լ] UIͼνʼ.....OK\r\n");
 
     strncpy(ui.area_seat, SEAT_NAME_GBK, sizeof(ui.area_seat)-1);
@@ -281,10 +529,18 @@ int main(void) {
 
     HGQ_VL53L0X_I2C_Init(); 
     HGQ_VL53L0X_Begin(&g_tof, 0x29);
+#if SENS_TOF_CONTINUOUS
+    HGQ_VL53L0X_SetTimingBudget(&g_tof, SENS_TOF_BUDGET_US);
+    HGQ_VL53L0X_StartContinuous(&g_tof, SENS_TOF_INTERVAL_MS);
+#endif
     printf("[Լ] VL53L0X......OK\r\n");
     
     xMutexUI = xSemaphoreCreateMutex();
-    xMutexESP = xSemaphoreCreateMutex();
+    xTimerClock = xTimerCreate("UIClk", 1000, pdTRUE, NULL, UI_ClockCb);
+    xTimerFade = xTimerCreate("UIFade", UI_FADE_MS, pdFALSE, NULL, UI_FadeCb);
+    g_touch_irq = !HGQ_Touch_Init(UI_TouchCb);
+    printf("[Լ] ȡʽ.........%s\r\n", g_touch_irq ? "ж" : "ѯ");
+    g_cmd_queue = xQueueCreate(NET_CMD_QUEUE_LEN, sizeof(NetCmd));
 
     xTaskCreate((TaskFunction_t )start_task, (const char* )"start_task", (uint16_t )START_STK_SIZE, (void* )NULL, (UBaseType_t )START_TASK_PRIO, (TaskHandle_t* )&StartTask_Handler);
     
@@ -296,6 +552,7 @@ int main(void) {
 
 void start_task(void *pvParameters) {
     taskENTER_CRITICAL(); 
+    HGQ_ESP8266_Init();   /* AT 񣬶ռ USART2 */
     xTaskCreate(net_task, "Net", NET_STK_SIZE, NULL, NET_TASK_PRIO, &NetTask_Handler);
     xTaskCreate(ui_task, "UI", UI_STK_SIZE, NULL, UI_TASK_PRIO, &UITask_Handler);
     xTaskCreate(sensor_task, "Sens", SENSOR_STK_SIZE, NULL, SENSOR_TASK_PRIO, &SensorTask_Handler);
@@ -304,313 +561,479 @@ void start_task(void *pvParameters) {
     taskEXIT_CRITICAL(); 
 }
 
-static void Network_Connect_Flow(void) {
-    printf("[] ʼִ...\r\n");
-    xSemaphoreTake(xMutexUI, portMAX_DELAY);
-    ui.esp_state = 1; g_mqtt_ok = 0;
-    HGQ_UI_Update(&ui, g_time_str);
-    xSemaphoreGive(xMutexUI);
-    
-    xSemaphoreTake(xMutexESP, portMAX_DELAY);
-    printf("[] λ ESP8266...\r\n");
-    HGQ_USART2_SendString("AT+RST\r\n"); 
-    vTaskDelay(3000); 
-    
-    HGQ_ESP8266_SendCmd("ATE0\r\n","OK",500);
-    HGQ_ESP8266_SendCmd("AT+CWMODE=1\r\n","OK",500);
-    HGQ_ESP8266_SendCmd("AT+CWQAP\r\n", "OK", 500);
-    HGQ_ESP8266_SendCmd("AT+CIPMUX=0\r\n", "OK", 500);
-
-    printf("[]  WiFi...\r\n");
-    if(HGQ_ESP8266_JoinAP(WIFI_SSID, WIFI_PASS) != ESP8266_OK) {
-        printf("[] WiFi ʧ!\r\n");
-        xSemaphoreGive(xMutexESP);
-        xSemaphoreTake(xMutexUI, portMAX_DELAY);
-        ui.esp_state = 0; 
-        xSemaphoreGive(xMutexUI);
-        return;
-    }
-    printf("[] WiFi ӳɹ.\r\n");
-
-    printf("[]  MQTT...\r\n");
-    if(HGQ_ESP8266_ConnectMQTT(MQTT_BROKER, MQTT_PORT, MQTT_USER, MQTT_PASS) != ESP8266_OK) {
-        printf("[] MQTT ʧ!\r\n");
-        xSemaphoreGive(xMutexESP);
-        xSemaphoreTake(xMutexUI, portMAX_DELAY);
-        ui.esp_state = 0; 
-        xSemaphoreGive(xMutexUI);
-        return;
-    }
-    
-    if(HGQ_ESP8266_MQTTSUB("stm32/cmd", 0) != ESP8266_OK) {
-        printf("[] ʧ!\r\n");
-        xSemaphoreGive(xMutexESP);
-        xSemaphoreTake(xMutexUI, portMAX_DELAY);
-        ui.esp_state = 0; 
-        xSemaphoreGive(xMutexUI);
-        return;
-    }
-    
-    printf("[]  NTP Уʱ...\r\n");
-    HGQ_ESP8266_EnableNTP();
+static const char *const s_sub_topics[] = { MQTT_CMD_TOPIC, MQTT_BCAST_TOPIC };
+static const ESP8266_ConnCfg s_conn_cfg = {
+    WIFI_SSID, WIFI_PASS, MQTT_BROKER, MQTT_PORT, MQTT_USER, MQTT_PASS,
+    s_sub_topics, sizeof(s_sub_topics) / sizeof(s_sub_topics[0])
+};
 
-    printf("[] ״̬ͬ (SYNC)...\r\n");
-    MQTT_PubSync(); 
-    
-    xSemaphoreGive(xMutexESP);
-    
-    xSemaphoreTake(xMutexUI, portMAX_DELAY);
-    ui.esp_state = 2; g_mqtt_ok = 1;
-    xSemaphoreGive(xMutexUI);
-    printf("[] .\r\n");
+/* ====== URC ص (AT ִ) ====== */
+/* +MQTTSUBRECV:0,"stm32/cmd/A18",<len>,cmd=...  AT 水ȷƬأձ߽ */
+static NetCmdParser s_cmd_ps;       /* ֻ AT ʹ */
+
+static void Sub_Begin(const char *topic, uint16_t len, void *ctx) {
+    (void)topic; (void)len; (void)ctx;
+    NetCmd_Begin(&s_cmd_ps);
 }
 
+static void Sub_Data(const char *p, uint16_t n, void *ctx) {
+    (void)ctx;
+    NetCmd_Feed(&s_cmd_ps, p, n);
+}
+
+static void Sub_End(uint8_t ok, void *ctx) {
+    NetCmd nc;
+    (void)ctx;
+    if(!ok || !NetCmd_End(&s_cmd_ps, &nc)) return;
+    if(xQueueSend(g_cmd_queue, &nc, 0) != pdTRUE) g_cmd_dropped++;
+    xTaskNotifyGive(NetTask_Handler);
+}
+
+static const HGQ_AT_SubHandler s_sub_handler = { Sub_Begin, Sub_Data, Sub_End };
+
 void net_task(void *pvParameters) {
-    Network_Connect_Flow();
+    HGQ_AT_SetSubHandler(&s_sub_handler, NULL);
+    static const HGQ_TelemCfg telem_cfg = {
+        TELEM_DB_TEMP_X10, TELEM_DB_HUMI, TELEM_DB_LUX, TELEM_DB_TOF_MM,
+        TELEM_HEARTBEAT_S, TELEM_BATCH_N, TELEM_BATCH_MAX_S
+    };
+    HGQ_Telem_Init(&telem_cfg);
+    /* ״̬ƽָ¼ճ */
+    HGQ_ESP8266_Conn_Init(&s_conn_cfg);
     
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t xNextTick = xTaskGetTickCount() + 50;
     uint32_t cnt_pub = 0;
-    uint32_t cnt_net_chk = 50; 
+    uint32_t cnt_net_chk = 0; 
     uint32_t cnt_sync = 0;
-
-    static char line[512]; 
-    static u16 idx = 0; 
-    uint8_t ch;
+    uint32_t cnt_replay = 0;
+    TickType_t jrn_telem_tick = xTaskGetTickCount();
+    ESP8266_ConnState last_st = ESP_CONN_IDLE;
 
     while(1) {
-        while(HGQ_USART2_IT_GetChar(&ch)) {
-            if(idx < sizeof(line)-1) line[idx++] = ch;
-            if(ch == '\n') {
-                line[idx] = 0; idx = 0;
-                if(strstr(line, "+MQTTSUBRECV")) {
-                    char *p_start = strstr(line, "cmd=");
-                    if(p_start) TaskQueue_Push(p_start);
-                    else {
-                        char *last_comma = strrchr(line, ',');
-                        if(last_comma && *(last_comma+1) != '\0') {
-                            TaskQueue_Push(last_comma + 1);
-                        }
-                    }
-                }
+        /* ȴ URC ֪ͨһ 50ms ģָ */
+        TickType_t wait = xNextTick - xTaskGetTickCount();
+        if((int32_t)wait < 0) wait = 0;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        ESP8266_ConnState st = HGQ_ESP8266_Conn_Step();
+        if(st != last_st) {
+            g_mqtt_ok = (st == ESP_CONN_ONLINE);
+            UI_Lock();
+            ui.esp_state = HGQ_ESP8266_Conn_UIState();
+            UI_Unlock();
+            UI_Notify(UI_EV_STATE);
+            g_bin_fmt = 0; /* ÿЭ̸ظʽ */
+            HGQ_ESP8266_MQTTPUBRAW_Reset();
+            if(g_mqtt_ok) {
+                printf("[] ״̬ͬ (SYNC)...\r\n");
+                MQTT_PubSync();
+                HGQ_Telem_Force();  /* ߺȱһǰ/ */
+                cnt_sync = 1200 - 20; /* 1s Уһ NTP */
             }
+            last_st = st;
         }
 
-        char kv[TASK_CMD_LEN];
-        while(TaskQueue_Pop(kv)) {
-            printf("[ָ] %s\r\n", kv);
-            char cmd_val[20], uid_str[24], sid[20], user[32];
-            
-            if(!KV_Get(kv, "cmd", cmd_val, sizeof(cmd_val))) continue;
-            
-            xSemaphoreTake(xMutexUI, portMAX_DELAY);
-            
-            if(strcmp(cmd_val, "time_sync") == 0) {
-                char t_buf[16];
-                if(KV_Get(kv, "time", t_buf, sizeof(t_buf)) && strlen(t_buf) >= 8) {
-                    t_buf[2] = 0; t_buf[5] = 0;
-                    g_time_h = atoi(t_buf); g_time_m = atoi(t_buf+3); g_time_s = atoi(t_buf+6);
+        NetCmd nc;
+        while(xQueueReceive(g_cmd_queue, &nc, 0) == pdTRUE) {
+            printf("[ָ] type=%d\r\n", nc.type);
+            UI_Lock();
+            switch(nc.type) {
+            case NC_TIME_SYNC:
+                if(nc.has_time) {
+                    g_time_h = nc.h; g_time_m = nc.m; g_time_s = nc.s;
                     sprintf(g_time_str, "%02d:%02d", g_time_h, g_time_m);
-                    g_need_ui_refresh = 1;
+                    UI_Notify(UI_EV_STATE);
                     printf("[Уʱ] ʱͬɹ: %02d:%02d\r\n", g_time_h, g_time_m);
                 }
+                break;
+            case NC_FMT:
+                g_bin_fmt = (nc.fmt_v == (BIN_MAGIC_V1 & 0x0F));
+                HGQ_ESP8266_MQTTPUBRAW_Reset();
+                printf("[MQTT] ظʽ: %s\r\n", g_bin_fmt ? " v1" : "ı");
+                break;
+            case NC_DENY:
+                HGQ_UI_ShowPopup((char*)STR_POP_ERR);
+                g_popup_ts = 3; g_op_mode = OP_WAIT_CHECKIN; 
+                break;
+            case NC_RESERVE:
+                if(nc.user[0]) strncpy(ui.user_str, nc.user, sizeof(ui.user_str)-1);
+                if(nc.uid[0]) strncpy(g_expect_uid, nc.uid, sizeof(g_expect_uid)-1);
+                if(nc.expires[0]) strcpy(ui.reserve_t, nc.expires);
+                
+                strncpy(g_state, "RESERVED", sizeof(g_state)-1);
+                strncpy(ui.status, "Rsrv(15m)", sizeof(ui.status)-1);
+                
+                MQTT_PubState();
+                
+                UI_Notify(UI_EV_STATE);
+                printf("[ԤԼ] ״̬ͬRESERVED\r\n");
+                break;
+            case NC_CHECKIN_OK:
+                sprintf(ui.start_t, "%02d:%02d", g_time_h, g_time_m);
+                strncpy(g_state, "IN_USE", sizeof(g_state)-1);
+                strncpy(ui.status, "In Use", sizeof(ui.status)-1);
+                ui.light_on = 1; 
+                
+                g_op_mode = OP_NORMAL; 
+                
+                MQTT_PubState();
+                UI_Notify(UI_EV_REDRAW);
+                printf("[ǩ] ״̬ͬIN_USE\r\n");
+                break;
+            case NC_RELEASE:
+            case NC_CHECKOUT_OK:
+                g_expect_uid[0] = 0;
+                strncpy(g_state, "FREE", sizeof(g_state)-1);
+                strncpy(ui.status, "Free", sizeof(ui.status)-1);
+                strcpy(ui.user_str, "--"); strcpy(ui.reserve_t, "--");
+                strcpy(ui.start_t, "--"); ui.light_on = 0; 
+                
+                g_op_mode = OP_NORMAL;
+                
+                MQTT_PubState();
+                UI_Notify(UI_EV_REDRAW);
+                break;
+            default:
+                break;
             }
-            else if(KV_Get(kv, "seat_id", sid, sizeof(sid)) && strcmp(sid, DEV_ID) == 0) {
-                if(strcmp(cmd_val, "deny") == 0) {
-                    HGQ_UI_ShowPopup((char*)STR_POP_ERR);
-                    g_popup_ts = 3; g_op_mode = OP_WAIT_CHECKIN; 
-                }
-                else if(strcmp(cmd_val, "reserve") == 0) {
-                    if(KV_Get(kv, "user", user, sizeof(user))) strncpy(ui.user_str, user, sizeof(ui.user_str)-1);
-                    if(KV_Get(kv, "uid", uid_str, sizeof(uid_str))) strncpy(g_expect_uid, uid_str, sizeof(g_expect_uid)-1);
-                    
-                    char t_buf[32];
-                    if(KV_Get(kv, "expires_at", t_buf, sizeof(t_buf))) {
-                        if(strlen(t_buf) >= 16) { strncpy(ui.reserve_t, t_buf+11, 5); ui.reserve_t[5]=0; }
-                    }
-                    
-                    strncpy(g_state, "RESERVED", sizeof(g_state)-1);
-                    strncpy(ui.status, "Rsrv(15m)", sizeof(ui.status)-1);
-                    
-                    xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                    MQTT_PubState();
-                    xSemaphoreGive(xMutexESP);
-                    
-                    g_need_ui_refresh = 1; 
-                    printf("[ԤԼ] ״̬ͬRESERVED\r\n");
-                }
-                else if(strcmp(cmd_val, "checkin_ok") == 0) {
-                    sprintf(ui.start_t, "%02d:%02d", g_time_h, g_time_m);
-                    strncpy(g_state, "IN_USE", sizeof(g_state)-1);
-                    strncpy(ui.status, "In Use", sizeof(ui.status)-1);
-                    ui.light_on = 1; 
-                    
-                    g_op_mode = OP_NORMAL; 
-                    
-                    xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                    MQTT_PubState();
-                    xSemaphoreGive(xMutexESP);
-                    g_need_ui_refresh = 1;
-                    g_force_redraw = 1; 
-                    printf("[ǩ] ״̬ͬIN_USE\r\n");
-                }
-                else if(strcmp(cmd_val, "release") == 0 || strcmp(cmd_val, "checkout_ok") == 0) {
-                    g_expect_uid[0] = 0;
-                    strncpy(g_state, "FREE", sizeof(g_state)-1);
-                    strncpy(ui.status, "Free", sizeof(ui.status)-1);
-                    strcpy(ui.user_str, "--"); strcpy(ui.reserve_t, "--");
-                    strcpy(ui.start_t, "--"); ui.light_on = 0; 
-                    
-                    g_op_mode = OP_NORMAL;
-                    
-                    xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                    MQTT_PubState();
-                    xSemaphoreGive(xMutexESP);
-                    g_need_ui_refresh = 1;
-                    g_force_redraw = 1;
-                }
+            UI_Unlock();
+        }
+        if(g_state_pub) {
+            g_state_pub = 0;
+            if(g_mqtt_ok) {
+                UI_Lock();
+                MQTT_PubState();
+                UI_Unlock();
             }
-            xSemaphoreGive(xMutexUI);
         }
 
-        if(++cnt_pub >= 40) { // 2s
+        /* ԰ 50ms ļ */
+        if((int32_t)(xTaskGetTickCount() - xNextTick) < 0) continue;
+        xNextTick += 50;
+        if((int32_t)(xTaskGetTickCount() - xNextTick) > 0) xNextTick = xTaskGetTickCount() + 50; /* 󲻲 */
+
+        if(++cnt_pub >= 40) { // 2s һΣڲż¼
+            HGQ_TelemSample ts;
             cnt_pub = 0;
-            if(g_mqtt_ok) {
-                xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                MQTT_PubTelemetry(); 
-                xSemaphoreGive(xMutexESP);
+            HGQ_SensorSnap snap;
+            HGQ_Sensor_Read(&snap);
+            ts.temp_x10 = snap.temp_x10; ts.humi = snap.humi;
+            ts.lux = snap.lux; ts.tof_mm = snap.tof_mm;
+            HGQ_Telem_Feed(&ts, xTaskGetTickCount());
+            /* ʱд־󲹷 */
+            if(!g_mqtt_ok && xTaskGetTickCount() - jrn_telem_tick >= JRN_TELEM_PERIOD_S * configTICK_RATE_HZ) {
+                jrn_telem_tick = xTaskGetTickCount();
+                HGQ_Journal_Append(JRN_T_TELEM, &ts, sizeof(ts));
             }
         }
+        if(g_mqtt_ok && ++cnt_replay >= JRN_REPLAY_SLOTS) {
+            cnt_replay = 0;
+            Journal_Replay();
+        }
+        if(g_mqtt_ok && HGQ_Telem_Ready(xTaskGetTickCount())) {
+            HGQ_TelemEntry batch[HGQ_TELEM_BATCH_MAX];
+            uint8_t n = HGQ_Telem_Take(batch, TELEM_BATCH_N);
+            MQTT_PubTelemetry(batch, n);
+        }
 
         if(++cnt_net_chk >= 200) { // 10s
+            HGQ_USART2_RxStats rs;
             cnt_net_chk = 0;
-            xSemaphoreTake(xMutexESP, portMAX_DELAY);
-            uint8_t status = HGQ_ESP8266_CheckStatus();
-            if(status == 0) { delay_ms(200); status = HGQ_ESP8266_CheckStatus(); }
-            if(status == 0) g_mqtt_ok = 0;
-            xSemaphoreGive(xMutexESP);
-            
-            if(!g_mqtt_ok) Network_Connect_Flow();
+            HGQ_USART2_GetRxStats(&rs);
+            printf("[] =%lu =%lu =%lu ORE=%lu FE/NE=%lu ˮλ=%u/%u ָ=%lu\r\n",
+                   rs.rx_bytes, rs.rx_chunks, rs.overrun, rs.hw_overrun, rs.line_err, rs.high_water, HGQ_USART2_RXBUF_SIZE,
+                   g_cmd_dropped);
+            HGQ_AT_Stats ast;
+            HGQ_AT_GetStats(&ast);
+            printf("[AT] ֡=%lu =%luB ͷ=%lu ȴ=%lu =%lu =%lu\r\n",
+                   ast.frames, ast.frame_bytes, ast.frame_hdr_error, ast.frame_len_error,
+                   ast.frame_timeout, ast.line_overflow);
+            HGQ_TelemStats tst;
+            HGQ_Telem_GetStats(&tst);
+            printf("[ң] =%lu ¼=%lu =%lu Ϣ=%lu\r\n",
+                   tst.fed, tst.recorded, tst.heartbeats, tst.batches);
+            HGQ_JournalStats jst;
+            HGQ_Journal_GetStats(&jst);
+            printf("[־] д=%lu =%lu =%lu =%lu =%lu =%lu\r\n",
+                   jst.appended, jst.replayed, HGQ_Journal_Pending(), jst.erases, jst.lost, jst.bad);
+            u32 hz_hit, hz_miss;
+            HZ_Cache_GetStats(&hz_hit, &hz_miss);
+            printf("[ֿ] =%lu δ=%lu\r\n", hz_hit, hz_miss);
+            HGQ_WG_Stats wst;
+            HGQ_WG_GetStats(&wst);
+            printf("[] ֡=%lu ֡: =%u ؼ=%u =%lu ʱ=%luus =%luus\r\n",
+                   wst.frames, wst.rects, wst.widgets, wst.pixels, wst.us, wst.max_us);
+            if(g_touch_irq) {
+                HGQ_TouchStats tcs;
+                HGQ_Touch_GetStats(&tcs);
+                printf("[] ж=%lu ȡ=%lu ¼=%lu =%lu ӳ=%lums\r\n",
+                       tcs.irqs, tcs.reads, tcs.events, tcs.dropped, tcs.max_lat);
+            }
+            {
+                static const char *const bus_name[HGQ_I2C_BUS_NUM] = {"AHT", "TOF", "LUX", "CT"};
+                HGQ_I2C_Stats ist;
+                u8 b;
+                for(b = 0; b < HGQ_I2C_BUS_NUM; b++) {
+                    HGQ_I2C_GetStats(b, &ist);
+                    printf("[I2C] %s(%s) =%lu ֽ=%lu NACK=%lu =%lu ʱ=%lu =%u\r\n",
+                           bus_name[b], HGQ_I2C_IsHw(b) ? "Ӳ" : "", ist.xfers, ist.bytes,
+                           ist.nacks, ist.errors, ist.timeouts, ist.qmax);
+                }
+            }
+            {
+                HGQ_SensorStats sst;
+                u8 n;
+                for(n = 0; n < HGQ_Sensor_Count(); n++) {
+                    HGQ_Sensor_GetStats(n, &sst);
+                    printf("[] %s =%u/%lums =%lu =%lu δ=%lu =%lu =%lu ӳ=%lu/%lums =%lu/%luus\r\n",
+                           HGQ_Sensor_Name(n), HGQ_Sensor_GetPeriod(n), sst.period_ms, sst.runs, sst.errors,
+                           sst.retries, sst.skipped, sst.overruns, sst.lat_ms, sst.lat_max, sst.io_us, sst.io_max);
+                }
+            }
+#if SENS_TOF_CONTINUOUS
+            {
+                HGQ_VL53L0X_ContStats cst;
+                HGQ_VL53L0X_ContGetStats(&cst);
+                printf("[] ģʽ%s ж=%lu =%lu =%lu =%lu =%lu ѯ=%lu\r\n",
+                       cst.polling ? "(GPIO1 ж,ѯ)" : "",
+                       cst.irqs, cst.samples, cst.dropped, cst.errors, cst.kicks, cst.polls);
+            }
+#endif
+            {
+                u32 snap_ver, snap_retry;
+                HGQ_Sensor_SnapStats(&snap_ver, &snap_retry);
+                printf("[UI] =%lu ȴ=%lu ۼ=%luus =%luus(%s) հ汾=%lu ض=%lu\r\n",
+                       g_uilock.takes, g_uilock.waits, g_uilock.wait_us, g_uilock.max_us,
+                       g_uilock.max_task ? g_uilock.max_task : "-", snap_ver, snap_retry);
+            }
         }
 
         if(++cnt_sync >= 1200) { // 60s
             cnt_sync = 0;
             if(g_mqtt_ok) {
-                xSemaphoreTake(xMutexESP, portMAX_DELAY);
                 uint8_t h, m, s;
                 if(HGQ_ESP8266_GetNTPTime(&h, &m, &s)) {
-                    xSemaphoreTake(xMutexUI, portMAX_DELAY);
+                    UI_Lock();
                     g_time_h = h; g_time_m = m; g_time_s = s;
                     sprintf(g_time_str, "%02d:%02d", g_time_h, g_time_m);
-                    g_need_ui_refresh = 1;
-                    xSemaphoreGive(xMutexUI);
+                    UI_Unlock();
+                    UI_Notify(UI_EV_STATE);
                     printf("[Уʱ] NTP ʱ: %02d:%02d\r\n", h, m);
                 }
-                xSemaphoreGive(xMutexESP);
             }
         }
+    }
+}
 
-        vTaskDelayUntil(&xLastWakeTime, 50); 
+/*  (һ)Ҫˢ¼ */
+static uint32_t UI_OnTap(u16 x, u16 y) {
+    uint32_t ev = 0;
+    UI_Lock();
+    if(g_op_mode != OP_NORMAL) {
+        g_op_mode = OP_NORMAL; ev |= UI_EV_REDRAW;
+    } else {
+        int changed = 0;
+        if(HGQ_UI_TouchBtn_Check(x, y)) {
+            printf("[UI] Button Pressed. State: %s\r\n", g_state);
+            if(strcmp(g_state, "IN_USE") == 0) {
+                g_op_mode = OP_WAIT_CHECKOUT; HGQ_UI_ShowPopup((char*)STR_POP_OUT);
+            } else {
+                g_op_mode = OP_WAIT_CHECKIN; HGQ_UI_ShowPopup((char*)STR_POP_IN);
+            }
+            g_popup_ts = 15;
+        } else {
+            if(strcmp(g_state, "IN_USE") == 0) {
+                if(HGQ_UI_TouchBtn_Mode(x, y)) { ui.auto_mode = !ui.auto_mode; changed=1; }
+                else if(HGQ_UI_TouchBtn_On(x, y)) { ui.light_on = 1; changed=1; }
+                else if(HGQ_UI_TouchBtn_Off(x, y)) { ui.light_on = 0; changed=1; }
+                if(ui.auto_mode==0 && ui.light_on) {
+                    if(HGQ_UI_TouchBtn_BriUp(x, y)) { if(ui.bri_target<=90) ui.bri_target+=10; else ui.bri_target=100; }
+                    else if(HGQ_UI_TouchBtn_BriDown(x, y)) { if(ui.bri_target>=10) ui.bri_target-=10; else ui.bri_target=0; }
+                }
+            }
+            if(changed) {
+                /*  net_task Ʒ future ֻһ */
+                g_state_pub = 1;
+                xTaskNotifyGive(NetTask_Handler);
+            }
+            ev |= UI_EV_STATE;
+        }
     }
+    UI_Unlock();
+    return ev;
 }
 
 void ui_task(void *pvParameters) {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
     static uint8_t s_last_touch = 0;
+    int led_on = -1, led_bri = -1, relay = -1;
+    uint32_t ev;
+
+    xTimerStart(xTimerClock, portMAX_DELAY);
+    ev = UI_EV_STATE;   /* ״νˢһ */
 
     while(1) {
-        static uint16_t time_cnt = 0;
-        if(++time_cnt >= 10) { 
-            time_cnt = 0;
-            xSemaphoreTake(xMutexUI, portMAX_DELAY);
+        if(ev & UI_EV_CLOCK) {
+            UI_Lock();
             if(++g_time_s >= 60) { g_time_s = 0; g_time_m++; if(g_time_m >= 60) { g_time_m = 0; g_time_h = (g_time_h+1)%24; } }
             if(g_time_str[0] != '-') sprintf(g_time_str, "%02d:%02d", g_time_h, g_time_m);
             
             if(g_op_mode != OP_NORMAL && g_popup_ts > 0) {
                 g_popup_ts--;
-                if(g_popup_ts == 0) { g_op_mode = OP_NORMAL; g_force_redraw = 1; }
+                if(g_popup_ts == 0) { g_op_mode = OP_NORMAL; ev |= UI_EV_REDRAW; }
             }
-            xSemaphoreGive(xMutexUI);
+            UI_Unlock();
         }
 
-        u8 is_touched = tp_dev.scan(0);
-        if(is_touched && !s_last_touch) {
-            u16 x = tp_dev.x[0], y = tp_dev.y[0];
-            printf("[UI] Touch: x=%d, y=%d\r\n", x, y);
-            
-            xSemaphoreTake(xMutexUI, portMAX_DELAY);
-            if(g_op_mode != OP_NORMAL) {
-                g_op_mode = OP_NORMAL; g_force_redraw = 1;
-            } else {
-                int changed = 0;
-                if(HGQ_UI_TouchBtn_Check(x, y)) {
-                    printf("[UI] Button Pressed. State: %s\r\n", g_state);
-                    if(strcmp(g_state, "IN_USE") == 0) {
-                        g_op_mode = OP_WAIT_CHECKOUT; HGQ_UI_ShowPopup((char*)STR_POP_OUT);
-                    } else {
-                        g_op_mode = OP_WAIT_CHECKIN; HGQ_UI_ShowPopup((char*)STR_POP_IN);
-                    }
-                    g_popup_ts = 15;
-                } else {
-                    if(strcmp(g_state, "IN_USE") == 0) {
-                        if(HGQ_UI_TouchBtn_Mode(x, y)) { ui.auto_mode = !ui.auto_mode; changed=1; }
-                        else if(HGQ_UI_TouchBtn_On(x, y)) { ui.light_on = 1; changed=1; }
-                        else if(HGQ_UI_TouchBtn_Off(x, y)) { ui.light_on = 0; changed=1; }
-                        if(ui.auto_mode==0 && ui.light_on) {
-                            if(HGQ_UI_TouchBtn_BriUp(x, y)) { if(ui.bri_target<=90) ui.bri_target+=10; else ui.bri_target=100; }
-                            else if(HGQ_UI_TouchBtn_BriDown(x, y)) { if(ui.bri_target>=10) ui.bri_target-=10; else ui.bri_target=0; }
-                        }
-                    }
-                    if(changed) {
-                        xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                        MQTT_PubState();
-                        xSemaphoreGive(xMutexESP);
-                    }
+        if(g_touch_irq) {
+            /* ȡź¼ֻ */
+            HGQ_TouchEvent te;
+            if(ev & UI_EV_TOUCH) {
+                while(HGQ_Touch_Get(&te)) {
+                    if(te.type != TOUCH_EV_DOWN) continue;
+                    ev |= UI_OnTap(te.x[0], te.y[0]);
+                    printf("[UI] Touch: x=%d, y=%d (%lums)\r\n", te.x[0], te.y[0],
+                           (unsigned long)(xTaskGetTickCount() - te.t_irq));
                 }
             }
-            xSemaphoreGive(xMutexUI);
-        }
-        s_last_touch = is_touched;
-
-        xSemaphoreTake(xMutexUI, portMAX_DELAY);
-        if(g_force_redraw) {
-            g_force_redraw = 0;
-            HGQ_UI_ResetCache(); 
-            HGQ_UI_DrawFramework(); 
-            g_need_ui_refresh = 1; 
+        } else {
+            /* жϣÿλѶɨ (ѯʱ) */
+            u8 is_touched = tp_dev.scan(0);
+            if(is_touched && !s_last_touch) {
+                printf("[UI] Touch: x=%d, y=%d\r\n", tp_dev.x[0], tp_dev.y[0]);
+                ev |= UI_OnTap(tp_dev.x[0], tp_dev.y[0]);
+            }
+            s_last_touch = is_touched;
         }
-        if(g_need_ui_refresh || 1) { 
+
+        if(ev & UI_EV_DRAW) {
+            int bri;
+            UI_Lock();
+            if(ev & UI_EV_REDRAW) {
+                HGQ_UI_ResetCache(); 
+                HGQ_UI_DrawFramework(); 
+            }
+            if(ev & UI_EV_SENSOR) {
+                HGQ_SensorSnap snap;
+                HGQ_Sensor_Read(&snap);
+                if(snap.valid & HGQ_SNAP_AHT) { ui.temp_x10 = snap.temp_x10; ui.humi = snap.humi; }
+                if(snap.valid & HGQ_SNAP_LUX) ui.lux = snap.lux;
+            }
+            if(ui.auto_mode && ui.light_on) {
+                 ui.bri_target = Calc_Auto_Brightness(ui.lux);
+            }
             if(g_op_mode == OP_NORMAL) HGQ_UI_Update(&ui, g_time_str);
-            LED0_SetOn(ui.light_on);
-            LED0_SetBrightness((u8)HGQ_UI_GetBrightnessNow());
-            Relay_Set(strcmp(g_state, "IN_USE") == 0 ? 1 : 0);
-            g_need_ui_refresh = 0;
+            bri = HGQ_UI_GetBrightnessNow();
+            /* ֻڱ仯ʱд */
+            if(ui.light_on != led_on) { led_on = ui.light_on; LED0_SetOn(led_on); }
+            if(bri != led_bri) { led_bri = bri; LED0_SetBrightness((u8)bri); }
+            if((strcmp(g_state, "IN_USE") == 0) != relay) { relay = (strcmp(g_state, "IN_USE") == 0); Relay_Set(relay); }
+            /* δĿ꣺ʱһ */
+            if(g_op_mode == OP_NORMAL && bri != ui.bri_target) xTimerReset(xTimerFade, 0);
+            UI_Unlock();
+        }
+
+        /* û¼ʱжʱٶʱѣʱֻڲѯģʽ */
+        ev = 0;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &ev, g_touch_irq ? portMAX_DELAY : pdMS_TO_TICKS(UI_TOUCH_POLL_MS));
+    }
+}
+
+/* ---- Ȼصֻ߶дŽ g_sens ---- */
+static u8 Sens_AHT_Trigger(void) {
+    return HGQ_AHT20_Trigger();
+}
+
+static u8 Sens_AHT_Collect(void) {
+    float tc, rh;
+    u8 r = HGQ_AHT20_Collect(&tc, &rh);
+    if(r == 1) return HGQ_SENSOR_NOT_READY;
+    if(r) return r;
+    g_sens.temp_x10 = (s16)(tc * 10 + 0.5f);
+    g_sens.humi = (u8)(rh + 0.5f);
+    g_sens_fresh |= HGQ_SNAP_AHT;
+    return 0;
+}
+
+static u8 Sens_Lux_Collect(void) {
+    static u8 retry = 0;
+    uint16_t lux;
+    if(!g_bh1750_ok) {
+        /* ³ʼҪԼ 190msʱÿ 20  (Լ 5s) һ */
+        if(retry++ % 20) return HGQ_SENSOR_SKIPPED;
+        g_bh1750_ok = !HGQ_BH1750_Init(0x23);
+        if(!g_bh1750_ok) { g_sens.lux = -1; g_sens_fresh |= HGQ_SNAP_LUX; return 2; }
+    }
+    if(HGQ_BH1750_ReadLux(&lux)) return 2;
+    g_sens.lux = lux > 32767 ? 32767 : (s16)lux;
+    g_sens_fresh |= HGQ_SNAP_LUX;
+    return 0;
+}
+
+#if SENS_TOF_CONTINUOUS
+/* ģʽжϷŽȫȡ˲ */
+static u8 Sens_Tof_Collect(void) {
+    HGQ_VL53L0X_Sample smp;
+    uint16_t mm;
+    u8 n = 0;
+    HGQ_VL53L0X_ContService();
+    while(HGQ_VL53L0X_ContGet(&smp)) {
+        n++;
+        if(HGQ_VL53L0X_Feed(&g_tof, smp.mm, 0, &mm) == HGQ_VL53L0X_OK) {
+            g_sens.tof_mm = mm;
+            g_sens_fresh |= HGQ_SNAP_TOF;
         }
-        xSemaphoreGive(xMutexUI);
+    }
+    return n ? 0 : HGQ_SENSOR_NOT_READY;
+}
+#else
+static u8 Sens_Tof_Trigger(void) {
+    return HGQ_VL53L0X_Start(&g_tof);
+}
 
-        vTaskDelayUntil(&xLastWakeTime, 100); 
+static u8 Sens_Tof_Collect(void) {
+    uint16_t raw, mm;
+    HGQ_VL53L0X_Status st = HGQ_VL53L0X_Poll(&g_tof, &raw);
+    if(st == HGQ_VL53L0X_BUSY) return HGQ_SENSOR_NOT_READY;
+    if(st) return 2;
+    if(HGQ_VL53L0X_Feed(&g_tof, raw, 0, &mm) == HGQ_VL53L0X_OK) {
+        g_sens.tof_mm = mm;
+        g_sens_fresh |= HGQ_SNAP_TOF;
     }
+    return 0;
 }
+#endif
+
+static const HGQ_SensorDef s_sens_def[] = {
+    {"AHT20",   SENS_AHT_PERIOD_MS, SENS_AHT_CONV_MS, 5,  Sens_AHT_Trigger, Sens_AHT_Collect},
+    {"BH1750",  SENS_LUX_PERIOD_MS, 0,                0,  NULL,             Sens_Lux_Collect},
+#if SENS_TOF_CONTINUOUS
+    {"VL53L0X", SENS_TOF_PERIOD_MS, 0, SENS_TOF_INTERVAL_MS, NULL,          Sens_Tof_Collect},
+#else
+    {"VL53L0X", SENS_TOF_PERIOD_MS, SENS_TOF_CONV_MS, 2,  Sens_Tof_Trigger, Sens_Tof_Collect},
+#endif
+};
 
 void sensor_task(void *pvParameters) {
+    HGQ_SensorSnap last;
+    u8 i;
+    for(i = 0; i < sizeof(s_sens_def) / sizeof(s_sens_def[0]); i++) HGQ_Sensor_Add(&s_sens_def[i]);
+    memset(&last, 0, sizeof(last));
+
     while(1) {
-        float tc, rh;
-        HGQ_AHT20_Read(&tc, &rh);
-        
-        xSemaphoreTake(xMutexUI, portMAX_DELAY);
-        ui.temp_x10 = (int)(tc * 10 + 0.5f);
-        ui.humi = (int)(rh + 0.5f);
-        if(g_bh1750_ok) { HGQ_BH1750_ReadLux(&g_lux); ui.lux = g_lux; }
-        else { g_bh1750_ok = !HGQ_BH1750_Init(0x23); if(!g_bh1750_ok) ui.lux = -1; }
-        
-        if(ui.auto_mode && ui.light_on) {
-             ui.bri_target = Calc_Auto_Brightness(ui.lux);
+        u32 wait = HGQ_Sensor_Run();
+
+        /* ݾͷգ xMutexUIʾֵ˲֪ͨ ui_task */
+        if(g_sens_fresh) {
+            g_sens.valid |= g_sens_fresh;
+            g_sens_fresh = 0;
+            HGQ_Sensor_Publish(&g_sens);
+            if(g_sens.temp_x10 != last.temp_x10 || g_sens.humi != last.humi || g_sens.lux != last.lux) {
+                last = g_sens;
+                UI_Notify(UI_EV_SENSOR);
+            }
         }
 
-        uint16_t mm;
-        if(HGQ_VL53L0X_ReadMm(&g_tof, &mm) == 0) g_tof_mm = mm;
-        xSemaphoreGive(xMutexUI);
-        
-        vTaskDelay(500); 
+        vTaskDelay(wait ? wait : 1);
     }
 }
 
@@ -622,34 +1045,32 @@ void rfid_task(void *pvParameters) {
         if(ret == 0) { 
             if(!g_rfid_has_card) {
                 g_rfid_has_card = 1;
-                xSemaphoreTake(xMutexUI, portMAX_DELAY);
+                UI_Lock();
                 UID_ToHexNoSpace(g_rfid_uid, uid_len, g_card_hex, sizeof(g_card_hex));
                 
                 char ev[64];
-                int send = 0;
+                uint8_t ev_cmd = 0;
                 
                 if(g_op_mode == OP_WAIT_CHECKIN) {
                     // ޸ type=event mqtt_service.py ƥ
                     sprintf(ev, "type=event&cmd=checkin&uid=%s&seat_id=%s", g_card_hex, DEV_ID);
-                    send = 1;
+                    ev_cmd = JRN_EV_CHECKIN;
                 }
                 else if(g_op_mode == OP_WAIT_CHECKOUT) {
                     sprintf(ev, "type=event&cmd=checkout&uid=%s&seat_id=%s", g_card_hex, DEV_ID);
-                    send = 1;
+                    ev_cmd = JRN_EV_CHECKOUT;
                 }
                 else {
                     HGQ_UI_ShowPopup((char*)"ȵĻ");
                     g_op_mode = OP_WARNING; 
                     g_popup_ts = 3; 
-                    send = 0;
                 }
-                xSemaphoreGive(xMutexUI);
+                UI_Unlock();
                 
-                if(send && g_mqtt_ok) {
-                    xSemaphoreTake(xMutexESP, portMAX_DELAY);
-                    MQTT_PubEvent(ev);
-                    xSemaphoreGive(xMutexESP);
-                    printf("[RFID] ˢϱ: %s\r\n", ev);
+                /* ҲȽ־ʧܲ¼˳յ seq ȥ */
+                if(ev_cmd) {
+                    uint32_t seq = Journal_Event(ev_cmd, g_rfid_uid, uid_len);
+                    printf("[RFID] ˢ¼д־ #%lu%s: %s\r\n", (unsigned long)seq, g_mqtt_ok ? "" : " ()", ev);
                 }
             }
         } 
@@ -11,8 +11,14 @@ MQTT_PASS = ""             # 如果有密码请填入
 
 # 订阅主题：监听所有设备的上传数据 (对应STM32的 server/+/+)
 MQTT_SUB_TOPIC = "server/#"
-# 发布主题：向设备发送指令 (对应STM32订阅的 stm32/cmd)
-MQTT_CMD_TOPIC = "stm32/cmd"
+# 发布主题：每个座位单独一个指令主题 (对应STM32订阅的 stm32/cmd/<DEV_ID>)
+MQTT_CMD_TOPIC = "stm32/cmd/{seat_id}"
+# 广播主题：所有设备都订阅，仅用于 time_sync 等全体指令
+MQTT_BCAST_TOPIC = "stm32/bcast"
+# 设备在 sync 中声明 fmt=1 时，是否同意其改用二进制负载 (AT+MQTTPUBRAW)
+MQTT_BINARY_ENABLE = True
+# 设备离线日志补发带 seq，服务器按 (seat_id, seq) 去重，去重记录保留天数
+MSG_SEQ_KEEP_DAYS = 7
 
 # 业务参数
 DEFAULT_SEATS = [("A18", "座位 A18")]  # 默认初始化的座位
@@ -69,6 +69,23 @@ def init_db():
         created_at TEXT
     )""")
 
+    # 5. 设备日志补发去重表 (seat_id + 日志纪元 + 设备端递增序号)
+    #    设备日志区重建后 seq 从 1 重来，纪元 ep 随之换新；旧版设备不带 ep，按 0 记
+    cols = [r[1] for r in c.execute("PRAGMA table_info(msg_seq)").fetchall()]
+    if cols and "ep" not in cols:
+        c.execute("ALTER TABLE msg_seq RENAME TO msg_seq_old")
+    c.execute("""
+    CREATE TABLE IF NOT EXISTS msg_seq(
+        seat_id TEXT NOT NULL,
+        ep INTEGER NOT NULL DEFAULT 0,
+        seq INTEGER NOT NULL,
+        created_at TEXT NOT NULL,
+        PRIMARY KEY(seat_id, ep, seq)
+    )""")
+    if cols and "ep" not in cols:
+        c.execute("INSERT INTO msg_seq(seat_id, ep, seq, created_at) SELECT seat_id, 0, seq, created_at FROM msg_seq_old")
+        c.execute("DROP TABLE msg_seq_old")
+
     # --- 初始化数据 ---
 
     # 默认管理员 admin/123456
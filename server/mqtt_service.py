@@ -1,4 +1,5 @@
 import json
+import struct
 import time
 import threading
 import paho.mqtt.client as mqtt
@@ -13,6 +14,18 @@ TOPIC_UP = "server/+/+"
 
 client = mqtt.Client()
 
+# 二进制负载 v1 (与 USER/main.c 保持一致)，多字节小端，座位号取自主题
+#   [0] 0xB1  [1] 类型
+#   telemetry(1): int16 temp_x10, uint8 humi, uint16 lux (0xFFFF=传感器异常), uint16 tof_mm
+#   state(2):     uint8 state, uint8 flags (bit0 power, bit1 light, bit2 auto), uint8 uid_len, uid
+#   telemetry_batch(3): uint8 n, n x {uint16 age_s, int16 temp_x10, uint8 humi, uint16 lux, uint16 tof_mm}
+BIN_MAGIC_V1 = 0xB1
+BIN_VERSION = BIN_MAGIC_V1 & 0x0F
+BIN_T_TELEMETRY = 1
+BIN_T_STATE = 2
+BIN_T_TELEM_BATCH = 3
+BIN_STATES = {0: SEAT_FREE, 1: SEAT_RESERVED, 2: SEAT_IN_USE}
+
 
 def get_beijing_time_str():
     """获取当前北京时间 HH:MM:SS"""
@@ -21,18 +34,94 @@ def get_beijing_time_str():
     return beijing_now.strftime("%H:%M:%S")
 
 
-def publish_cmd(cmd_dict):
-    """发送指令给设备 (key=value格式)"""
+def cmd_topic(seat_id=None):
+    """指令路由：有座位号发到该座位的专属主题，否则发广播主题"""
+    if seat_id:
+        return MQTT_CMD_TOPIC.format(seat_id=seat_id)
+    return MQTT_BCAST_TOPIC
+
+
+def publish_cmd(cmd_dict, seat_id=None):
+    """发送指令给设备 (key=value格式)，seat_id 缺省时取 cmd_dict 中的 seat_id"""
     try:
         parts = [f"{k}={v}" for k, v in cmd_dict.items()]
         payload = "&".join(parts)
-        client.publish("stm32/cmd", payload, qos=0)
-        print(f"[MQTT] Sent: {payload}")
+        topic = cmd_topic(seat_id or cmd_dict.get("seat_id"))
+        client.publish(topic, payload, qos=0)
+        print(f"[MQTT] Sent {topic}: {payload}")
     except Exception as e:
         print(f"[MQTT] Publish error: {e}")
 
 
+def decode_binary(raw):
+    """解码二进制负载，返回与文本格式同名的字段字典；无法识别时返回 None"""
+    if len(raw) < 2 or raw[0] != BIN_MAGIC_V1:
+        return None
+    msg_type = raw[1]
+    if msg_type == BIN_T_TELEMETRY and len(raw) >= 9:
+        temp_x10, humi, lux, tof = struct.unpack_from("<hBHH", raw, 2)
+        return {"type": "telemetry", "temp": temp_x10 / 10.0, "humi": humi,
+                "lux": -1 if lux == 0xFFFF else lux, "tof_mm": tof}
+    if msg_type == BIN_T_TELEM_BATCH and len(raw) >= 3:
+        samples = []
+        for i in range(min(raw[2], (len(raw) - 3) // 9)):
+            age, temp_x10, humi, lux, tof = struct.unpack_from("<HhBHH", raw, 3 + i * 9)
+            samples.append((age, temp_x10 / 10.0, humi, -1 if lux == 0xFFFF else lux, tof))
+        return {"type": "telemetry", "samples": samples}
+    if msg_type == BIN_T_STATE and len(raw) >= 5:
+        state, flags, uid_len = struct.unpack_from("<BBB", raw, 2)
+        return {"type": "state", "state": BIN_STATES.get(state, SEAT_FREE),
+                "uid": raw[5:5 + uid_len].decode("ascii", "ignore"),
+                "power": flags & 1, "light": (flags >> 1) & 1,
+                "light_mode": "AUTO" if flags & 4 else "MANUAL"}
+    return None
+
+
+def telemetry_samples(data):
+    """把单条或批量遥测展开成 [(age_s, temp, humi, lux, tof_mm), ...]"""
+    if "samples" in data:
+        return data["samples"]
+    if "s" in data:
+        # 文本批量: s=age,temp_x10,humi,lux,tof;...
+        samples = []
+        for item in data["s"].split(';'):
+            f = item.split(',')
+            if len(f) == 5:
+                samples.append((int(f[0]), int(f[1]) / 10.0, int(f[2]), int(f[3]), int(f[4])))
+        return samples
+    if "temp" in data or "humi" in data or "tof_mm" in data:
+        return [(int(data.get("age", 0)), float(data.get("temp", 0)), int(float(data.get("humi", 0))),
+                 int(float(data.get("lux", 0))), int(float(data.get("tof_mm", 0))))]
+    return []
+
+
+def seq_seen(seat_id, ep, seq):
+    """设备日志序号是否已处理过 (重复补发)，只查不登记"""
+    with db_lock:
+        conn = get_conn()
+        row = conn.execute("SELECT 1 FROM msg_seq WHERE seat_id=? AND ep=? AND seq=?", (seat_id, ep, seq)).fetchone()
+        conn.close()
+    return row is not None
+
+
+def seq_mark(conn, seat_id, data):
+    """在业务写入的同一事务里登记序号，随 commit 一起生效；处理中途出错则不登记，设备重发时照常处理"""
+    if "seq" in data:
+        conn.execute("INSERT OR IGNORE INTO msg_seq(seat_id, ep, seq, created_at) VALUES(?,?,?,?)",
+                     (seat_id, int(data.get("ep", 0)), int(data["seq"]), now_str()))
+
+
+def prune_msg_seq():
+    cutoff = (datetime.now() - timedelta(days=MSG_SEQ_KEEP_DAYS)).strftime("%Y-%m-%d %H:%M:%S")
+    with db_lock:
+        conn = get_conn()
+        conn.execute("DELETE FROM msg_seq WHERE created_at < ?", (cutoff,))
+        conn.commit()
+        conn.close()
+
+
 def time_broadcast_task():
+    n = 0
     while True:
         time.sleep(60)
         try:
@@ -40,6 +129,12 @@ def time_broadcast_task():
             publish_cmd({"cmd": "time_sync", "time": t_str})
         except Exception as e:
             print(f"[TIME] Broadcast error: {e}")
+        n += 1
+        if n % 60 == 0:  # 每小时清理一次过期的去重记录
+            try:
+                prune_msg_seq()
+            except Exception as e:
+                print(f"[SEQ] Prune error: {e}")
 
 
 def on_connect(client, userdata, flags, rc):
@@ -50,15 +145,20 @@ def on_connect(client, userdata, flags, rc):
 def on_message(client, userdata, msg):
     try:
         topic = msg.topic
-        payload = msg.payload.decode("utf-8")
-        print(f"[MQTT] Recv {topic}: {payload}")
-
-        # 1. 基础解析 Payload
-        data = {}
-        for part in payload.split('&'):
-            if '=' in part:
-                k, v = part.split('=', 1)
-                data[k] = v.strip()
+        raw = msg.payload
+
+        # 1. 基础解析 Payload：首字节为二进制标识时按 v1 解码，否则按 key=value 文本
+        data = decode_binary(raw) if raw[:1] == bytes([BIN_MAGIC_V1]) else None
+        if data is not None:
+            print(f"[MQTT] Recv {topic}: <bin {raw.hex()}> {data}")
+        else:
+            payload = raw.decode("utf-8")
+            print(f"[MQTT] Recv {topic}: {payload}")
+            data = {}
+            for part in payload.split('&'):
+                if '=' in part:
+                    k, v = part.split('=', 1)
+                    data[k] = v.strip()
 
         # --- 核心修复开始: 如果 Payload 缺字段，从 Topic 补全 ---
         # Topic 格式: server/{type}/{seat_id}
@@ -79,10 +179,21 @@ def on_message(client, userdata, msg):
             print("[MQTT] Error: No seat_id found")
             return
 
+        # 刷卡事件和离线遥测都经设备日志补发，带 seq，掉电重启后可能重复补发，按序号丢弃重复
+        # 序号由各分支在业务写入的同一事务里登记 (seq_mark)，没处理完的消息重发时不会被当成重复
+        # 设备日志区重建后 seq 从 1 重来，ep (日志纪元) 随之换新，按 (seat_id, ep, seq) 判重
+        if "seq" in data:
+            if seq_seen(seat_id, int(data.get("ep", 0)), int(data["seq"])):
+                print(f"[SEQ] Duplicate {seat_id}/{data.get('ep', 0)}#{data['seq']} ignored")
+                return
+
         # 业务逻辑 1: 同步请求
         if msg_type == "sync":
             print(f"[SYNC] Device {seat_id} requesting sync...")
-            publish_cmd({"cmd": "time_sync", "time": get_beijing_time_str()})
+            publish_cmd({"cmd": "time_sync", "time": get_beijing_time_str()}, seat_id=seat_id)
+            # 负载格式协商：设备声明支持的版本与服务器一致才切换二进制
+            if MQTT_BINARY_ENABLE and data.get("fmt") == str(BIN_VERSION):
+                publish_cmd({"cmd": "fmt", "v": BIN_VERSION}, seat_id=seat_id)
 
             with db_lock:
                 conn = get_conn()
@@ -112,16 +223,18 @@ def on_message(client, userdata, msg):
                     conn.execute("UPDATE seats SET state=?, updated_at=? WHERE seat_id=?",
                                  (data["state"], now_str(), seat_id))
 
-                if "temp" in data or "humi" in data or "tof_mm" in data:
-                    temp = float(data.get("temp", 0))
-                    humi = int(float(data.get("humi", 0)))
-                    lux = int(float(data.get("lux", 0)))
-                    tof = int(float(data.get("tof_mm", 0)))
-                    conn.execute(
+                # 设备端按死区/心跳攒批发送，这里按样本展开，created_at 由 age 倒推
+                samples = telemetry_samples(data)
+                if samples:
+                    now = datetime.now()
+                    conn.executemany(
                         "INSERT INTO telemetry(seat_id, temp, humi, lux, tof_mm, created_at) VALUES(?,?,?,?,?,?)",
-                        (seat_id, temp, humi, lux, tof, now_str()))
+                        [(seat_id, temp, humi, lux, tof,
+                          (now - timedelta(seconds=age)).strftime("%Y-%m-%d %H:%M:%S"))
+                         for age, temp, humi, lux, tof in samples])
                     conn.execute("UPDATE seats SET updated_at=? WHERE seat_id=?", (now_str(), seat_id))
 
+                seq_mark(conn, seat_id, data)
                 conn.commit()
                 conn.close()
             return
@@ -146,13 +259,18 @@ def on_message(client, userdata, msg):
                             conn.execute("UPDATE reservations SET status=? WHERE id=?", (RES_IN_USE, res["id"]))
                             conn.execute("UPDATE seats SET state=?, updated_at=? WHERE seat_id=?",
                                          (SEAT_IN_USE, now_str(), seat_id))
+                            seq_mark(conn, seat_id, data)
                             conn.commit()
                             publish_cmd({"cmd": "checkin_ok", "seat_id": seat_id})
                             print(f"[CHECKIN] Success -> IN_USE")
                         else:
+                            seq_mark(conn, seat_id, data)
+                            conn.commit()
                             publish_cmd({"cmd": "deny", "seat_id": seat_id})
                             print(f"[CHECKIN] Denied: UID Mismatch")
                     else:
+                        seq_mark(conn, seat_id, data)
+                        conn.commit()
                         publish_cmd({"cmd": "deny", "seat_id": seat_id})
                         print(f"[CHECKIN] Denied: No active reservation")
                     conn.close()
@@ -169,10 +287,13 @@ def on_message(client, userdata, msg):
                         conn.execute("UPDATE reservations SET status=? WHERE id=?", (RES_DONE, res["id"]))
                         conn.execute("UPDATE seats SET state=?, updated_at=? WHERE seat_id=?",
                                      (SEAT_FREE, now_str(), seat_id))
+                        seq_mark(conn, seat_id, data)
                         conn.commit()
                         publish_cmd({"cmd": "checkout_ok", "seat_id": seat_id})
                         print(f"[CHECKOUT] Success -> FREE")
                     else:
+                        seq_mark(conn, seat_id, data)
+                        conn.commit()
                         publish_cmd({"cmd": "deny", "seat_id": seat_id})
                     conn.close()
 
@@ -0,0 +1,298 @@
+/*
+ * filtbench - 主机上校验 HGQ_FILTER 的增量滤波并测每次更新的耗时
+ *
+ *   make -C tools/filtbench
+ *   tools/filtbench/filtbench [--n 5] [--trim 1] [--shift 2] [--k 3.0] [--min 0] [--rep 2000] [TRACE ...]
+ *
+ * TRACE 是样本文件，每行取最后一个整数 (没有数字的行跳过)，串口日志直接 grep 出来就能用；
+ * 不给文件时用内置的三条合成数据 (测距/温度x100/光照，带噪声和尖峰，已知真值)。
+ * 每条数据上：
+ *   - 中位数 / 去两端平均 / Hampel 与“每次整窗排序”的参考实现逐点比较，必须完全一致
+ *   - EMA 与浮点参考比较，给出最大误差
+ *   - 合成数据额外给出相对真值的均方根误差，看滤波效果
+ *   - 每种滤波重复 rep 遍测平均每次更新耗时，旧做法 (冒泡排序 + 去两端平均) 作对照
+ * 有不一致时返回 1。
+ */
+#include "hgq_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+typedef struct {
+    char name[64];
+    int32_t *x;         /* 样本 */
+    int32_t *truth;     /* 真值，文件数据为 NULL */
+    int n;
+} Trace;
+
+static int s_n = 5, s_trim = 1, s_shift = 2, s_rep = 2000;
+static double s_k = 3.0;
+static int32_t s_min = 0;           /* Hampel 阈值下限 */
+static int s_fail = 0;
+static volatile int32_t s_sink;
+
+/* ---------- 数据 ---------- */
+static int Trace_Load(Trace *t, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+    int cap = 1024;
+    if(!f) return -1;
+    memset(t, 0, sizeof(*t));
+    snprintf(t->name, sizeof(t->name), "%s", path);
+    t->x = malloc(cap * sizeof(int32_t));
+    while(fgets(line, sizeof(line), f)) {
+        char *p = line, *end, *last = NULL;
+        long v = 0;
+        for(; *p; p++) {
+            if((*p == '-' && p[1] >= '0' && p[1] <= '9') || (*p >= '0' && *p <= '9')) {
+                v = strtol(p, &end, 10);
+                last = p;
+                p = end - 1;
+            }
+        }
+        if(!last) continue;
+        if(t->n == cap) { cap *= 2; t->x = realloc(t->x, cap * sizeof(int32_t)); }
+        t->x[t->n++] = (int32_t)v;
+    }
+    fclose(f);
+    return t->n ? 0 : -1;
+}
+
+static uint32_t s_seed = 12345;
+static double Rnd(void)     /* [0,1) */
+{
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+static double Gauss(void)
+{
+    double u = Rnd() + 1e-12, v = Rnd();
+    return sqrt(-2.0 * log(u)) * cos(6.283185307 * v);
+}
+
+/* kind 0 测距 mm：800 <-> 350 台阶，sigma 8，2% 尖峰
+ * kind 1 温度 x100：25℃ 附近缓慢变化，sigma 3，1% 坏值
+ * kind 2 光照 lux：300 -> 600 台阶，5% 抖动，1% 尖峰 */
+static void Trace_Synth(Trace *t, int kind, int n)
+{
+    static const char *names[] = {"合成:测距mm", "合成:温度x100", "合成:光照lux"};
+    int i;
+    memset(t, 0, sizeof(*t));
+    snprintf(t->name, sizeof(t->name), "%s", names[kind]);
+    t->n = n;
+    t->x = malloc(n * sizeof(int32_t));
+    t->truth = malloc(n * sizeof(int32_t));
+    for(i = 0; i < n; i++) {
+        double tr, v;
+        if(kind == 0) {
+            tr = (i / 200) % 2 ? 350 : 800;
+            v = tr + 8 * Gauss();
+            if(Rnd() < 0.02) v = Rnd() < 0.5 ? 8190 : 20 + 100 * Rnd();
+        } else if(kind == 1) {
+            tr = 2500 + 50 * sin(i / 150.0);
+            v = tr + 3 * Gauss();
+            if(Rnd() < 0.01) v = Rnd() < 0.5 ? -5000 : 15000;
+        } else {
+            tr = (i / 300) % 2 ? 600 : 300;
+            v = tr * (1 + 0.05 * Gauss());
+            if(Rnd() < 0.01) v = tr * 4;
+        }
+        t->truth[i] = (int32_t)lround(tr);
+        t->x[i] = (int32_t)lround(v);
+    }
+}
+
+/* ---------- 参考实现：每次整窗排序 ---------- */
+static int Cmp(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 取以 i 结尾的窗口 (最多 s_n 个) 排好序，返回个数 */
+static int Win_Sorted(const Trace *t, int i, int32_t *w)
+{
+    int c = i + 1 < s_n ? i + 1 : s_n;
+    memcpy(w, &t->x[i + 1 - c], c * sizeof(int32_t));
+    qsort(w, c, sizeof(int32_t), Cmp);
+    return c;
+}
+
+static int32_t Ref_Median(const int32_t *w, int c)
+{
+    if(c & 1) return w[c / 2];
+    return (int32_t)(((int64_t)w[c / 2 - 1] + w[c / 2]) / 2);
+}
+
+static int32_t Ref_TrimMean(const int32_t *w, int c)
+{
+    int trim = s_trim, j;
+    int64_t sum = 0;
+    if(c < 3 || trim * 2 >= c) trim = 0;
+    for(j = trim; j < c - trim; j++) sum += w[j];
+    return (int32_t)(sum / (c - 2 * trim));
+}
+
+static int32_t Ref_Hampel(const Trace *t, int i, const int32_t *w, int c)
+{
+    int32_t med = Ref_Median(w, c), dev[HGQ_FILT_WIN_MAX], mad;
+    int64_t d;
+    int j;
+    if(c < 3) return t->x[i];
+    for(j = 0; j < c; j++) { d = (int64_t)w[j] - med; dev[j] = (int32_t)(d < 0 ? -d : d); }
+    qsort(dev, c, sizeof(int32_t), Cmp);
+    mad = dev[c / 2];
+    d = (int64_t)t->x[i] - med;
+    if(d < 0) d = -d;
+    if(d > s_min && d * 65536 > (int64_t)(uint16_t)lround(s_k * 256) * 380 * mad) return med;
+    return t->x[i];
+}
+
+/* 旧做法：拷贝窗口冒泡排序再去两端平均 (原 read_raw_filtered / Feed) */
+static int32_t Old_TrimMean(int32_t *ring, int *cnt, int *pos, int32_t x)
+{
+    int32_t buf[HGQ_FILT_WIN_MAX], tmp;
+    int i, j, c, trim = s_trim;
+    int64_t sum = 0;
+    ring[*pos] = x;
+    *pos = (*pos + 1) % s_n;
+    if(*cnt < s_n) (*cnt)++;
+    c = *cnt;
+    memcpy(buf, ring, c * sizeof(int32_t));
+    for(i = 0; i < c - 1; i++)
+        for(j = 0; j < c - 1 - i; j++)
+            if(buf[j] > buf[j + 1]) { tmp = buf[j]; buf[j] = buf[j + 1]; buf[j + 1] = tmp; }
+    if(c < 3 || trim * 2 >= c) trim = 0;
+    for(i = trim; i < c - trim; i++) sum += buf[i];
+    return (int32_t)(sum / (c - 2 * trim));
+}
+
+/* ---------- 比较 ---------- */
+enum { F_RAW = 0, F_MED, F_TRIM, F_EMA, F_HAMPEL, F_OLD, F_NUM };
+static const char *f_name[F_NUM] = {"原始", "中位数", "去两端平均", "EMA", "Hampel", "旧:排序平均"};
+
+static double Now_Ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double Bench(const Trace *t, int f)
+{
+    static HGQ_Median m;
+    static HGQ_TrimMean tm;
+    static HGQ_Ema e;
+    static HGQ_Hampel h;
+    int32_t ring[HGQ_FILT_WIN_MAX];
+    int r, i, cnt, pos;
+    uint16_t k_q8 = (uint16_t)lround(s_k * 256);
+    double t0 = Now_Ns();
+
+    for(r = 0; r < s_rep; r++) {
+        switch(f) {
+        case F_MED:    HGQ_Median_Init(&m, s_n); for(i = 0; i < t->n; i++) s_sink = HGQ_Median_Put(&m, t->x[i]); break;
+        case F_TRIM:   HGQ_TrimMean_Init(&tm, s_n, s_trim); for(i = 0; i < t->n; i++) s_sink = HGQ_TrimMean_Put(&tm, t->x[i]); break;
+        case F_EMA:    HGQ_Ema_Init(&e, s_shift); for(i = 0; i < t->n; i++) s_sink = HGQ_Ema_Put(&e, t->x[i]); break;
+        case F_HAMPEL: HGQ_Hampel_Init(&h, s_n, k_q8, s_min); for(i = 0; i < t->n; i++) s_sink = HGQ_Hampel_Put(&h, t->x[i]); break;
+        case F_OLD:    cnt = pos = 0; for(i = 0; i < t->n; i++) s_sink = Old_TrimMean(ring, &cnt, &pos, t->x[i]); break;
+        default:       return 0;
+        }
+    }
+    return (Now_Ns() - t0) / ((double)s_rep * t->n);
+}
+
+static void Run(const Trace *t)
+{
+    static HGQ_Median m;
+    static HGQ_TrimMean tm;
+    static HGQ_Ema e;
+    static HGQ_Hampel h;
+    int32_t w[HGQ_FILT_WIN_MAX], out[F_NUM];
+    long bad[F_NUM] = {0};
+    double se[F_NUM] = {0}, ema_ref = 0, ema_err = 0;
+    int i, f, c;
+    int32_t ring[HGQ_FILT_WIN_MAX];
+    int cnt = 0, pos = 0;
+
+    HGQ_Median_Init(&m, s_n);
+    HGQ_TrimMean_Init(&tm, s_n, s_trim);
+    HGQ_Ema_Init(&e, s_shift);
+    HGQ_Hampel_Init(&h, s_n, (uint16_t)lround(s_k * 256), s_min);
+
+    for(i = 0; i < t->n; i++) {
+        int32_t x = t->x[i];
+        c = Win_Sorted(t, i, w);
+        out[F_RAW] = x;
+        out[F_MED] = HGQ_Median_Put(&m, x);
+        out[F_TRIM] = HGQ_TrimMean_Put(&tm, x);
+        out[F_EMA] = HGQ_Ema_Put(&e, x);
+        out[F_HAMPEL] = HGQ_Hampel_Put(&h, x);
+        out[F_OLD] = Old_TrimMean(ring, &cnt, &pos, x);
+
+        if(out[F_MED] != Ref_Median(w, c)) bad[F_MED]++;
+        if(out[F_TRIM] != Ref_TrimMean(w, c)) bad[F_TRIM]++;
+        if(out[F_HAMPEL] != Ref_Hampel(t, i, w, c)) bad[F_HAMPEL]++;
+        if(out[F_OLD] != out[F_TRIM]) bad[F_OLD]++;
+        ema_ref = i ? ema_ref + (x - ema_ref) / (double)(1 << s_shift) : x;
+        if(fabs(out[F_EMA] - ema_ref) > ema_err) ema_err = fabs(out[F_EMA] - ema_ref);
+
+        if(t->truth)
+            for(f = 0; f < F_NUM; f++) se[f] += (double)(out[f] - t->truth[i]) * (out[f] - t->truth[i]);
+    }
+
+    printf("%s  样本=%d  窗口=%d 去端=%d shift=%d k=%.1f min=%ld\n", t->name, t->n, s_n, s_trim, s_shift, s_k, (long)s_min);
+    printf("  %-12s %10s %10s %10s\n", "滤波", "与参考不符", "RMS(真值)", "ns/次");
+    for(f = 0; f < F_NUM; f++) {
+        char rms[16] = "-", chk[24] = "-";
+        if(t->truth) snprintf(rms, sizeof(rms), "%.1f", sqrt(se[f] / t->n));
+        if(f == F_EMA) snprintf(chk, sizeof(chk), "最大差%.2f", ema_err);
+        else if(f != F_RAW) snprintf(chk, sizeof(chk), "%ld", bad[f]);
+        if(f != F_RAW && f != F_EMA && bad[f]) s_fail = 1;
+        if(f == F_EMA && ema_err > 1.0 + (1 << s_shift) / 256.0 * 4) s_fail = 1;
+        printf("  %-12s %10s %10s %10.1f\n", f_name[f], chk, rms, Bench(t, f));
+    }
+    printf("  Hampel 剔除=%lu\n\n", (unsigned long)h.outliers);
+}
+
+static void Usage(void)
+{
+    printf("用法: filtbench [--n 窗口] [--trim 去端] [--shift EMA] [--k Hampel倍数] [--min Hampel下限] [--rep 重复] [TRACE ...]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    Trace t;
+    int i, files = 0;
+
+    for(i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if(a[0] == '-' && a[1] == '-') {
+            if(i + 1 >= argc) Usage();
+            if(!strcmp(a, "--n")) s_n = atoi(argv[++i]);
+            else if(!strcmp(a, "--trim")) s_trim = atoi(argv[++i]);
+            else if(!strcmp(a, "--shift")) s_shift = atoi(argv[++i]);
+            else if(!strcmp(a, "--k")) s_k = atof(argv[++i]);
+            else if(!strcmp(a, "--min")) s_min = atoi(argv[++i]);
+            else if(!strcmp(a, "--rep")) s_rep = atoi(argv[++i]);
+            else Usage();
+        }
+    }
+    if(s_n < 1 || s_n > HGQ_FILT_WIN_MAX || s_rep < 1) Usage();
+
+    for(i = 1; i < argc; i++) {
+        if(argv[i][0] == '-' && argv[i][1] == '-') { i++; continue; }
+        if(Trace_Load(&t, argv[i])) { printf("读取 %s 失败\n", argv[i]); return 2; }
+        Run(&t);
+        files++;
+    }
+    if(!files) {
+        for(i = 0; i < 3; i++) { Trace_Synth(&t, i, 2000); Run(&t); }
+    }
+    printf("参考比较: %s\n", s_fail ? "有差异" : "一致");
+    return s_fail;
+}
@@ -0,0 +1,193 @@
+"""
+字库子集生成工具 (在 PC 上运行)
+
+扫描固件源码里的 GBK 字符串常量 (字节数组 {0xD6,0xC7,...}、"\\xC7\\xF8" 转义串、
+直接写在字符串里的汉字)，从 ALIENTEK 格式的 GBK 点阵字库文件 (GBK16.FON 等，
+就是烧进 W25Q128 的那份) 里取出这些字的点阵，生成 TEXT/hzsub.c。
+Get_HzMat 先查这张内部 Flash 常量表，查不到才读 SPI Flash。
+
+用法:
+    python tools/font_subset.py --font 16=GBK16.FON
+    python tools/font_subset.py --font 16=GBK16.FON --font 24=GBK24.FON --extra "已满空闲"
+
+界面文字改动后重新运行一次，并提交生成的 TEXT/hzsub.c。
+"""
+import argparse
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# 默认扫描的源码：界面文字只出现在主程序和 UI 模块里，其它模块的中文都是串口日志
+DEFAULT_SCAN = ["USER/main.c", "My_lin/HGQ_UI/*.c"]
+DEFAULT_OUT = "TEXT/hzsub.c"
+
+RE_COMMENT = re.compile(r'//[^\n]*|/\*.*?\*/|("(?:\\.|[^"\\\n])*")|(\'(?:\\.|[^\'\\\n])*\')', re.S)
+RE_STRING = re.compile(r'"((?:\\.|[^"\\\n])*)"')
+# 串口日志不上屏：整条 printf/puts 语句里的字符串都不算界面文字
+RE_PRINTF = re.compile(r'\b(?:printf|puts)\s*\((?:[^;"]|"(?:\\.|[^"\\\n])*")*\)\s*;')
+RE_HEXARR = re.compile(r'\{\s*(0[xX][0-9a-fA-F]{1,2}(?:\s*,\s*0[xX][0-9a-fA-F]{1,2})*)\s*,?\s*\}')
+
+
+def strip_comments(text):
+    """去掉注释，保留字符串/字符常量 (注释里的中文不是界面文字)"""
+    return RE_COMMENT.sub(lambda m: m.group(1) or m.group(2) or " ", text)
+
+
+def unescape(body):
+    """C 字符串常量内容 -> GBK 字节"""
+    out = bytearray()
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c != "\\":
+            out += c.encode("gbk", errors="ignore")
+            i += 1
+            continue
+        i += 1
+        if i >= len(body):
+            break
+        c = body[i]
+        if c in "xX":
+            m = re.match(r"[0-9a-fA-F]{1,2}", body[i + 1:])
+            if m:
+                out.append(int(m.group(0), 16))
+                i += 1 + len(m.group(0))
+                continue
+        m = re.match(r"[0-7]{1,3}", body[i:])
+        if m:
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += len(m.group(0))
+            continue
+        out += {"n": b"\n", "r": b"\r", "t": b"\t", "0": b"\0"}.get(c, c.encode("gbk", errors="ignore"))
+        i += 1
+    return bytes(out)
+
+
+def gbk_pairs(data):
+    """按 Show_Str 的规则切出汉字 (首字节 > 0x80 占两个字节)，只保留 Get_HzMat 认为有效的码"""
+    i = 0
+    while i < len(data):
+        if data[i] == 0:
+            break
+        if data[i] > 0x80 and i + 1 < len(data):
+            qh, ql = data[i], data[i + 1]
+            if not (qh < 0x81 or ql < 0x40 or ql == 0xFF or qh == 0xFF):
+                yield (qh << 8) | ql
+            i += 2
+        else:
+            i += 1
+
+
+def scan_file(path, encoding):
+    with open(path, "rb") as f:
+        text = f.read().decode(encoding, errors="replace")
+    text = RE_PRINTF.sub("", strip_comments(text))
+    codes = set()
+    for m in RE_HEXARR.finditer(text):
+        data = bytes(int(x, 16) for x in re.findall(r"0[xX]([0-9a-fA-F]{1,2})", m.group(1)))
+        codes.update(gbk_pairs(data))
+    for m in RE_STRING.finditer(text):
+        codes.update(gbk_pairs(unescape(m.group(1))))
+    return codes
+
+
+def glyph_bytes(size):
+    return (size // 8 + (1 if size % 8 else 0)) * size
+
+
+def glyph_offset(code, size):
+    """与 text.c 的 Get_HzMat 相同的偏移计算"""
+    qh, ql = code >> 8, code & 0xFF
+    ql = ql - 0x40 if ql < 0x7F else ql - 0x41
+    return (190 * (qh - 0x81) + ql) * glyph_bytes(size)
+
+
+def emit(out_path, fonts, codes, sources):
+    lines = [
+        "//由 tools/font_subset.py 生成,请勿手工修改",
+        "//来源: " + " ".join(sources),
+    ]
+    if codes:
+        chars = "".join(bytes([c >> 8, c & 0xFF]).decode("gbk", errors="replace") for c in codes)
+        for i in range(0, len(chars), 40):
+            lines.append("//" + chars[i:i + 40])
+    lines += ['#include "text.h"', ""]
+
+    entries = []
+    total = 0
+    for size in sorted(fonts):
+        csize = glyph_bytes(size)
+        with open(fonts[size], "rb") as f:
+            fon = f.read()
+        mats = []
+        for code in codes:
+            off = glyph_offset(code, size)
+            mat = fon[off:off + csize]
+            if len(mat) != csize:
+                sys.exit("字库文件 %s 太短, 缺少 0x%04X" % (fonts[size], code))
+            mats.append(mat)
+        lines.append("static const u16 hzsub%d_code[%d]={" % (size, len(codes)))
+        for i in range(0, len(codes), 12):
+            lines.append("\t" + ",".join("0x%04X" % c for c in codes[i:i + 12]) + ",")
+        lines.append("};")
+        lines.append("static const u8 hzsub%d_mat[%d]={" % (size, len(codes) * csize))
+        for code, mat in zip(codes, mats):
+            lines.append("\t" + ",".join("0x%02X" % b for b in mat) + ",\t//%04X" % code)
+        lines.append("};")
+        lines.append("")
+        entries.append("\t{%d,%d,hzsub%d_code,hzsub%d_mat}," % (size, len(codes), size, size))
+        total += len(codes) * (csize + 2)
+
+    if entries:
+        lines.append("const _hz_subset hz_subset[%d]={" % len(entries))
+        lines += entries
+        lines.append("};")
+        lines.append("const u8 hz_subset_num=%d;" % len(entries))
+    else:
+        lines.append("const _hz_subset hz_subset[1]={{0,0,0,0}};")
+        lines.append("const u8 hz_subset_num=0;")
+
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+    return total
+
+
+def main():
+    ap = argparse.ArgumentParser(description="从源码中的 GBK 字符串生成内部 Flash 字模子集")
+    ap.add_argument("--font", action="append", default=[], metavar="SIZE=FILE",
+                    help="点阵字库文件, 如 16=GBK16.FON (可重复, 每个字号一个)")
+    ap.add_argument("--scan", action="append", metavar="GLOB",
+                    help="要扫描的源码 (相对仓库根目录, 默认 %s)" % " ".join(DEFAULT_SCAN))
+    ap.add_argument("--extra", default="", help="额外加入的文字 (运行时才出现的固定用词)")
+    ap.add_argument("--encoding", default="gb18030", help="源码文件编码 (默认 gb18030)")
+    ap.add_argument("--out", default=DEFAULT_OUT, help="输出文件 (默认 %s)" % DEFAULT_OUT)
+    args = ap.parse_args()
+
+    fonts = {}
+    for spec in args.font:
+        size, _, path = spec.partition("=")
+        if size not in ("12", "16", "24") or not path:
+            ap.error("--font 格式为 12|16|24=文件")
+        fonts[int(size)] = path
+    if not fonts:
+        ap.error("至少需要一个 --font")
+
+    sources = []
+    for pattern in args.scan or DEFAULT_SCAN:
+        sources += sorted(glob.glob(os.path.join(ROOT, pattern), recursive=True))
+    codes = set()
+    for path in sources:
+        codes |= scan_file(path, args.encoding)
+    codes |= set(gbk_pairs(args.extra.encode("gbk", errors="ignore")))
+    codes = sorted(codes)
+
+    rel = [os.path.relpath(p, ROOT).replace(os.sep, "/") for p in sources]
+    total = emit(os.path.join(ROOT, args.out), fonts, codes, rel)
+    print("%d 个汉字, %d 种字号, 占内部 Flash %d 字节 -> %s" % (len(codes), len(fonts), total, args.out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,15 @@
+/* 把 HARDWARE/LCD/lcd.c 按 C++ 编译，LCD_REG / LCD_RAM 换成计数端口 (见 lcdsim_bus.h) */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "lcdsim.h"
+extern "C" {
+#include "sys.h"
+}
+#include "lcdsim_bus.h"
+
+LCD_TypeDef lcdsim_port = { {0}, {1} };
+
+extern "C" {
+#include "../../HARDWARE/LCD/lcd.c"
+}
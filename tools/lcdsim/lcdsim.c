@@ -0,0 +1,284 @@
+#include "lcdsim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint16_t id;
+    uint16_t w, h;          /* 面板原生尺寸 */
+    uint8_t  cmd16;         /* NT35510: 16 位命令，低字节为参数序号 */
+} CtrlInfo;
+
+static const CtrlInfo s_info[] = {
+    { 0x9341, 240, 320, 0 },
+    { 0x5510, 480, 800, 1 },
+    { 0x1963, 800, 480, 0 },
+};
+
+static const CtrlInfo *s_ctrl = &s_info[0];
+static uint16_t *s_gram = NULL;
+static LcdSimCount s_cnt;
+
+static uint16_t s_cmd;          /* 当前命令 (NT35510 去掉了参数序号) */
+static uint8_t  s_argi;         /* 8 位命令：已收到的参数个数 */
+static uint8_t  s_ram;          /* 1: 0x2C 之后，数据口写入 GRAM */
+static uint8_t  s_mad;          /* 0x36 MADCTL */
+static uint16_t s_col[2], s_page[2];    /* 列/页窗口 [起, 止] */
+static uint16_t s_cx, s_cy;     /* 写指针 (列, 页) */
+
+#define MAD_MY  0x80
+#define MAD_MX  0x40
+#define MAD_MV  0x20
+
+void lcdsim_init(LcdSimCtrl ctrl)
+{
+    s_ctrl = &s_info[ctrl <= LCDSIM_SSD1963 ? ctrl : 0];
+    free(s_gram);
+    s_gram = (uint16_t *)calloc((size_t)s_ctrl->w * s_ctrl->h, sizeof(uint16_t));
+    memset(&s_cnt, 0, sizeof(s_cnt));
+    s_cmd = 0; s_argi = 0; s_ram = 0; s_mad = 0;
+    s_col[0] = 0; s_col[1] = s_ctrl->w - 1;
+    s_page[0] = 0; s_page[1] = s_ctrl->h - 1;
+    s_cx = s_cy = 0;
+}
+
+uint16_t lcdsim_ctrl_id(void)
+{
+    return s_ctrl->id;
+}
+
+/* 列/页 -> 面板物理坐标：MV 交换行列，MX/MY 镜像 */
+static int Map(uint16_t col, uint16_t page, uint32_t *idx)
+{
+    uint32_t nx, ny;
+    if(s_mad & MAD_MV) { nx = page; ny = col; } else { nx = col; ny = page; }
+    if(nx >= s_ctrl->w || ny >= s_ctrl->h) return 0;
+    if(s_mad & MAD_MX) nx = s_ctrl->w - 1 - nx;
+    if(s_mad & MAD_MY) ny = s_ctrl->h - 1 - ny;
+    *idx = ny * s_ctrl->w + nx;
+    return 1;
+}
+
+static void Pixel(uint16_t v)
+{
+    uint32_t idx;
+    if(Map(s_cx, s_cy, &idx)) s_gram[idx] = v;
+    else s_cnt.clipped++;
+    if(s_cx >= s_col[1]) {
+        s_cx = s_col[0];
+        s_cy = s_cy >= s_page[1] ? s_page[0] : s_cy + 1;
+    } else {
+        s_cx++;
+    }
+}
+
+/* 地址参数按字节写入：n=0/1 起始高/低，2/3 结束高/低 */
+static void Addr_Byte(uint16_t *win, uint8_t n, uint8_t b)
+{
+    uint16_t *v = &win[n >> 1];
+    if(n & 1) *v = (*v & 0xFF00) | b;
+    else      *v = (uint16_t)((*v & 0x00FF) | (b << 8));
+}
+
+void lcdsim_bus_wr(int rs, uint16_t v)
+{
+    lcdsim_tick(LCDSIM_WR_HCLK);
+    if(!rs) {
+        s_cnt.cmd++;
+        s_ram = 0;
+        if(s_ctrl->cmd16) { s_cmd = v & 0xFF00; s_argi = v & 0xFF; }
+        else              { s_cmd = v; s_argi = 0; }
+        if(s_cmd == (s_ctrl->cmd16 ? 0x2C00 : 0x2C)) {
+            s_ram = 1; s_cx = s_col[0]; s_cy = s_page[0];
+        } else if(s_cmd == (s_ctrl->cmd16 ? 0x3C00 : 0x3C)) {
+            s_ram = 1;              /* 继续写，不复位写指针 */
+        }
+        return;
+    }
+    if(s_ram) { s_cnt.pixel++; Pixel(v); return; }
+
+    s_cnt.param++;
+    switch(s_ctrl->cmd16 ? s_cmd >> 8 : s_cmd) {
+    case 0x2A: if(s_argi < 4) Addr_Byte(s_col, s_argi, (uint8_t)v); break;
+    case 0x2B: if(s_argi < 4) Addr_Byte(s_page, s_argi, (uint8_t)v); break;
+    case 0x36: if(s_argi == 0) s_mad = (uint8_t)v; break;
+    default: break;                 /* 初始化序列等其余命令不影响画面 */
+    }
+    if(!s_ctrl->cmd16) s_argi++;
+}
+
+uint16_t lcdsim_bus_rd(int rs)
+{
+    (void)rs;
+    s_cnt.reads++;
+    return 0;
+}
+
+void lcdsim_dma_wr(uint16_t v)
+{
+    lcdsim_tick(LCDSIM_WR_HCLK);
+    if(!s_ram) { s_cnt.param++; return; }
+    s_cnt.dma++;
+    Pixel(v);
+}
+
+void lcdsim_count(LcdSimCount *c)
+{
+    *c = s_cnt;
+}
+
+uint32_t lcdsim_count_writes(const LcdSimCount *c)
+{
+    return c->cmd + c->param + c->pixel + c->dma;
+}
+
+uint32_t lcdsim_count_us(const LcdSimCount *c)
+{
+    return (uint32_t)((uint64_t)lcdsim_count_writes(c) * LCDSIM_WR_HCLK * 1000000u / LCDSIM_HCLK_HZ);
+}
+
+/* ---------- 导出 ---------- */
+void lcdsim_view(uint16_t *w, uint16_t *h)
+{
+    if(s_mad & MAD_MV) { *w = s_ctrl->h; *h = s_ctrl->w; }
+    else               { *w = s_ctrl->w; *h = s_ctrl->h; }
+}
+
+void lcdsim_snapshot(uint8_t *rgb)
+{
+    uint16_t w, h, x, y;
+    lcdsim_view(&w, &h);
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) {
+            uint32_t idx;
+            uint16_t c = Map(x, y, &idx) ? s_gram[idx] : 0;
+            /* RGB565 -> 888，低位补高位 */
+            *rgb++ = (uint8_t)(((c >> 11) << 3) | (c >> 13));
+            *rgb++ = (uint8_t)((((c >> 5) & 0x3F) << 2) | ((c >> 9) & 0x03));
+            *rgb++ = (uint8_t)(((c & 0x1F) << 3) | ((c >> 2) & 0x07));
+        }
+    }
+}
+
+static uint8_t *Snap_Alloc(uint16_t *w, uint16_t *h)
+{
+    uint8_t *rgb;
+    lcdsim_view(w, h);
+    rgb = (uint8_t *)malloc((size_t)*w * *h * 3);
+    if(rgb) lcdsim_snapshot(rgb);
+    return rgb;
+}
+
+int lcdsim_save_ppm(const char *path)
+{
+    uint16_t w, h;
+    uint8_t *rgb = Snap_Alloc(&w, &h);
+    FILE *f = fopen(path, "wb");
+    if(!rgb || !f) { free(rgb); if(f) fclose(f); return -1; }
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    fwrite(rgb, 3, (size_t)w * h, f);
+    fclose(f);
+    free(rgb);
+    return 0;
+}
+
+/* PNG：deflate 只用不压缩的 stored 块，不依赖 zlib */
+static uint32_t s_crc_tab[256];
+
+static uint32_t Crc32(uint32_t crc, const uint8_t *p, size_t n)
+{
+    if(!s_crc_tab[1]) {
+        uint32_t i, k, c;
+        for(i = 0; i < 256; i++) {
+            for(c = i, k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            s_crc_tab[i] = c;
+        }
+    }
+    crc = ~crc;
+    while(n--) crc = s_crc_tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void Put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+static void Png_Chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t b[4];
+    uint32_t crc;
+    Put32(b, len); fwrite(b, 1, 4, f);
+    fwrite(type, 1, 4, f);
+    if(len) fwrite(data, 1, len, f);
+    crc = Crc32(0, (const uint8_t *)type, 4);
+    crc = Crc32(crc, data, len);
+    Put32(b, crc); fwrite(b, 1, 4, f);
+}
+
+int lcdsim_save_png(const char *path)
+{
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint16_t w, h, y;
+    uint8_t *rgb = Snap_Alloc(&w, &h), *raw, *z, *q, hdr[13];
+    size_t row = (size_t)w * 3 + 1, n, left, off = 0;
+    uint32_t a = 1, b = 0;
+    FILE *f;
+
+    if(!rgb) return -1;
+    n = row * h;
+    raw = (uint8_t *)malloc(n);
+    z = (uint8_t *)malloc(n + (n / 65535 + 1) * 5 + 6);
+    f = fopen(path, "wb");
+    if(!raw || !z || !f) { free(rgb); free(raw); free(z); if(f) fclose(f); return -1; }
+
+    for(y = 0; y < h; y++) {
+        raw[y * row] = 0;                           /* 过滤方式 None */
+        memcpy(&raw[y * row + 1], &rgb[(size_t)y * w * 3], (size_t)w * 3);
+    }
+    for(off = 0; off < n; off++) { a = (a + raw[off]) % 65521; b = (b + a) % 65521; }
+
+    q = z;
+    *q++ = 0x78; *q++ = 0x01;
+    for(off = 0; off < n; off += left) {
+        left = n - off > 65535 ? 65535 : n - off;
+        *q++ = (off + left == n);                  /* BFINAL, BTYPE=00 */
+        *q++ = (uint8_t)left; *q++ = (uint8_t)(left >> 8);
+        *q++ = (uint8_t)~left; *q++ = (uint8_t)(~left >> 8);
+        memcpy(q, &raw[off], left); q += left;
+    }
+    Put32(q, (b << 16) | a); q += 4;
+
+    Put32(hdr, w); Put32(hdr + 4, h);
+    hdr[8] = 8; hdr[9] = 2; hdr[10] = 0; hdr[11] = 0; hdr[12] = 0;    /* 8bit RGB */
+    fwrite(sig, 1, 8, f);
+    Png_Chunk(f, "IHDR", hdr, 13);
+    Png_Chunk(f, "IDAT", z, (uint32_t)(q - z));
+    Png_Chunk(f, "IEND", NULL, 0);
+    fclose(f);
+    free(rgb); free(raw); free(z);
+    return 0;
+}
+
+long lcdsim_compare_ppm(const char *path)
+{
+    unsigned rw, rh, maxv;
+    uint16_t w, h;
+    uint8_t *cur, *ref;
+    size_t i, n;
+    long diff = 0;
+    FILE *f = fopen(path, "rb");
+
+    if(!f) return -1;
+    if(fscanf(f, "P6 %u %u %u", &rw, &rh, &maxv) != 3 || fgetc(f) == EOF) { fclose(f); return -1; }
+    lcdsim_view(&w, &h);
+    if(rw != w || rh != h || maxv != 255) { fclose(f); return -1; }
+    n = (size_t)w * h;
+    cur = Snap_Alloc(&w, &h);
+    ref = (uint8_t *)malloc(n * 3);
+    if(!cur || !ref || fread(ref, 3, n, f) != n) { fclose(f); free(cur); free(ref); return -1; }
+    fclose(f);
+    for(i = 0; i < n; i++) if(memcmp(&cur[i * 3], &ref[i * 3], 3)) diff++;
+    free(cur); free(ref);
+    return diff;
+}
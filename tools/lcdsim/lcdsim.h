@@ -0,0 +1,63 @@
+#ifndef __LCDSIM_H
+#define __LCDSIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * FSMC LCD 总线模拟 + 控制器模型
+ *   - 8080 总线两个口：RS=0 写命令 (LCD->LCD_REG)，RS=1 写参数/像素 (LCD->LCD_RAM)
+ *   - 控制器按 MIPI DCS 的列/页地址语义维护窗口和写指针：
+ *       ILI9341 / SSD1963: 8 位命令 0x2A/0x2B 后跟 4 个参数字节，0x2C 开始写 GRAM
+ *       NT35510:           16 位命令 0x2A00+n / 0x2B00+n 各带 1 个参数字节，0x2C00 开始写 GRAM
+ *     0x36(00) 的 MV/MX/MY 决定列/页到面板物理坐标的映射，只写起始地址时保留原结束地址
+ *   - GRAM 按面板原生尺寸保存，导出时按当前扫描方向还原成驱动看到的 x/y
+ *   - GRAM 读回不建模，读操作只计数并返回 0
+ */
+typedef enum {
+    LCDSIM_ILI9341 = 0,     /* 240x320，也代表 9341/7789/5310 类 */
+    LCDSIM_NT35510,         /* 480x800 */
+    LCDSIM_SSD1963          /* 800x480 */
+} LcdSimCtrl;
+
+typedef struct {
+    uint32_t cmd;           /* 命令写 (RS=0) */
+    uint32_t param;         /* 参数写 (RS=1，非 GRAM 写状态) */
+    uint32_t pixel;         /* CPU 写入的像素 */
+    uint32_t dma;           /* DMA 写入的像素 */
+    uint32_t reads;         /* 总线读 */
+    uint32_t clipped;       /* 落在面板外的像素 (驱动窗口越界) */
+} LcdSimCount;
+
+#define LCDSIM_HCLK_HZ      168000000u
+#define LCDSIM_WR_HCLK      10      /* 每次总线写约占的 HCLK 数 (ADDSET 4 + DATAST 4 + 间隔)，只用于估算 */
+
+void     lcdsim_init(LcdSimCtrl ctrl);
+uint16_t lcdsim_ctrl_id(void);              /* 对应的 lcddev.id */
+void     lcdsim_bus_wr(int rs, uint16_t v);
+uint16_t lcdsim_bus_rd(int rs);
+void     lcdsim_dma_wr(uint16_t v);         /* DMA 写数据口 */
+void     lcdsim_tick(uint32_t hclk);        /* 推进模拟的 DWT->CYCCNT (lcdsim_hal.c) */
+
+void     lcdsim_count(LcdSimCount *c);      /* 当前累计值 */
+uint32_t lcdsim_count_writes(const LcdSimCount *c);
+uint32_t lcdsim_count_us(const LcdSimCount *c);   /* 按 LCDSIM_WR_HCLK 估算的总线时间 */
+
+/* 按驱动坐标导出 (w/h 为当前方向下的宽高)，rgb 为 w*h*3 字节 */
+void     lcdsim_view(uint16_t *w, uint16_t *h);
+void     lcdsim_snapshot(uint8_t *rgb);
+int      lcdsim_save_ppm(const char *path);
+int      lcdsim_save_png(const char *path);
+long     lcdsim_compare_ppm(const char *path);   /* 与参考图不同的像素数，<0 读取失败或尺寸不符 */
+
+/* 字库：把 GBK12/16/24.FON 映射到 ftinfo 的地址上，W25QXX_Read 从这里取 */
+int      lcdsim_load_font(uint8_t size, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
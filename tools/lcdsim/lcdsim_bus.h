@@ -0,0 +1,26 @@
+#ifndef __LCDSIM_BUS_H
+#define __LCDSIM_BUS_H
+
+/*
+ * LCD_SIM 下 lcd.h 用这里的 LCD_TypeDef 代替 FSMC 地址结构体。
+ * lcd.c 以 C++ 编译 (lcd_host.cpp)，LCD_REG / LCD_RAM 是带赋值/取值运算符的端口对象，
+ * 每次 LCD->LCD_RAM = x 都进入控制器模型并计数，驱动源码不用改动。
+ * 其他 .c 文件按 C 编译，不允许直接访问 LCD-> (这里不定义 LCD，误用会编译失败)。
+ */
+#include "lcdsim.h"
+
+#ifdef __cplusplus
+struct LcdSimPort {
+    int rs;
+    LcdSimPort &operator=(uint16_t v) { lcdsim_bus_wr(rs, v); return *this; }
+    operator uint16_t() const { return lcdsim_bus_rd(rs); }
+};
+typedef struct {
+    LcdSimPort LCD_REG;
+    LcdSimPort LCD_RAM;
+} LCD_TypeDef;
+extern LCD_TypeDef lcdsim_port;
+#define LCD     (&lcdsim_port)
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * 主机模拟：lcd.c / text.c 用到的外设库、延时、字库 Flash 的替身
+ *   - DMA2 Stream0 存储器到存储器填充在 DMA_Cmd(ENABLE) 时同步执行完，随后调用真实的
+ *     DMA2_Stream0_IRQHandler，驱动里的分段续传、恢复窗口、回调都照常走一遍
+ *   - GPIO/FSMC/RCC/NVIC 只为链接，LCD_Init 不在主机上运行 (它读 ID、改 FSMC 时序)
+ */
+#include "lcdsim.h"
+#include "sys.h"
+#include "delay.h"
+#include "w25qxx.h"
+#include "fontupd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t       SystemCoreClock = LCDSIM_HCLK_HZ;
+DWT_Type       lcdsim_dwt;
+CoreDebug_Type lcdsim_coredebug;
+
+void lcdsim_tick(uint32_t hclk)
+{
+    lcdsim_dwt.CYCCNT += hclk;
+}
+
+/* ---------- DMA2 Stream0 ---------- */
+extern void DMA2_Stream0_IRQHandler(void);
+
+static uint32_t s_dma_src;      /* 源地址 (颜色变量)，主机按 -no-pie 链接，静态变量地址在 4GB 以内 */
+static uint16_t s_dma_ndtr;
+static uint32_t s_dma_it;       /* 已完成、待中断处理的标志 */
+
+void DMA_DeInit(DMA_Stream_TypeDef *s) { (void)s; s_dma_it = 0; }
+FunctionalState DMA_GetCmdStatus(DMA_Stream_TypeDef *s) { (void)s; return DISABLE; }
+void DMA_ITConfig(DMA_Stream_TypeDef *s, uint32_t it, FunctionalState st) { (void)s; (void)it; (void)st; }
+void DMA_ClearFlag(DMA_Stream_TypeDef *s, uint32_t flag) { (void)s; (void)flag; s_dma_it = 0; }
+void DMA_SetCurrDataCounter(DMA_Stream_TypeDef *s, uint16_t n) { (void)s; s_dma_ndtr = n; }
+/* DMA_IT_xxx 高位是寄存器选择位，只比较低 28 位的标志位 */
+ITStatus DMA_GetITStatus(DMA_Stream_TypeDef *s, uint32_t it) { (void)s; return (s_dma_it & it & 0x0FFFFFFF) ? SET : RESET; }
+void DMA_ClearITPendingBit(DMA_Stream_TypeDef *s, uint32_t it) { (void)s; s_dma_it &= ~it; }
+
+void DMA_Init(DMA_Stream_TypeDef *s, DMA_InitTypeDef *init)
+{
+    (void)s;
+    s_dma_src = init->DMA_PeripheralBaseAddr;
+}
+
+void DMA_Cmd(DMA_Stream_TypeDef *s, FunctionalState st)
+{
+    uint16_t v;
+    (void)s;
+    if(st != ENABLE || !s_dma_src) return;
+    v = *(const uint16_t *)(uintptr_t)s_dma_src;       /* 源地址不递增 */
+    while(s_dma_ndtr) { lcdsim_dma_wr(v); s_dma_ndtr--; }
+    s_dma_it |= DMA_IT_TCIF0;
+    DMA2_Stream0_IRQHandler();
+}
+
+/* ---------- 只为链接 ---------- */
+void GPIO_Init(GPIO_TypeDef *g, GPIO_InitTypeDef *i) { (void)g; (void)i; }
+void GPIO_PinAFConfig(GPIO_TypeDef *g, uint16_t src, uint8_t af) { (void)g; (void)src; (void)af; }
+void RCC_AHB1PeriphClockCmd(uint32_t p, FunctionalState st) { (void)p; (void)st; }
+void RCC_AHB3PeriphClockCmd(uint32_t p, FunctionalState st) { (void)p; (void)st; }
+void FSMC_NORSRAMInit(FSMC_NORSRAMInitTypeDef *i) { (void)i; }
+void FSMC_NORSRAMCmd(uint32_t bank, FunctionalState st) { (void)bank; (void)st; }
+void NVIC_Init(NVIC_InitTypeDef *i) { (void)i; }
+void delay_ms(u16 nms) { (void)nms; }
+void delay_us(u32 nus) { (void)nus; }
+
+/* ---------- 字库 ---------- */
+_font_info ftinfo;
+
+static uint8_t *s_font[3];      /* 12 / 16 / 24 */
+static uint32_t s_font_len[3];
+
+#define FONT_BASE(i)    (0x01000000u * ((i) + 1))
+
+int lcdsim_load_font(uint8_t size, const char *path)
+{
+    int i = size == 12 ? 0 : size == 16 ? 1 : size == 24 ? 2 : -1;
+    long n;
+    FILE *f;
+    if(i < 0 || (f = fopen(path, "rb")) == NULL) return -1;
+    fseek(f, 0, SEEK_END); n = ftell(f); fseek(f, 0, SEEK_SET);
+    free(s_font[i]);
+    s_font[i] = (uint8_t *)malloc((size_t)n);
+    if(!s_font[i] || fread(s_font[i], 1, (size_t)n, f) != (size_t)n) { fclose(f); return -1; }
+    fclose(f);
+    s_font_len[i] = (uint32_t)n;
+    ftinfo.f12addr = FONT_BASE(0);
+    ftinfo.f16addr = FONT_BASE(1);
+    ftinfo.f24addr = FONT_BASE(2);
+    ftinfo.fontok = 0xAA;           /* 任一字号加载后即视为字库可用，缺的字号读出空白 */
+    return 0;
+}
+
+void W25QXX_Read(u8 *buf, u32 addr, u16 n)
+{
+    uint32_t i = (addr >> 24) - 1, off = addr & 0x00FFFFFF;
+    memset(buf, 0, n);
+    if(i < 3 && s_font[i] && off < s_font_len[i]) {
+        if(off + n > s_font_len[i]) n = (u16)(s_font_len[i] - off);
+        memcpy(buf, s_font[i] + off, n);
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * lcdsim - 主机上运行 HGQ_UI 的绘制代码，统计 FSMC 总线写次数并导出画面
+ *
+ *   make -C tools/lcdsim
+ *   tools/lcdsim/lcdsim [--ctrl 9341|5510|1963] [--dir 0|1] [--font16 GBK16.FON]
+ *                       [--font12 ..] [--font24 ..] [--out DIR] [--check DIR] [--png]
+ *
+ * 按固定脚本调用 HGQ_UI_Init / DrawFramework / Update / ShowPopup，每一步打印
+ * 命令/参数/像素/DMA 写次数和按总线时序估算的耗时；--out 把每步画面存成 PPM (加 --png 同时存 PNG)，
+ * --check 与之前保存的 PPM 逐像素比较，有差异时返回 1，优化绘制路径时用来确认画面没变。
+ * 不给字库文件时汉字画成空白 (写次数不变)，界面固定文字若已生成 TEXT/hzsub.c 则正常显示。
+ */
+#include "lcdsim.h"
+#include "lcd.h"
+#include "text.h"
+#include "hgq_ui.h"
+#include "hgq_widget.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *s_out = NULL;
+static const char *s_check = NULL;
+static int s_png = 0;
+static int s_step = 0;
+static int s_fail = 0;
+static LcdSimCount s_last;
+
+/* 弹窗文字 (GBK)：请刷卡签到 */
+static const u8 POP_MSG[] = {0xC7,0xEB,0xCB,0xA2,0xBF,0xA8,0xC7,0xA9,0xB5,0xBD,0x00};
+static const char SEAT_GBK[] = "A-01";
+
+static void Step(const char *name)
+{
+    LcdSimCount c, d;
+    char path[512];
+
+    lcdsim_count(&c);
+    d.cmd = c.cmd - s_last.cmd;
+    d.param = c.param - s_last.param;
+    d.pixel = c.pixel - s_last.pixel;
+    d.dma = c.dma - s_last.dma;
+    d.reads = c.reads - s_last.reads;
+    d.clipped = c.clipped - s_last.clipped;
+    s_last = c;
+
+    printf("%2d %7u %7u %8u %8u %8u %7u  %s\n", s_step, d.cmd, d.param, d.pixel, d.dma,
+           lcdsim_count_writes(&d), lcdsim_count_us(&d), name);
+    if(d.clipped) printf("   ! %u 个像素落在面板外\n", d.clipped);
+
+    if(s_out) {
+        snprintf(path, sizeof(path), "%s/%02d.ppm", s_out, s_step);
+        if(lcdsim_save_ppm(path)) printf("   ! 写 %s 失败\n", path);
+        if(s_png) {
+            snprintf(path, sizeof(path), "%s/%02d.png", s_out, s_step);
+            if(lcdsim_save_png(path)) printf("   ! 写 %s 失败\n", path);
+        }
+    }
+    if(s_check) {
+        long diff;
+        snprintf(path, sizeof(path), "%s/%02d.ppm", s_check, s_step);
+        diff = lcdsim_compare_ppm(path);
+        if(diff) {
+            printf("   ! 与 %s 不一致 (%ld)\n", path, diff);
+            s_fail = 1;
+        }
+    }
+    s_step++;
+}
+
+static void Usage(void)
+{
+    printf("用法: lcdsim [--ctrl 9341|5510|1963] [--dir 0|1] [--font12|--font16|--font24 FILE]\n"
+           "             [--out DIR] [--check DIR] [--png]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    LcdSimCtrl ctrl = LCDSIM_ILI9341;
+    int dir = 1, i;
+    HGQ_UI_Data d;
+    HGQ_WG_Stats wst;
+
+    for(i = 1; i < argc; i++) {
+        const char *a = argv[i], *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if(!strcmp(a, "--png")) { s_png = 1; continue; }
+        if(!v) Usage();
+        i++;
+        if(!strcmp(a, "--ctrl")) {
+            if(!strcmp(v, "9341")) ctrl = LCDSIM_ILI9341;
+            else if(!strcmp(v, "5510")) ctrl = LCDSIM_NT35510;
+            else if(!strcmp(v, "1963")) ctrl = LCDSIM_SSD1963;
+            else Usage();
+        } else if(!strcmp(a, "--dir")) {
+            dir = atoi(v) ? 1 : 0;
+        } else if(!strncmp(a, "--font", 6)) {
+            if(lcdsim_load_font((uint8_t)atoi(a + 6), v)) { printf("字库 %s 读取失败\n", v); return 2; }
+        } else if(!strcmp(a, "--out")) {
+            s_out = v;
+        } else if(!strcmp(a, "--check")) {
+            s_check = v;
+        } else {
+            Usage();
+        }
+    }
+
+    /* 相当于 LCD_Init 读到 ID 之后的部分；FSMC/GPIO 初始化和控制器初始化序列不在主机上跑 */
+    lcdsim_init(ctrl);
+    lcddev.id = lcdsim_ctrl_id();
+    LCD_DMA_Init();
+    printf("控制器 %04X 方向 %d\n\n", lcddev.id, dir);
+    printf(" #     cmd   param    pixel      dma   writes  est_us  步骤\n");
+
+    LCD_Display_Dir((u8)dir);
+    LCD_Clear(WHITE);
+    Step("LCD_Display_Dir+Clear");
+
+    HGQ_UI_Init();
+    Step("HGQ_UI_Init");
+
+    memset(&d, 0, sizeof(d));
+    strcpy(d.area_seat, SEAT_GBK);
+    strcpy(d.status, "Free"); strcpy(d.user_str, "--");
+    strcpy(d.reserve_t, "--"); strcpy(d.start_t, "--");
+    d.temp_x10 = 253; d.humi = 48; d.lux = 320;
+    d.auto_mode = 1; d.esp_state = 2;
+
+    HGQ_UI_DrawFramework();
+    Step("HGQ_UI_DrawFramework");
+
+    HGQ_UI_Update(&d, "12:00");
+    Step("HGQ_UI_Update 首次");
+
+    HGQ_UI_Update(&d, "12:00");
+    Step("HGQ_UI_Update 无变化");
+
+    d.temp_x10 = 254;
+    HGQ_UI_Update(&d, "12:00");
+    Step("HGQ_UI_Update 温度+0.1");
+
+    HGQ_UI_Update(&d, "12:01");
+    Step("HGQ_UI_Update 时钟");
+
+    strcpy(d.status, "IN_USE"); strcpy(d.user_str, "20231234");
+    strcpy(d.start_t, "12:01"); d.light_on = 1; d.auto_mode = 0; d.bri_target = 60;
+    HGQ_UI_Update(&d, "12:01");
+    Step("HGQ_UI_Update 签到");
+
+    for(i = 0; i < 10 && HGQ_UI_GetBrightnessNow() != d.bri_target; i++) HGQ_UI_Update(&d, "12:01");
+    Step("HGQ_UI_Update 亮度渐变");
+
+    HGQ_UI_ShowPopup((const char *)POP_MSG);
+    Step("HGQ_UI_ShowPopup");
+
+    HGQ_UI_ResetCache();
+    HGQ_UI_DrawFramework();
+    HGQ_UI_Update(&d, "12:01");
+    Step("关闭弹窗 (整屏重画)");
+
+    HGQ_WG_GetStats(&wst);
+    printf("\n控件刷新: 帧=%u 上帧区域=%u 控件=%u 像素=%u 累计像素=%u 最长=%uus\n",
+           wst.frames, wst.rects, wst.widgets, wst.pixels, wst.total_pixels, wst.max_us);
+    if(s_check) printf("画面比较: %s\n", s_fail ? "有差异" : "一致");
+    return s_fail;
+}
@@ -0,0 +1,7 @@
+/* 主机模拟用：lcd.c 只用到调度器状态查询和延时 */
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+#include <stdint.h>
+typedef long BaseType_t;
+typedef uint32_t TickType_t;
+#endif
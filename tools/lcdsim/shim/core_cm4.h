@@ -0,0 +1,12 @@
+/* 在真正的 core_cm4.h 之后把 DWT / CoreDebug 换成主机变量：
+ * hgq_widget.c 用 DWT 周期计数器统计帧耗时，模拟器按总线写次数推算周期数写进去 */
+#include_next "core_cm4.h"
+#ifndef LCDSIM_CORE_CM4_H
+#define LCDSIM_CORE_CM4_H
+#undef DWT
+#undef CoreDebug
+extern DWT_Type       lcdsim_dwt;
+extern CoreDebug_Type lcdsim_coredebug;
+#define DWT         (&lcdsim_dwt)
+#define CoreDebug   (&lcdsim_coredebug)
+#endif
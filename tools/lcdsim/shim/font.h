@@ -0,0 +1,2 @@
+/* lcd.c 包含 "font.h"，文件名实际为 FONT.H (主机文件系统区分大小写) */
+#include "../../../HARDWARE/LCD/FONT.H"
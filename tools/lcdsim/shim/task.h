@@ -0,0 +1,9 @@
+#ifndef INC_TASK_H
+#define INC_TASK_H
+#include "FreeRTOS.h"
+#define taskSCHEDULER_NOT_STARTED   1
+#define taskSCHEDULER_RUNNING       2
+/* 模拟器单线程运行、DMA 同步完成，不会真的等待 */
+static inline BaseType_t xTaskGetSchedulerState(void) { return taskSCHEDULER_NOT_STARTED; }
+static inline void vTaskDelay(TickType_t t) { (void)t; }
+#endif